@@ -0,0 +1,218 @@
+#pragma once
+
+#include <base_types.h>
+
+// Atomic operations on 32-bit, 64-bit and pointer-sized values, modelled on
+// C11 <stdatomic.h> (which is not available in the nostdlib builds).
+//
+// Loads and stores take an explicit memory order; read-modify-write
+// operations are sequentially consistent. Use the wrapper types so that plain
+// (non-atomic) accesses do not happen by accident.
+//
+// Clang/GCC use the __atomic builtins, MSVC (x64 only) uses the _Interlocked
+// intrinsics. x64 is TSO, so plain volatile accesses plus a compiler barrier
+// give acquire loads and release stores there.
+
+typedef enum {
+    ATOMIC_RELAXED = 0,  // __ATOMIC_RELAXED
+    ATOMIC_ACQUIRE = 2,  // __ATOMIC_ACQUIRE
+    ATOMIC_RELEASE = 3,  // __ATOMIC_RELEASE
+    ATOMIC_SEQ_CST = 5,  // __ATOMIC_SEQ_CST
+} AtomicOrder;
+
+typedef struct { volatile uint32_t value; } atomic_u32;
+typedef struct { volatile uint64_t value; } atomic_u64;
+typedef struct { void * volatile value; } atomic_ptr;
+
+#if defined(_MSC_VER)
+
+long _InterlockedExchange(long volatile *target, long value);
+long _InterlockedExchangeAdd(long volatile *addend, long value);
+long _InterlockedCompareExchange(long volatile *dest, long exchange, long comparand);
+long long _InterlockedExchange64(long long volatile *target, long long value);
+long long _InterlockedExchangeAdd64(long long volatile *addend, long long value);
+long long _InterlockedCompareExchange64(long long volatile *dest, long long exchange, long long comparand);
+void _ReadWriteBarrier(void);
+void __faststorefence(void);
+void _mm_pause(void);
+#pragma intrinsic(_InterlockedExchange, _InterlockedExchangeAdd, _InterlockedCompareExchange)
+#pragma intrinsic(_InterlockedExchange64, _InterlockedExchangeAdd64, _InterlockedCompareExchange64)
+#pragma intrinsic(_ReadWriteBarrier, __faststorefence, _mm_pause)
+
+static inline uint32_t atomic_load_u32(const atomic_u32 *a, AtomicOrder order) {
+    (void)order;
+    uint32_t v = a->value;
+    _ReadWriteBarrier();
+    return v;
+}
+
+static inline void atomic_store_u32(atomic_u32 *a, uint32_t v, AtomicOrder order) {
+    if (order == ATOMIC_SEQ_CST) {
+        _InterlockedExchange((long volatile *)&a->value, (long)v);
+    } else {
+        _ReadWriteBarrier();
+        a->value = v;
+    }
+}
+
+static inline uint32_t atomic_fetch_add_u32(atomic_u32 *a, uint32_t v) {
+    return (uint32_t)_InterlockedExchangeAdd((long volatile *)&a->value, (long)v);
+}
+
+static inline uint32_t atomic_fetch_sub_u32(atomic_u32 *a, uint32_t v) {
+    return (uint32_t)_InterlockedExchangeAdd((long volatile *)&a->value, -(long)v);
+}
+
+static inline uint32_t atomic_exchange_u32(atomic_u32 *a, uint32_t v) {
+    return (uint32_t)_InterlockedExchange((long volatile *)&a->value, (long)v);
+}
+
+static inline bool atomic_compare_exchange_u32(atomic_u32 *a, uint32_t *expected, uint32_t desired) {
+    uint32_t prev = (uint32_t)_InterlockedCompareExchange((long volatile *)&a->value, (long)desired, (long)*expected);
+    if (prev == *expected) return true;
+    *expected = prev;
+    return false;
+}
+
+static inline uint64_t atomic_load_u64(const atomic_u64 *a, AtomicOrder order) {
+    (void)order;
+    uint64_t v = a->value;
+    _ReadWriteBarrier();
+    return v;
+}
+
+static inline void atomic_store_u64(atomic_u64 *a, uint64_t v, AtomicOrder order) {
+    if (order == ATOMIC_SEQ_CST) {
+        _InterlockedExchange64((long long volatile *)&a->value, (long long)v);
+    } else {
+        _ReadWriteBarrier();
+        a->value = v;
+    }
+}
+
+static inline uint64_t atomic_fetch_add_u64(atomic_u64 *a, uint64_t v) {
+    return (uint64_t)_InterlockedExchangeAdd64((long long volatile *)&a->value, (long long)v);
+}
+
+static inline uint64_t atomic_fetch_sub_u64(atomic_u64 *a, uint64_t v) {
+    return (uint64_t)_InterlockedExchangeAdd64((long long volatile *)&a->value, -(long long)v);
+}
+
+static inline uint64_t atomic_exchange_u64(atomic_u64 *a, uint64_t v) {
+    return (uint64_t)_InterlockedExchange64((long long volatile *)&a->value, (long long)v);
+}
+
+static inline bool atomic_compare_exchange_u64(atomic_u64 *a, uint64_t *expected, uint64_t desired) {
+    uint64_t prev = (uint64_t)_InterlockedCompareExchange64((long long volatile *)&a->value, (long long)desired, (long long)*expected);
+    if (prev == *expected) return true;
+    *expected = prev;
+    return false;
+}
+
+static inline void *atomic_load_ptr(const atomic_ptr *a, AtomicOrder order) {
+    return (void *)atomic_load_u64((const atomic_u64 *)a, order);
+}
+
+static inline void atomic_store_ptr(atomic_ptr *a, void *v, AtomicOrder order) {
+    atomic_store_u64((atomic_u64 *)a, (uint64_t)v, order);
+}
+
+static inline void *atomic_exchange_ptr(atomic_ptr *a, void *v) {
+    return (void *)atomic_exchange_u64((atomic_u64 *)a, (uint64_t)v);
+}
+
+static inline bool atomic_compare_exchange_ptr(atomic_ptr *a, void **expected, void *desired) {
+    return atomic_compare_exchange_u64((atomic_u64 *)a, (uint64_t *)expected, (uint64_t)desired);
+}
+
+// Full memory barrier
+static inline void atomic_thread_fence(void) {
+    __faststorefence();
+}
+
+// Hint to the CPU that this is a spin-wait loop
+static inline void cpu_relax(void) {
+    _mm_pause();
+}
+
+#else
+
+static inline uint32_t atomic_load_u32(const atomic_u32 *a, AtomicOrder order) {
+    return __atomic_load_n(&a->value, order);
+}
+
+static inline void atomic_store_u32(atomic_u32 *a, uint32_t v, AtomicOrder order) {
+    __atomic_store_n(&a->value, v, order);
+}
+
+static inline uint32_t atomic_fetch_add_u32(atomic_u32 *a, uint32_t v) {
+    return __atomic_fetch_add(&a->value, v, __ATOMIC_SEQ_CST);
+}
+
+static inline uint32_t atomic_fetch_sub_u32(atomic_u32 *a, uint32_t v) {
+    return __atomic_fetch_sub(&a->value, v, __ATOMIC_SEQ_CST);
+}
+
+static inline uint32_t atomic_exchange_u32(atomic_u32 *a, uint32_t v) {
+    return __atomic_exchange_n(&a->value, v, __ATOMIC_SEQ_CST);
+}
+
+static inline bool atomic_compare_exchange_u32(atomic_u32 *a, uint32_t *expected, uint32_t desired) {
+    return __atomic_compare_exchange_n(&a->value, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline uint64_t atomic_load_u64(const atomic_u64 *a, AtomicOrder order) {
+    return __atomic_load_n(&a->value, order);
+}
+
+static inline void atomic_store_u64(atomic_u64 *a, uint64_t v, AtomicOrder order) {
+    __atomic_store_n(&a->value, v, order);
+}
+
+static inline uint64_t atomic_fetch_add_u64(atomic_u64 *a, uint64_t v) {
+    return __atomic_fetch_add(&a->value, v, __ATOMIC_SEQ_CST);
+}
+
+static inline uint64_t atomic_fetch_sub_u64(atomic_u64 *a, uint64_t v) {
+    return __atomic_fetch_sub(&a->value, v, __ATOMIC_SEQ_CST);
+}
+
+static inline uint64_t atomic_exchange_u64(atomic_u64 *a, uint64_t v) {
+    return __atomic_exchange_n(&a->value, v, __ATOMIC_SEQ_CST);
+}
+
+static inline bool atomic_compare_exchange_u64(atomic_u64 *a, uint64_t *expected, uint64_t desired) {
+    return __atomic_compare_exchange_n(&a->value, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline void *atomic_load_ptr(const atomic_ptr *a, AtomicOrder order) {
+    return __atomic_load_n(&a->value, order);
+}
+
+static inline void atomic_store_ptr(atomic_ptr *a, void *v, AtomicOrder order) {
+    __atomic_store_n(&a->value, v, order);
+}
+
+static inline void *atomic_exchange_ptr(atomic_ptr *a, void *v) {
+    return __atomic_exchange_n(&a->value, v, __ATOMIC_SEQ_CST);
+}
+
+static inline bool atomic_compare_exchange_ptr(atomic_ptr *a, void **expected, void *desired) {
+    return __atomic_compare_exchange_n(&a->value, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+// Full memory barrier
+static inline void atomic_thread_fence(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+// Hint to the CPU that this is a spin-wait loop
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
+
+#endif
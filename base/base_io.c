@@ -30,6 +30,10 @@ uint32_t write_all(int fd, ciovec_t* iovs, size_t iovs_len) {
     return 0; // Success
 }
 
+bool fd_is_terminal(int fd) {
+    return platform_fd_is_terminal(fd);
+}
+
 void writeln(int fd, char* text) {
     const char *msg1 = text;
     const char *msg2 = "\n";
@@ -18,6 +18,9 @@
  */
 uint32_t write_all(int fd, ciovec_t* iovs, size_t iovs_len);
 
+// Returns true if fd is a terminal (see platform_fd_is_terminal).
+bool fd_is_terminal(int fd);
+
 // Prints a single line, appends `\n`
 void writeln(int fd, char* text);
 
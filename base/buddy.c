@@ -6,6 +6,7 @@
 #include <base/numconv.h>
 #include <base/mem.h>
 #include <base/exit.h>
+#include <base/atomics.h>
 
 // Export buddy allocator functions for WASM JavaScript interop
 #ifdef __wasi__
@@ -42,6 +43,32 @@ struct list_head {
 static struct list_head free_lists[MAX_ORDER + 1];
 static void *heap_base;
 
+// The allocator is shared by all threads. The critical sections are short
+// (a few list operations, rarely a heap grow), so a spin lock that yields
+// when it is held for long is enough.
+static atomic_u32 buddy_lock_state;
+
+// Protected by the lock
+static size_t allocated_bytes;
+static size_t peak_allocated_bytes;
+
+static void buddy_lock(void) {
+    int spins = 0;
+    while (atomic_exchange_u32(&buddy_lock_state, 1) != 0) {
+        while (atomic_load_u32(&buddy_lock_state, ATOMIC_RELAXED) != 0) {
+            if (++spins < 64) {
+                cpu_relax();
+            } else {
+                platform_thread_yield();
+            }
+        }
+    }
+}
+
+static void buddy_unlock(void) {
+    atomic_store_u32(&buddy_lock_state, 0, ATOMIC_RELEASE);
+}
+
 static void list_add(struct list_head *lh, struct buddy_block *p) {
     p->next = lh->first;
     p->prev = NULL;
@@ -488,6 +515,7 @@ void *buddy_alloc(size_t size, size_t *actual_size) {
         }
     }
 
+    buddy_lock();
     static int large_alloc_log_count = 0;
     if (order >= 7 && large_alloc_log_count < 20) {
         large_alloc_log_count++;
@@ -501,7 +529,13 @@ void *buddy_alloc(size_t size, size_t *actual_size) {
         *actual_size = block_size - sizeof(struct buddy_block);
     }
 
-    return buddy_alloc_order(order);
+    void *ptr = buddy_alloc_order(order);
+    allocated_bytes += block_size;
+    if (allocated_bytes > peak_allocated_bytes) {
+        peak_allocated_bytes = allocated_bytes;
+    }
+    buddy_unlock();
+    return ptr;
 }
 
 void buddy_free(void *ptr) {
@@ -516,6 +550,8 @@ void buddy_free(void *ptr) {
         return; // Invalid pointer or heap corruption
     }
 
+    buddy_lock();
+    allocated_bytes -= MIN_PAGE_SIZE << order;
     uintptr_t heap_end = (uintptr_t)heap_base + wasi_heap_size();
 
     // Coalesce with buddy if possible
@@ -548,4 +584,16 @@ void buddy_free(void *ptr) {
 
     p->order = order;
     list_add(&free_lists[order], p);
+    buddy_unlock();
+}
+
+BuddyStats buddy_get_stats(void) {
+    buddy_lock();
+    BuddyStats stats = {
+        .allocated_bytes = allocated_bytes,
+        .peak_allocated_bytes = peak_allocated_bytes,
+        .committed_bytes = wasi_heap_size(),
+    };
+    buddy_unlock();
+    return stats;
 }
@@ -14,3 +14,12 @@ void buddy_free(void *ptr);
 
 // Print detailed statistics about the buddy allocator state
 void buddy_print_stats();
+
+typedef struct {
+    size_t allocated_bytes;       // Blocks currently allocated, headers included
+    size_t peak_allocated_bytes;  // Maximum of allocated_bytes so far
+    size_t committed_bytes;       // Heap obtained from the platform
+} BuddyStats;
+
+// Cheap counters, unlike buddy_print_stats() which scans the heap
+BuddyStats buddy_get_stats(void);
@@ -0,0 +1,129 @@
+#include <base/bundle.h>
+#include <base/atomics.h>
+#include <base/io.h>
+#include <base/jobs.h>
+#include <base/lz.h>
+#include <base/mem.h>
+#include <base/scratch.h>
+#include <platform/platform.h>
+#include <bundle_format.h>
+
+// Checks everything bundle_find_entry and the readers below rely on, so
+// lookups need no bounds checks
+static bool bundle_validate(const uint8_t *data, size_t size) {
+    if (size < sizeof(BundleHeader)) return false;
+    const BundleHeader *header = (const BundleHeader *)data;
+    if (base_memcmp(header->magic, BUNDLE_MAGIC, 4) != 0) return false;
+    if (header->version != 2 && header->version != BUNDLE_VERSION) return false;
+    if (header->total_size != size) return false;
+
+    uint32_t slot_count = header->slot_count;
+    uint32_t file_count = header->file_count;
+    if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0 || slot_count / 2 < file_count) return false;
+    if (header->index_offset % sizeof(uint32_t) != 0 || header->entries_offset % sizeof(uint64_t) != 0) return false;
+    if ((uint64_t)header->index_offset + (uint64_t)slot_count * sizeof(uint32_t) > size) return false;
+    if ((uint64_t)header->entries_offset + (uint64_t)file_count * sizeof(BundleEntry) > size) return false;
+    uint64_t strings_end = (uint64_t)header->strings_offset + header->strings_size;
+    if (strings_end > size) return false;
+    if (header->align_shift >= 64) return false;
+    uint64_t align_mask = ((uint64_t)1 << header->align_shift) - 1;
+
+    // At most file_count slots are used, so every probe ends at an empty one
+    const uint32_t *slots = (const uint32_t *)(data + header->index_offset);
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < slot_count; i++) {
+        if (slots[i] > file_count) return false;
+        used += slots[i] != 0;
+    }
+    if (used > file_count) return false;
+
+    const BundleEntry *entries = (const BundleEntry *)(data + header->entries_offset);
+    for (uint32_t i = 0; i < file_count; i++) {
+        const BundleEntry *entry = &entries[i];
+        if (entry->path_offset < header->strings_offset) return false;
+        if ((uint64_t)entry->path_offset + entry->path_size > strings_end) return false;
+        if (entry->offset > size || entry->size > size - entry->offset) return false;
+        if (entry->size != 0 && (entry->offset & align_mask) != 0) return false;
+        if (entry->codec > BUNDLE_CODEC_LZ || (header->version == 2 && entry->codec != 0)) return false;
+    }
+    return true;
+}
+
+bool bundle_open(Arena *arena, string path, Bundle *bundle) {
+    *bundle = (Bundle){0};
+    Scratch scratch = scratch_begin_avoid_conflict(arena);
+    char *cpath = str_to_cstr_copy(scratch.arena, path);
+    uint64_t handle;
+    void *data;
+    size_t size;
+    bool mapped = platform_read_file_mmap(cpath, PLATFORM_MMAP_READONLY, &handle, &data, &size);
+    scratch_end(scratch);
+    if (mapped) {
+        // The game reads most of the bundle at startup: page it all in with
+        // large sequential reads
+        platform_file_advise(handle, PLATFORM_ADVISE_SEQUENTIAL | PLATFORM_ADVISE_WILLNEED);
+    } else {
+        string text;
+        if (!read_file(arena, path, &text)) return false;
+        handle = 0;
+        data = text.str;
+        size = text.size - 1;
+    }
+    if (!bundle_validate(data, size)) {
+        platform_file_unmap(handle);
+        return false;
+    }
+    bundle->data = data;
+    bundle->size = size;
+    bundle->handle = handle;
+    return true;
+}
+
+void bundle_close(Bundle *bundle) {
+    platform_file_unmap(bundle->handle);
+    *bundle = (Bundle){0};
+}
+
+static const BundleEntry *bundle_lookup(const Bundle *bundle, string path) {
+    if (!bundle->data || path.size > UINT32_MAX) return NULL;
+    return bundle_find_entry(bundle->data, path.str, (uint32_t)path.size);
+}
+
+bool bundle_view(const Bundle *bundle, string path, string *content) {
+    const BundleEntry *entry = bundle_lookup(bundle, path);
+    if (!entry || entry->codec != BUNDLE_CODEC_NONE) return false;
+    content->str = (char *)(bundle->data + entry->offset);
+    content->size = entry->size;
+    return true;
+}
+
+typedef struct {
+    const uint8_t *frame;
+    uint8_t *out;
+    atomic_u32 failures;
+} BundleDecodeJob;
+
+static void bundle_decode_blocks(void *arg, uint64_t begin, uint64_t end) {
+    BundleDecodeJob *job = arg;
+    if (!lz_frame_decompress_blocks(job->frame, job->out, (uint32_t)begin, (uint32_t)end)) {
+        atomic_fetch_add_u32(&job->failures, 1);
+    }
+}
+
+bool bundle_read(const Bundle *bundle, Arena *arena, string path, string *content) {
+    const BundleEntry *entry = bundle_lookup(bundle, path);
+    if (!entry) return false;
+    if (entry->codec == BUNDLE_CODEC_NONE) return bundle_view(bundle, path, content);
+
+    const uint8_t *frame = bundle->data + entry->offset;
+    size_t size = lz_frame_size(frame, entry->size);
+    if (size == LZ_ERROR) return false;
+    uint8_t *out = arena_alloc(arena, size + 1);
+    BundleDecodeJob job = {.frame = frame, .out = out};
+    job_parallel_for(lz_frame_block_count(frame), 1, bundle_decode_blocks, &job);
+    if (atomic_load_u32(&job.failures, ATOMIC_RELAXED) != 0) return false;
+    out[size] = 0;
+    content->str = (char *)out;
+    content->size = size;
+    return true;
+}
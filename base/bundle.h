@@ -0,0 +1,37 @@
+#pragma once
+
+#include <base/arena.h>
+#include <base/base_string.h>
+
+// Read-only access to the asset bundles written by bundler.c (JSFS, see
+// bundle_format.h). bundle_open maps the whole bundle with one read-only
+// mapping, or reads it into an arena where files cannot be mapped (WASM),
+// and validates its metadata once. Lookups then hash the path and probe the
+// index in place, without any file I/O.
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    uint64_t handle;  // Mapping handle, 0 if the bundle was read into an arena
+} Bundle;
+
+// Opens the bundle at `path`. Returns false if it cannot be read or its
+// header, index, entries or paths are malformed.
+bool bundle_open(Arena *arena, string path, Bundle *bundle);
+
+// Releases the mapping. Views returned by bundle_view and bundle_read become
+// invalid.
+void bundle_close(Bundle *bundle);
+
+// Sets `content` to the bytes of `path` in the bundle, without a copy or a
+// terminator. The view must not be written to. In a mapped bundle it is
+// aligned to the bundle's alignment (bundler --align, up to the page size).
+// Returns false if the path is not bundled or is stored compressed.
+bool bundle_view(const Bundle *bundle, string path, string *content);
+
+// Sets `content` to the contents of `path`: a view as from bundle_view for a
+// file stored as is, otherwise the file decompressed into `arena` (followed
+// by a terminator not counted in content->size), with its blocks decoded in
+// parallel on the job system. Returns false if the path is not bundled or
+// its data is malformed.
+bool bundle_read(const Bundle *bundle, Arena *arena, string path, string *content);
@@ -0,0 +1,10 @@
+#pragma once
+
+// Token pasting helpers shared by the type-generic containers and algorithms
+// (vector.h, hashtable.h, sort.h), defined once so their headers can be
+// included together (internal use)
+#define _GV_CONCAT_IMPL(a, b) a##b
+#define _GV_CONCAT(a, b) _GV_CONCAT_IMPL(a, b)
+
+#define _GV_CONCAT3_IMPL(a, b, c) a##b##c
+#define _GV_CONCAT3(a, b, c) _GV_CONCAT3_IMPL(a, b, c)
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Non-cryptographic 64-bit hashing with the XXH64 algorithm (reference
+// xxhash gives the same values). Four independent lanes consume 32 bytes per
+// step, so hashing runs at several GB/s without any SIMD code; it is meant
+// for checksums of data that is read anyway, like scene sections.
+//
+// Only <stdint.h> and <stddef.h> are needed, like base/lz.c.
+
+// Hash of `size` bytes of `data`. Different seeds give unrelated hashes.
+uint64_t hash64(const void *data, size_t size, uint64_t seed);
@@ -2,13 +2,7 @@
 
 #include <base/base_types.h>
 #include <base/arena.h>
-
-// Helper Macros (internal use)
-#define _GV_CONCAT_IMPL(a, b) a##b
-#define _GV_CONCAT(a, b) _GV_CONCAT_IMPL(a, b)
-
-#define _GV_CONCAT3_IMPL(a, b, c) a##b##c
-#define _GV_CONCAT3(a, b, c) _GV_CONCAT3_IMPL(a, b, c)
+#include <base/generic.h>
 
 // Hashtable Definition Macro with Inlined Hash and Equality
 #define DEFINE_HASHTABLE_FOR_TYPES(KEY_TYPE, VALUE_TYPE, NAME) \
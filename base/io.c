@@ -21,31 +21,30 @@ bool read_file(Arena *arena, const string filename, string *text) {
         return false;
     }
 
-    // Get file size by seeking to end
-    uint64_t filesize_u64;
-    if (wasi_fd_seek(fd, 0, WASI_SEEK_END, &filesize_u64) != 0) {
+    // Get file size from the file attributes
+    filestat_t stat;
+    if (wasi_fd_filestat_get(fd, &stat) != 0) {
         wasi_fd_close(fd);
         scratch_end(scratch);
         return false;
     }
 
-    // Seek back to beginning
-    uint64_t dummy;
-    if (wasi_fd_seek(fd, 0, WASI_SEEK_SET, &dummy) != 0) {
-        wasi_fd_close(fd);
-        scratch_end(scratch);
-        return false;
-    }
-
-    size_t filesize = (size_t)filesize_u64;
+    size_t filesize = (size_t)stat.size;
 
     // Allocate buffer
     char *bytes = arena_alloc_array(arena, char, filesize+1);
 
-    // Read file contents using iovec
-    iovec_t iov = { .iov_base = bytes, .iov_len = filesize };
-    size_t nread;
-    int ret = wasi_fd_read(fd, &iov, 1, &nread);
+    // Read file contents with positional reads, which may return fewer
+    // bytes than requested (e.g. Linux caps a single read at ~2 GiB)
+    size_t nread = 0;
+    int ret = 0;
+    while (nread < filesize) {
+        iovec_t iov = { .iov_base = bytes + nread, .iov_len = filesize - nread };
+        size_t n;
+        ret = wasi_fd_pread(fd, &iov, 1, nread, &n);
+        if (ret != 0 || n == 0) break;
+        nread += n;
+    }
     wasi_fd_close(fd);
 
     if (ret != 0 || nread != filesize) {
@@ -70,6 +69,48 @@ string read_file_ok(Arena *arena, const string filename) {
     }
 }
 
+// Mappings are zero-filled up to the end of the last page, so the byte right
+// after the file contents is readable (and '\0') unless the file size is an
+// exact multiple of the page size. 4 KiB divides the page size of every
+// supported platform, so it is a safe granularity for this check.
+#define READ_FILE_VIEW_PAGE_SIZE 4096
+
+bool read_file_view(Arena *arena, const string filename, string *text, uint64_t *handle) {
+    *handle = 0;
+    Scratch scratch = scratch_begin_avoid_conflict(arena);
+    char *cfilename = str_to_cstr_copy(scratch.arena, filename);
+    uint64_t map_handle;
+    void *data;
+    size_t size;
+    bool mapped = platform_read_file_mmap(cfilename, PLATFORM_MMAP_READONLY, &map_handle, &data, &size);
+    scratch_end(scratch);
+    if (mapped) {
+        if (size > 0 && size % READ_FILE_VIEW_PAGE_SIZE != 0) {
+            text->str = (char *)data;
+            text->size = size+1;
+            *handle = map_handle;
+            return true;
+        }
+        // Empty file or no room for the terminator: copy instead
+        platform_file_unmap(map_handle);
+    }
+    return read_file(arena, filename, text);
+}
+
+string read_file_view_ok(Arena *arena, const string filename, uint64_t *handle) {
+    string text;
+    if (read_file_view(arena, filename, &text, handle)) {
+        return text;
+    } else {
+        FATAL_ERROR("File cannot be opened.");
+        return text;
+    }
+}
+
+void read_file_view_release(uint64_t handle) {
+    platform_file_unmap(handle);
+}
+
 void println_explicit(string fmt, size_t arg_count, ...) {
     Scratch scratch = scratch_begin();
     va_list varg;
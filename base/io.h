@@ -9,6 +9,19 @@
 bool read_file(Arena *arena, const string filename, string *text);
 string read_file_ok(Arena *arena, const string filename);
 
+// Returns a read-only view of the file contents in `text`, with the same
+// null-terminator guarantee (and `text->size` convention) as read_file().
+// When the platform can map the file (Linux, macOS, Windows) the view points
+// directly into the mapping and `*handle` is set to the mapping handle;
+// otherwise (WASM, or when the terminator would fall on a fresh page) the file
+// is read into `arena` and `*handle` is set to 0.
+// The view must not be written to. Release it with read_file_view_release()
+// once it is no longer needed (a no-op for arena-backed views).
+// Returns `true` on success, otherwise `false`.
+bool read_file_view(Arena *arena, const string filename, string *text, uint64_t *handle);
+string read_file_view_ok(Arena *arena, const string filename, uint64_t *handle);
+void read_file_view_release(uint64_t handle);
+
 void println_explicit(string fmt, size_t arg_count, ...);
 
 #define println(fmt, ...) \
@@ -0,0 +1,340 @@
+#include <base/jobs.h>
+#include <base/buddy.h>
+#include <base/scratch.h>
+#include <base/arena.h>
+#include <base/profile.h>
+#include <platform/platform.h>
+
+// Jobs per deque. When a deque is full the job runs inline instead.
+#define JOB_DEQUE_CAPACITY 4096
+// Scans for work before an idle thread goes to sleep.
+#define JOB_SPIN_COUNT 64
+#define CACHE_LINE_SIZE 64
+
+// A queued job. Thieves may read a slot while its owner is reusing it; the
+// read is then discarded because the thief's CAS on `top` fails, but the
+// fields are accessed atomically so that the race is benign.
+typedef struct {
+    atomic_ptr fn;
+    atomic_ptr arg;
+    atomic_ptr counter;
+} JobSlot;
+
+typedef struct {
+    JobFn fn;
+    void *arg;
+    JobCounter *counter;
+} Job;
+
+// Chase-Lev deque ("Correct and Efficient Work-Stealing for Weak Memory
+// Models", Le et al. 2013). `top` and `bottom` only grow (as int64), slots
+// are indexed modulo the capacity. They are on separate cache lines because
+// thieves hammer `top` while the owner updates `bottom`.
+typedef struct {
+    atomic_u64 top;
+    uint8_t pad0[CACHE_LINE_SIZE - sizeof(atomic_u64)];
+    atomic_u64 bottom;
+    uint8_t pad1[CACHE_LINE_SIZE - sizeof(atomic_u64)];
+    JobSlot *slots;
+} JobDeque;
+
+typedef struct {
+    JobDeque deque;
+    ThreadContext ctx;
+    platform_thread_t thread;
+    uint32_t index;
+} JobWorker;
+
+static struct {
+    JobWorker *workers;    // [0] is the main thread
+    uint32_t count;        // Threads including the main thread
+    uint32_t allocated;    // Workers allocated, including any that failed to start
+    bool running;
+    atomic_u32 shutdown;
+    atomic_u32 sleepers;   // Workers in (or entering) jobs_sleep
+    atomic_u32 wake_seq;   // Futex word sleepers wait on
+} g_jobs;
+
+static void deque_write(JobDeque *d, int64_t i, Job job) {
+    JobSlot *s = &d->slots[i & (JOB_DEQUE_CAPACITY - 1)];
+    atomic_store_ptr(&s->fn, (void *)job.fn, ATOMIC_RELAXED);
+    atomic_store_ptr(&s->arg, job.arg, ATOMIC_RELAXED);
+    atomic_store_ptr(&s->counter, job.counter, ATOMIC_RELAXED);
+}
+
+static Job deque_read(JobDeque *d, int64_t i) {
+    JobSlot *s = &d->slots[i & (JOB_DEQUE_CAPACITY - 1)];
+    Job job;
+    job.fn = (JobFn)atomic_load_ptr(&s->fn, ATOMIC_RELAXED);
+    job.arg = atomic_load_ptr(&s->arg, ATOMIC_RELAXED);
+    job.counter = atomic_load_ptr(&s->counter, ATOMIC_RELAXED);
+    return job;
+}
+
+// Owner only.
+static bool deque_push(JobDeque *d, Job job) {
+    int64_t b = (int64_t)atomic_load_u64(&d->bottom, ATOMIC_RELAXED);
+    int64_t t = (int64_t)atomic_load_u64(&d->top, ATOMIC_ACQUIRE);
+    if (b - t >= JOB_DEQUE_CAPACITY) return false;
+    deque_write(d, b, job);
+    atomic_store_u64(&d->bottom, (uint64_t)(b + 1), ATOMIC_RELEASE);
+    return true;
+}
+
+// Owner only.
+static bool deque_pop(JobDeque *d, Job *job) {
+    int64_t b = (int64_t)atomic_load_u64(&d->bottom, ATOMIC_RELAXED) - 1;
+    atomic_store_u64(&d->bottom, (uint64_t)b, ATOMIC_RELAXED);
+    atomic_thread_fence();
+    int64_t t = (int64_t)atomic_load_u64(&d->top, ATOMIC_RELAXED);
+    if (t > b) {
+        // Empty
+        atomic_store_u64(&d->bottom, (uint64_t)(b + 1), ATOMIC_RELAXED);
+        return false;
+    }
+    *job = deque_read(d, b);
+    if (t == b) {
+        // Last job: race thieves for it
+        uint64_t expected = (uint64_t)t;
+        bool won = atomic_compare_exchange_u64(&d->top, &expected, (uint64_t)(t + 1));
+        atomic_store_u64(&d->bottom, (uint64_t)(b + 1), ATOMIC_RELAXED);
+        return won;
+    }
+    return true;
+}
+
+// Any thread.
+static bool deque_steal(JobDeque *d, Job *job) {
+    int64_t t = (int64_t)atomic_load_u64(&d->top, ATOMIC_ACQUIRE);
+    atomic_thread_fence();
+    int64_t b = (int64_t)atomic_load_u64(&d->bottom, ATOMIC_ACQUIRE);
+    if (t >= b) return false;
+    *job = deque_read(d, t);
+    uint64_t expected = (uint64_t)t;
+    return atomic_compare_exchange_u64(&d->top, &expected, (uint64_t)(t + 1));
+}
+
+static bool deque_has_work(JobDeque *d) {
+    int64_t t = (int64_t)atomic_load_u64(&d->top, ATOMIC_ACQUIRE);
+    int64_t b = (int64_t)atomic_load_u64(&d->bottom, ATOMIC_ACQUIRE);
+    return t < b;
+}
+
+static bool jobs_work_visible(void) {
+    for (uint32_t i = 0; i < g_jobs.count; i++) {
+        if (deque_has_work(&g_jobs.workers[i].deque)) return true;
+    }
+    return false;
+}
+
+// Wakes one sleeping worker, if any, for a newly spawned job.
+static void jobs_wake(void) {
+    if (atomic_load_u32(&g_jobs.sleepers, ATOMIC_SEQ_CST) == 0) return;
+    atomic_fetch_add_u32(&g_jobs.wake_seq, 1);
+    platform_futex_wake_one(&g_jobs.wake_seq.value);
+}
+
+// Sleeps until new work is spawned or the job system shuts down. Registering
+// as a sleeper before re-checking pairs with jobs_wake reading `sleepers`
+// after publishing, so wakeups are not lost.
+static void jobs_sleep(void) {
+    atomic_fetch_add_u32(&g_jobs.sleepers, 1);
+    uint32_t seq = atomic_load_u32(&g_jobs.wake_seq, ATOMIC_ACQUIRE);
+    bool done = atomic_load_u32(&g_jobs.shutdown, ATOMIC_ACQUIRE) != 0;
+    if (!done && !jobs_work_visible()) {
+        platform_futex_wait(&g_jobs.wake_seq.value, seq);
+    }
+    atomic_fetch_sub_u32(&g_jobs.sleepers, 1);
+}
+
+static void job_run(Job job) {
+    job.fn(job.arg);
+    if (atomic_fetch_sub_u32(&job.counter->pending, 1) == 1) {
+        // Only threads in job_wait on this counter sleep on `pending`, so
+        // idle workers stay asleep. The counter may be gone as soon as they
+        // see 0, which is fine: the wake only hands its address to the kernel.
+        platform_futex_wake_all(&job.counter->pending.value);
+    }
+}
+
+// Runs one job from the thread's own deque or stolen from another thread.
+static bool jobs_run_one(uint32_t self) {
+    Job job;
+    if (deque_pop(&g_jobs.workers[self].deque, &job)) {
+        job_run(job);
+        return true;
+    }
+    for (uint32_t i = 1; i < g_jobs.count; i++) {
+        uint32_t victim = (self + i) % g_jobs.count;
+        if (deque_steal(&g_jobs.workers[victim].deque, &job)) {
+            job_run(job);
+            return true;
+        }
+    }
+    return false;
+}
+
+static int jobs_worker_main(void *arg) {
+    JobWorker *w = arg;
+    w->ctx.worker_index = w->index;
+    thread_context_begin(&w->ctx);
+
+    uint32_t spins = 0;
+    while (atomic_load_u32(&g_jobs.shutdown, ATOMIC_ACQUIRE) == 0) {
+        if (jobs_run_one(w->index)) {
+            spins = 0;
+        } else if (++spins < JOB_SPIN_COUNT) {
+            cpu_relax();
+        } else {
+            spins = 0;
+            jobs_sleep();
+        }
+    }
+
+    profile_thread_end();
+    thread_context_end(&w->ctx);
+    return 0;
+}
+
+uint32_t jobs_init(uint32_t worker_count) {
+    if (g_jobs.running) return 0;
+    if (worker_count == 0) worker_count = platform_cpu_count() - 1;
+    if (worker_count == 0) return 0;
+
+    uint32_t count = worker_count + 1;
+    g_jobs.workers = buddy_alloc(count * sizeof(JobWorker), NULL);
+    if (!g_jobs.workers) return 0;
+    for (uint32_t i = 0; i < count; i++) {
+        JobWorker *w = &g_jobs.workers[i];
+        *w = (JobWorker){0};
+        w->index = i;
+        w->deque.slots = buddy_alloc(JOB_DEQUE_CAPACITY * sizeof(JobSlot), NULL);
+        if (!w->deque.slots) {
+            for (uint32_t j = 0; j < i; j++) buddy_free(g_jobs.workers[j].deque.slots);
+            buddy_free(g_jobs.workers);
+            g_jobs.workers = NULL;
+            return 0;
+        }
+    }
+    atomic_store_u32(&g_jobs.shutdown, 0, ATOMIC_RELAXED);
+    atomic_store_u32(&g_jobs.sleepers, 0, ATOMIC_RELAXED);
+    g_jobs.allocated = count;
+    g_jobs.count = 1;
+    g_jobs.running = true;
+
+    // Workers only look at the first g_jobs.count deques, so the count is
+    // published before each thread starts.
+    for (uint32_t i = 1; i < count; i++) {
+        g_jobs.count = i + 1;
+        if (!platform_thread_create(&g_jobs.workers[i].thread, jobs_worker_main, &g_jobs.workers[i])) {
+            g_jobs.count = i;
+            break;
+        }
+    }
+    if (g_jobs.count == 1) {
+        jobs_shutdown();
+        return 0;
+    }
+    return g_jobs.count - 1;
+}
+
+void jobs_shutdown(void) {
+    if (!g_jobs.running) return;
+    atomic_store_u32(&g_jobs.shutdown, 1, ATOMIC_SEQ_CST);
+    atomic_fetch_add_u32(&g_jobs.wake_seq, 1);
+    platform_futex_wake_all(&g_jobs.wake_seq.value);
+    for (uint32_t i = 1; i < g_jobs.count; i++) {
+        platform_thread_join(g_jobs.workers[i].thread);
+    }
+    for (uint32_t i = 0; i < g_jobs.allocated; i++) {
+        buddy_free(g_jobs.workers[i].deque.slots);
+    }
+    buddy_free(g_jobs.workers);
+    g_jobs.workers = NULL;
+    g_jobs.count = 0;
+    g_jobs.allocated = 0;
+    g_jobs.running = false;
+}
+
+uint32_t jobs_thread_count(void) {
+    return g_jobs.running ? g_jobs.count : 1;
+}
+
+uint32_t jobs_thread_index(void) {
+    return g_jobs.running ? thread_context_get()->worker_index : 0;
+}
+
+void job_spawn(JobCounter *counter, JobFn fn, void *arg) {
+    if (!g_jobs.running) {
+        fn(arg);
+        return;
+    }
+    atomic_fetch_add_u32(&counter->pending, 1);
+    Job job = {.fn = fn, .arg = arg, .counter = counter};
+    if (!deque_push(&g_jobs.workers[jobs_thread_index()].deque, job)) {
+        job_run(job);
+        return;
+    }
+    // Publish the push before checking for sleepers (see jobs_sleep)
+    atomic_thread_fence();
+    jobs_wake();
+}
+
+void job_wait(JobCounter *counter) {
+    if (!g_jobs.running) return;
+    uint32_t self = jobs_thread_index();
+    uint32_t spins = 0;
+    while (atomic_load_u32(&counter->pending, ATOMIC_ACQUIRE) != 0) {
+        if (jobs_run_one(self)) {
+            spins = 0;
+        } else if (++spins < JOB_SPIN_COUNT) {
+            cpu_relax();
+        } else {
+            // Wait for the counter itself rather than for new work: the
+            // thread that spawns work wakes a worker or runs it later
+            spins = 0;
+            uint32_t pending = atomic_load_u32(&counter->pending, ATOMIC_ACQUIRE);
+            if (pending != 0 && !jobs_work_visible()) {
+                platform_futex_wait(&counter->pending.value, pending);
+            }
+        }
+    }
+}
+
+typedef struct {
+    JobRangeFn fn;
+    void *arg;
+    uint64_t begin;
+    uint64_t end;
+} JobRange;
+
+static void job_range_run(void *arg) {
+    JobRange *r = arg;
+    r->fn(r->arg, r->begin, r->end);
+}
+
+void job_parallel_for(uint64_t count, uint64_t batch_size, JobRangeFn fn, void *arg) {
+    if (count == 0) return;
+    uint32_t threads = jobs_thread_count();
+    if (batch_size == 0) {
+        // A few batches per thread so that stealing can balance the load
+        batch_size = (count + threads * 4 - 1) / (threads * 4);
+    }
+    if (threads == 1 || batch_size >= count) {
+        fn(arg, 0, count);
+        return;
+    }
+
+    uint64_t batches = (count + batch_size - 1) / batch_size;
+    Scratch scratch = scratch_begin();
+    JobRange *ranges = arena_alloc_array(scratch.arena, JobRange, batches);
+    JobCounter counter = {0};
+    for (uint64_t i = 0; i < batches; i++) {
+        uint64_t begin = i * batch_size;
+        uint64_t end = begin + batch_size < count ? begin + batch_size : count;
+        ranges[i] = (JobRange){.fn = fn, .arg = arg, .begin = begin, .end = end};
+        job_spawn(&counter, job_range_run, &ranges[i]);
+    }
+    job_wait(&counter);
+    scratch_end(scratch);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <base_types.h>
+#include <atomics.h>
+
+// Work-stealing job system.
+//
+// A fixed pool of worker threads plus the main thread execute jobs. Each of
+// them owns a Chase-Lev deque: jobs are pushed to and popped from the bottom
+// of the spawning thread's deque (LIFO, cache friendly), idle threads steal
+// from the top of the others (FIFO, oldest and usually largest work first).
+// Threads waiting in job_wait run jobs instead of blocking, so jobs may spawn
+// and wait for other jobs.
+//
+// Every worker has its own ThreadContext (base/scratch.h), so scratch_begin*()
+// can be used inside jobs. Jobs must not allocate from arenas shared with
+// other jobs without synchronization.
+//
+// When the job system is not running (jobs_init not called, or no threads
+// available as on WASM), job_spawn runs the job immediately on the calling
+// thread, so callers do not need a separate serial code path.
+//
+// Only the main thread and the workers may spawn or wait for jobs.
+
+typedef void (*JobFn)(void *arg);
+
+// Tracks a group of jobs. Zero-initialize, pass to job_spawn for every job of
+// the group, then wait for all of them with job_wait.
+typedef struct {
+    atomic_u32 pending;
+} JobCounter;
+
+// Starts `worker_count` worker threads in addition to the calling (main)
+// thread; 0 means one per CPU minus the main thread. Must be called from the
+// main thread after platform_init(). Returns the number of workers started,
+// 0 if none could be (jobs then run inline) or if already running.
+uint32_t jobs_init(uint32_t worker_count);
+
+// Stops and joins the workers. All spawned jobs must have been waited for.
+void jobs_shutdown(void);
+
+// Number of threads executing jobs, including the main thread (1 when the
+// job system is not running).
+uint32_t jobs_thread_count(void);
+
+// Index of the calling thread in [0, jobs_thread_count()); 0 on the main
+// thread. Useful to index per-thread data in jobs.
+uint32_t jobs_thread_index(void);
+
+// Queues fn(arg) as part of `counter`.
+void job_spawn(JobCounter *counter, JobFn fn, void *arg);
+
+// Returns once every job spawned with `counter` has finished, running queued
+// jobs in the meantime.
+void job_wait(JobCounter *counter);
+
+typedef void (*JobRangeFn)(void *arg, uint64_t begin, uint64_t end);
+
+// Calls fn(arg, begin, end) for consecutive ranges covering [0, count) of at
+// most `batch_size` items (0 picks a size giving a few batches per thread),
+// in parallel, and returns when all of them are done.
+void job_parallel_for(uint64_t count, uint64_t batch_size, JobRangeFn fn, void *arg);
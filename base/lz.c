@@ -0,0 +1,321 @@
+#include <base/lz.h>
+
+#define LZ_MIN_MATCH 4
+// The format requires the last 5 bytes to be literals and the last match to
+// start at least 12 bytes before the end
+#define LZ_LAST_LITERALS 5
+#define LZ_MATCH_LIMIT 12
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS 12
+// After every 2^LZ_SKIP_SHIFT probes without a match the compressor advances
+// one more byte per probe, so incompressible data goes by quickly
+#define LZ_SKIP_SHIFT 6
+
+static inline uint32_t lz_read32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline uint64_t lz_read64(const uint8_t *p) {
+    return (uint64_t)lz_read32(p) | (uint64_t)lz_read32(p + 4) << 32;
+}
+
+static inline void lz_write32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static inline void lz_write64(uint8_t *p, uint64_t value) {
+    lz_write32(p, (uint32_t)value);
+    lz_write32(p + 4, (uint32_t)(value >> 32));
+}
+
+static inline uint32_t lz_hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Forward copy in 8-byte steps; correct for overlapping ranges as long as
+// src is at least 8 bytes before dst
+static inline void lz_copy(uint8_t *dst, const uint8_t *src, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t chunk = lz_read64(src + i);
+        lz_write64(dst + i, chunk);
+    }
+    for (; i < size; i++) dst[i] = src[i];
+}
+
+// Copies whole 8-byte chunks, writing up to 7 bytes past dst + size; the
+// caller checks that there is room
+static inline void lz_wild_copy(uint8_t *dst, const uint8_t *src, size_t size) {
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t chunk = lz_read64(src + i);
+        lz_write64(dst + i, chunk);
+    }
+}
+
+size_t lz_compress_bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+static uint8_t *lz_write_length(uint8_t *op, size_t length) {
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+// Writes `literal_count` literals followed by a match of `match_length`
+// bytes `offset` back (none if match_length is 0). Returns NULL if the
+// sequence might not fit before `op_end`.
+static uint8_t *lz_write_sequence(uint8_t *op, uint8_t *op_end, const uint8_t *literals, size_t literal_count,
+                                  size_t offset, size_t match_length) {
+    // Token, offset and the last byte of both lengths, plus the literals and
+    // the 255 bytes of long lengths
+    size_t worst = 5 + literal_count + literal_count / 255 + match_length / 255;
+    if ((size_t)(op_end - op) < worst) return NULL;
+
+    uint8_t *token = op++;
+    if (literal_count >= 15) {
+        *token = 15 << 4;
+        op = lz_write_length(op, literal_count - 15);
+    } else {
+        *token = (uint8_t)(literal_count << 4);
+    }
+    lz_copy(op, literals, literal_count);
+    op += literal_count;
+    if (match_length == 0) return op;
+
+    op[0] = (uint8_t)offset;
+    op[1] = (uint8_t)(offset >> 8);
+    op += 2;
+    size_t length = match_length - LZ_MIN_MATCH;
+    if (length >= 15) {
+        *token |= 15;
+        op = lz_write_length(op, length - 15);
+    } else {
+        *token |= (uint8_t)length;
+    }
+    return op;
+}
+
+size_t lz_compress(const void *src, size_t size, void *dst, size_t capacity) {
+    const uint8_t *in = src;
+    uint8_t *op = dst;
+    uint8_t *op_end = op + capacity;
+    const uint8_t *anchor = in;
+
+    if (size > LZ_MATCH_LIMIT) {
+        // Position of the last occurrence of each hashed 4-byte sequence;
+        // stale or colliding entries are caught by comparing the bytes
+        uint32_t table[1 << LZ_HASH_BITS];
+        for (uint32_t i = 0; i < (1 << LZ_HASH_BITS); i++) table[i] = 0;
+
+        const uint8_t *match_start_limit = in + size - LZ_MATCH_LIMIT;
+        const uint8_t *match_end_limit = in + size - LZ_LAST_LITERALS;
+        const uint8_t *ip = in + 1;
+        uint32_t misses = 0;
+        while (ip < match_start_limit) {
+            uint32_t sequence = lz_read32(ip);
+            uint32_t hash = lz_hash(sequence);
+            const uint8_t *ref = in + table[hash];
+            table[hash] = (uint32_t)(ip - in);
+            if (ip - ref > LZ_MAX_OFFSET || lz_read32(ref) != sequence) {
+                ip += 1 + (misses++ >> LZ_SKIP_SHIFT);
+                continue;
+            }
+            misses = 0;
+
+            while (ip > anchor && ref > in && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            size_t length = LZ_MIN_MATCH;
+            while (ip + length < match_end_limit && ip[length] == ref[length]) length++;
+
+            op = lz_write_sequence(op, op_end, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), length);
+            if (!op) return LZ_ERROR;
+            ip += length;
+            anchor = ip;
+            // Catches matches that start inside this one
+            if (ip < match_start_limit) table[lz_hash(lz_read32(ip - 2))] = (uint32_t)(ip - 2 - in);
+        }
+    }
+
+    op = lz_write_sequence(op, op_end, anchor, (size_t)(in + size - anchor), 0, 0);
+    if (!op) return LZ_ERROR;
+    return (size_t)(op - (uint8_t *)dst);
+}
+
+// Adds the bytes of a long length to *length. Returns NULL at the end of
+// the input.
+static const uint8_t *lz_read_length(const uint8_t *ip, const uint8_t *ip_end, size_t *length) {
+    uint8_t byte;
+    do {
+        if (ip == ip_end) return NULL;
+        byte = *ip++;
+        *length += byte;
+    } while (byte == 255);
+    return ip;
+}
+
+size_t lz_decompress(const void *src, size_t src_size, void *dst, size_t capacity) {
+    const uint8_t *ip = src;
+    const uint8_t *ip_end = ip + src_size;
+    uint8_t *out = dst;
+    uint8_t *op = out;
+    uint8_t *op_end = out + capacity;
+
+    for (;;) {
+        if (ip == ip_end) return LZ_ERROR;
+        uint8_t token = *ip++;
+
+        size_t literal_count = token >> 4;
+        if (literal_count == 15) {
+            ip = lz_read_length(ip, ip_end, &literal_count);
+            if (!ip) return LZ_ERROR;
+        }
+        if ((size_t)(ip_end - ip) < literal_count || (size_t)(op_end - op) < literal_count) return LZ_ERROR;
+        if ((size_t)(ip_end - ip) - literal_count >= 8 && (size_t)(op_end - op) - literal_count >= 8) {
+            lz_wild_copy(op, ip, literal_count);
+        } else {
+            lz_copy(op, ip, literal_count);
+        }
+        ip += literal_count;
+        op += literal_count;
+        // Only the last sequence has no match
+        if (ip == ip_end) return (size_t)(op - out);
+
+        if (ip_end - ip < 2) return LZ_ERROR;
+        size_t offset = (size_t)ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        size_t length = token & 15;
+        if (length == 15) {
+            ip = lz_read_length(ip, ip_end, &length);
+            if (!ip) return LZ_ERROR;
+        }
+        length += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - out) || (size_t)(op_end - op) < length) return LZ_ERROR;
+
+        const uint8_t *ref = op - offset;
+        if (offset >= 8 && (size_t)(op_end - op) - length >= 8) {
+            lz_wild_copy(op, ref, length);
+        } else if (offset >= 8) {
+            lz_copy(op, ref, length);
+        } else {
+            // Overlapping match: byte by byte repeats the last `offset` bytes
+            for (size_t i = 0; i < length; i++) op[i] = ref[i];
+        }
+        op += length;
+    }
+}
+
+static uint32_t lz_frame_blocks_for(uint64_t size, uint32_t block_size) {
+    return (uint32_t)((size + block_size - 1) / block_size);
+}
+
+size_t lz_frame_prefix_size(uint64_t size, uint32_t block_size) {
+    return LZ_FRAME_HEADER_SIZE + (size_t)lz_frame_blocks_for(size, block_size) * sizeof(uint64_t);
+}
+
+size_t lz_frame_bound(uint64_t size, uint32_t block_size) {
+    return lz_frame_prefix_size(size, block_size) + (size_t)size;
+}
+
+void lz_frame_begin(void *prefix, uint64_t size, uint32_t block_size) {
+    uint8_t *p = prefix;
+    lz_write64(p, size);
+    lz_write32(p + 8, block_size);
+    lz_write32(p + 12, lz_frame_blocks_for(size, block_size));
+}
+
+// Decoded size of block `index`
+static size_t lz_frame_block_size(uint64_t size, uint32_t block_size, uint32_t index) {
+    uint64_t begin = (uint64_t)index * block_size;
+    return (size_t)(size - begin < block_size ? size - begin : block_size);
+}
+
+size_t lz_frame_compress_block(void *prefix, uint32_t index, const void *src, void *dst) {
+    uint8_t *p = prefix;
+    size_t size = lz_frame_block_size(lz_read64(p), lz_read32(p + 8), index);
+    uint8_t *ends = p + LZ_FRAME_HEADER_SIZE;
+
+    size_t stored = size > 0 ? lz_compress(src, size, dst, size - 1) : LZ_ERROR;
+    if (stored == LZ_ERROR) {
+        lz_copy(dst, src, size);
+        stored = size;
+    }
+    uint64_t begin = index > 0 ? lz_read64(ends + (index - 1) * sizeof(uint64_t)) : 0;
+    lz_write64(ends + index * sizeof(uint64_t), begin + stored);
+    return stored;
+}
+
+size_t lz_frame_compress(const void *src, size_t size, uint32_t block_size, void *dst, size_t capacity) {
+    if (block_size == 0 || capacity < lz_frame_bound(size, block_size)) return LZ_ERROR;
+    const uint8_t *in = src;
+    uint8_t *out = dst;
+    lz_frame_begin(out, size, block_size);
+    uint32_t block_count = lz_frame_blocks_for(size, block_size);
+    size_t prefix_size = lz_frame_prefix_size(size, block_size);
+    uint8_t *op = out + prefix_size;
+    for (uint32_t i = 0; i < block_count; i++) {
+        op += lz_frame_compress_block(out, i, in + (size_t)i * block_size, op);
+    }
+    return (size_t)(op - out);
+}
+
+size_t lz_frame_size(const void *frame, size_t frame_size) {
+    const uint8_t *p = frame;
+    if (frame_size < LZ_FRAME_HEADER_SIZE) return LZ_ERROR;
+    uint64_t size = lz_read64(p);
+    uint32_t block_size = lz_read32(p + 8);
+    uint32_t block_count = lz_read32(p + 12);
+    if (size >= LZ_ERROR || block_size == 0 || block_count != lz_frame_blocks_for(size, block_size)) return LZ_ERROR;
+    if ((frame_size - LZ_FRAME_HEADER_SIZE) / sizeof(uint64_t) < block_count) return LZ_ERROR;
+
+    // Every block holds 1 to its decoded size bytes, and the last one ends
+    // at the end of the frame
+    uint64_t data_size = frame_size - LZ_FRAME_HEADER_SIZE - (uint64_t)block_count * sizeof(uint64_t);
+    uint64_t end = 0;
+    for (uint32_t i = 0; i < block_count; i++) {
+        uint64_t next = lz_read64(p + LZ_FRAME_HEADER_SIZE + i * sizeof(uint64_t));
+        if (next <= end || next - end > lz_frame_block_size(size, block_size, i)) return LZ_ERROR;
+        end = next;
+    }
+    if (end != data_size) return LZ_ERROR;
+    return (size_t)size;
+}
+
+uint32_t lz_frame_block_count(const void *frame) {
+    return lz_read32((const uint8_t *)frame + 12);
+}
+
+bool lz_frame_decompress_blocks(const void *frame, void *dst, uint32_t begin, uint32_t end) {
+    const uint8_t *p = frame;
+    uint64_t size = lz_read64(p);
+    uint32_t block_size = lz_read32(p + 8);
+    uint32_t block_count = lz_read32(p + 12);
+    const uint8_t *ends = p + LZ_FRAME_HEADER_SIZE;
+    const uint8_t *data = ends + (size_t)block_count * sizeof(uint64_t);
+    uint8_t *out = dst;
+
+    for (uint32_t i = begin; i < end; i++) {
+        size_t block_begin = i > 0 ? (size_t)lz_read64(ends + (i - 1) * sizeof(uint64_t)) : 0;
+        size_t stored = (size_t)lz_read64(ends + i * sizeof(uint64_t)) - block_begin;
+        size_t decoded = lz_frame_block_size(size, block_size, i);
+        uint8_t *block_out = out + (size_t)i * block_size;
+        if (stored == decoded) {
+            lz_copy(block_out, data + block_begin, decoded);
+        } else if (lz_decompress(data + block_begin, stored, block_out, decoded) != decoded) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t lz_frame_decompress(const void *frame, size_t frame_size, void *dst, size_t capacity) {
+    size_t size = lz_frame_size(frame, frame_size);
+    if (size == LZ_ERROR || size > capacity) return LZ_ERROR;
+    if (!lz_frame_decompress_blocks(frame, dst, 0, lz_frame_block_count(frame))) return LZ_ERROR;
+    return size;
+}
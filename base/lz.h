@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// LZ77 compression in the LZ4 block format (reference lz4 decodes our
+// output and vice versa). There is no entropy coding, so decoding is a loop
+// of bounds-checked literal and match copies, several times faster than
+// inflate; the price is a lower ratio than zstd or deflate (about 2-6x on
+// source text and shaders). The compressor is greedy with a 4096-entry hash
+// table of 4-byte sequences.
+//
+// Only <stdint.h> and <stddef.h> are needed, so host tools built against libc
+// (bundler.c) compile this file too.
+
+// Returned by the functions below for malformed input or a too small output
+#define LZ_ERROR ((size_t)-1)
+
+// Largest compressed size of `size` bytes
+size_t lz_compress_bound(size_t size);
+
+// Compresses `size` bytes of `src` into `dst` and returns the compressed
+// size, or LZ_ERROR if that would exceed `capacity` (never the case for
+// capacity >= lz_compress_bound(size)).
+size_t lz_compress(const void *src, size_t size, void *dst, size_t capacity);
+
+// Decompresses `src_size` bytes of `src` into `dst` and returns the
+// decompressed size, or LZ_ERROR if the data is malformed or does not fit in
+// `capacity`. Never reads or writes out of bounds, whatever the input.
+size_t lz_decompress(const void *src, size_t src_size, void *dst, size_t capacity);
+
+// Frames split data of any size into blocks of `block_size` bytes (the last
+// may be shorter) that are compressed independently, so they can be decoded
+// in any order or in parallel. Layout, little-endian:
+//
+// [uint64_t size][uint32_t block_size][uint32_t block_count]
+// [uint64_t block_ends[block_count]]  ← end of each block's data, counted from
+//                                       the end of this table
+// [Block data]
+//
+// A block whose data is as long as its decoded size is stored uncompressed,
+// so a frame is never more than the header and table larger than its data.
+
+#define LZ_FRAME_HEADER_SIZE 16
+#define LZ_FRAME_BLOCK_SIZE (256 * 1024)
+
+// Size of the header and block table of a frame of `size` bytes
+size_t lz_frame_prefix_size(uint64_t size, uint32_t block_size);
+
+// Largest frame of `size` bytes
+size_t lz_frame_bound(uint64_t size, uint32_t block_size);
+
+// Compresses `size` bytes of `src` into a frame at `dst`. Returns the frame
+// size, or LZ_ERROR if block_size is 0 or capacity < lz_frame_bound().
+size_t lz_frame_compress(const void *src, size_t size, uint32_t block_size, void *dst, size_t capacity);
+
+// Streaming compression, for data that is not in memory all at once:
+// lz_frame_begin writes the header of a frame into `prefix`
+// (lz_frame_prefix_size bytes), then lz_frame_compress_block compresses block
+// `index` (blocks in order) from `src` to `dst`, which has room for its
+// decoded size, fills in its table entry and returns its data size. The
+// frame is the prefix followed by the block data.
+void lz_frame_begin(void *prefix, uint64_t size, uint32_t block_size);
+size_t lz_frame_compress_block(void *prefix, uint32_t index, const void *src, void *dst);
+
+// Validates the header and block table of the `frame_size` bytes at `frame`.
+// Returns the decoded size, or LZ_ERROR if they are malformed.
+size_t lz_frame_size(const void *frame, size_t frame_size);
+
+uint32_t lz_frame_block_count(const void *frame);
+
+// Decodes blocks [begin, end) of a frame validated with lz_frame_size into
+// their place in `dst`, which has room for the whole decoded size. Returns
+// false if a block is malformed. Disjoint ranges can be decoded
+// concurrently, for example as a job_parallel_for over the blocks.
+bool lz_frame_decompress_blocks(const void *frame, void *dst, uint32_t begin, uint32_t end);
+
+// Validates and decodes a whole frame into `dst`. Returns the decoded size,
+// or LZ_ERROR if the frame is malformed or does not fit in `capacity`.
+size_t lz_frame_decompress(const void *frame, size_t frame_size, void *dst, size_t capacity);
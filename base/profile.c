@@ -0,0 +1,195 @@
+#include <base/profile.h>
+#include <base/arena.h>
+#include <base/scratch.h>
+#include <base/atomics.h>
+#include <base/format.h>
+#include <base/base_io.h>
+#include <base/mem.h>
+#include <platform/platform.h>
+
+// The trace is written in pieces of about this size
+#define PROFILE_WRITE_BUFFER_SIZE (64 * 1024)
+
+typedef struct {
+    const char *name;
+    uint64_t begin;  // platform_cycles()
+    uint64_t end;
+} ProfileEvent;
+
+// A thread's recorded zones. Threads are never unregistered, so the zones of
+// threads that have exited (e.g. job workers after jobs_shutdown) can still be
+// written out. The ring of an exited thread is reused by the next thread with
+// the same worker index, so restarting the job system allocates no new ones.
+typedef struct ProfileThread {
+    Arena *arena;
+    ProfileEvent *events;     // Ring of PROFILE_RING_CAPACITY completed zones
+    uint64_t event_count;     // Zones completed since the last reset
+    uint32_t depth;           // Open zones, may exceed PROFILE_MAX_DEPTH
+    const char *open_names[PROFILE_MAX_DEPTH];
+    uint64_t open_begins[PROFILE_MAX_DEPTH];
+    uint32_t id;              // "tid" in the trace
+    uint32_t worker_index;
+    atomic_u32 in_use;        // 0 once its thread called profile_thread_end
+    struct ProfileThread *next;
+} ProfileThread;
+
+static atomic_ptr g_profile_threads;   // Lock-free list, newest first
+static atomic_u32 g_profile_thread_count;
+static atomic_u64 g_profile_start;     // Cycles at the first zone, 0 before
+
+static ProfileThread *profile_thread_create(ThreadContext *ctx) {
+    ProfileThread *t = atomic_load_ptr(&g_profile_threads, ATOMIC_ACQUIRE);
+    for (; t; t = t->next) {
+        uint32_t idle = 0;
+        if (t->worker_index == ctx->worker_index && atomic_compare_exchange_u32(&t->in_use, &idle, 1)) {
+            ctx->profile = t;
+            return t;
+        }
+    }
+
+    Arena *arena = arena_new(sizeof(ProfileThread) + PROFILE_RING_CAPACITY * sizeof(ProfileEvent) + 64);
+    if (!arena) return NULL;
+    t = arena_alloc(arena, sizeof(ProfileThread));
+    base_memset(t, 0, sizeof(ProfileThread));
+    t->arena = arena;
+    t->events = arena_alloc_array(arena, ProfileEvent, PROFILE_RING_CAPACITY);
+    t->id = atomic_fetch_add_u32(&g_profile_thread_count, 1);
+    t->worker_index = ctx->worker_index;
+    atomic_store_u32(&t->in_use, 1, ATOMIC_RELAXED);
+
+    uint64_t zero = 0;
+    atomic_compare_exchange_u64(&g_profile_start, &zero, platform_cycles());
+
+    void *head = atomic_load_ptr(&g_profile_threads, ATOMIC_RELAXED);
+    do {
+        t->next = head;
+    } while (!atomic_compare_exchange_ptr(&g_profile_threads, &head, t));
+    ctx->profile = t;
+    return t;
+}
+
+void profile_begin(const char *name) {
+    ThreadContext *ctx = thread_context_get();
+    ProfileThread *t = ctx->profile ? ctx->profile : profile_thread_create(ctx);
+    if (!t) return;
+    if (t->depth < PROFILE_MAX_DEPTH) {
+        t->open_names[t->depth] = name;
+        t->open_begins[t->depth] = platform_cycles();
+    }
+    t->depth++;
+}
+
+void profile_end(void) {
+    uint64_t end = platform_cycles();
+    ProfileThread *t = thread_context_get()->profile;
+    if (!t || t->depth == 0) return;
+    t->depth--;
+    if (t->depth >= PROFILE_MAX_DEPTH) return;
+    ProfileEvent *e = &t->events[t->event_count % PROFILE_RING_CAPACITY];
+    e->name = t->open_names[t->depth];
+    e->begin = t->open_begins[t->depth];
+    e->end = end;
+    t->event_count++;
+}
+
+void profile_thread_end(void) {
+    ThreadContext *ctx = thread_context_get();
+    ProfileThread *t = ctx->profile;
+    if (!t) return;
+    t->depth = 0;
+    ctx->profile = NULL;
+    atomic_store_u32(&t->in_use, 0, ATOMIC_RELEASE);
+}
+
+void profile_reset(void) {
+    ProfileThread *t = atomic_load_ptr(&g_profile_threads, ATOMIC_ACQUIRE);
+    for (; t; t = t->next) {
+        t->event_count = 0;
+    }
+}
+
+typedef struct {
+    wasi_fd_t fd;
+    char *data;
+    size_t size;
+    bool ok;
+} TraceWriter;
+
+static void trace_flush(TraceWriter *w) {
+    if (w->size > 0 && w->ok) {
+        ciovec_t iov = {.buf = w->data, .buf_len = w->size};
+        w->ok = write_all(w->fd, &iov, 1) == 0;
+    }
+    w->size = 0;
+}
+
+static void trace_write(TraceWriter *w, string s) {
+    if (w->size + s.size > PROFILE_WRITE_BUFFER_SIZE) trace_flush(w);
+    if (s.size > PROFILE_WRITE_BUFFER_SIZE) {
+        ciovec_t iov = {.buf = s.str, .buf_len = s.size};
+        w->ok = w->ok && write_all(w->fd, &iov, 1) == 0;
+        return;
+    }
+    base_memcpy(w->data + w->size, s.str, s.size);
+    w->size += s.size;
+}
+
+// Microseconds since the first zone
+static double trace_us(uint64_t cycles, uint64_t start, uint64_t frequency) {
+    return (double)(int64_t)(cycles - start) * 1000000.0 / (double)frequency;
+}
+
+bool profile_write_chrome_trace(string path) {
+    Scratch scratch = scratch_begin();
+    char *cpath = arena_alloc(scratch.arena, path.size + 1);
+    base_memcpy(cpath, path.str, path.size);
+    cpath[path.size] = '\0';
+    wasi_fd_t fd = wasi_path_open(cpath, path.size, WASI_RIGHTS_WRITE, WASI_O_CREAT | WASI_O_TRUNC);
+    if (fd < 0) {
+        scratch_end(scratch);
+        return false;
+    }
+
+    TraceWriter w = {
+        .fd = fd,
+        .data = arena_alloc(scratch.arena, PROFILE_WRITE_BUFFER_SIZE),
+        .ok = true,
+    };
+    uint64_t frequency = platform_cycle_frequency();
+    uint64_t start = atomic_load_u64(&g_profile_start, ATOMIC_ACQUIRE);
+    bool first = true;
+
+    trace_write(&w, str_lit("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"));
+    ProfileThread *t = atomic_load_ptr(&g_profile_threads, ATOMIC_ACQUIRE);
+    for (; t; t = t->next) {
+        arena_pos_t pos = arena_get_pos(scratch.arena);
+        string thread_name = t->worker_index == 0
+            ? str_lit("main")
+            : format(scratch.arena, str_lit("worker {}"), t->worker_index);
+        if (!first) trace_write(&w, str_lit(",\n"));
+        first = false;
+        trace_write(&w, format(scratch.arena,
+                str_lit("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}"),
+                t->id, thread_name));
+
+        // Oldest first; zones overwritten in the ring are gone
+        uint64_t count = t->event_count;
+        uint64_t i = count > PROFILE_RING_CAPACITY ? count - PROFILE_RING_CAPACITY : 0;
+        for (; i < count; i++) {
+            ProfileEvent *e = &t->events[i % PROFILE_RING_CAPACITY];
+            trace_write(&w, format(scratch.arena,
+                    str_lit(",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3},\"dur\":{:.3}}"),
+                    str_from_cstr_view((char *)e->name), t->id,
+                    trace_us(e->begin, start, frequency), trace_us(e->end, e->begin, frequency)));
+            // Keep the scratch from growing with the number of zones
+            arena_reset(scratch.arena, pos);
+        }
+        arena_reset(scratch.arena, pos);
+    }
+    trace_write(&w, str_lit("\n]}\n"));
+    trace_flush(&w);
+    bool ok = w.ok;
+    wasi_fd_close(fd);
+    scratch_end(scratch);
+    return ok;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <base_types.h>
+#include <base_string.h>
+
+// Instrumentation profiler.
+//
+// Zones mark named regions of code. Each thread records its completed zones
+// (name, begin and end timestamp from platform_cycles) into its own ring
+// buffer, allocated from an arena on the thread's first zone, so recording
+// takes no locks. When the ring is full the oldest zones are overwritten.
+// Zones nest; the hierarchy is reconstructed from the timestamps by the trace
+// viewer.
+//
+// Zones are recorded on threads that have a ThreadContext (base/scratch.h):
+// the main thread and the job system workers.
+//
+// The PROFILE_* macros compile to nothing unless the program is built with
+// -DWITH_PROFILE, so instrumentation can stay in the code. The functions
+// below are always available.
+//
+//     void update(void) {
+//         PROFILE_ZONE("update");       // Ends when the enclosing scope exits
+//         ...
+//         PROFILE_BEGIN("physics");     // Explicit range
+//         ...
+//         PROFILE_END();
+//     }
+//
+// PROFILE_ZONE relies on the cleanup attribute (GCC, Clang). MSVC's C compiler
+// has none, so there PROFILE_ZONE compiles to nothing and only
+// PROFILE_BEGIN/PROFILE_END ranges are recorded.
+
+// Completed zones kept per thread
+#ifndef PROFILE_RING_CAPACITY
+#define PROFILE_RING_CAPACITY (1 << 14)
+#endif
+
+// Maximum nesting depth of zones on one thread; deeper zones are ignored
+#define PROFILE_MAX_DEPTH 64
+
+// Starts a zone on the calling thread. `name` must be a string literal (it is
+// stored by pointer) without quotes or backslashes.
+void profile_begin(const char *name);
+
+// Ends the innermost zone started on the calling thread.
+void profile_end(void);
+
+// Stops recording on the calling thread, which is about to exit. Its zones
+// are kept, and its ring is reused by the next thread that starts with the
+// same worker index (the job workers call this, so each jobs_init reuses the
+// rings of the previous workers).
+void profile_thread_end(void);
+
+// Writes every recorded zone of every thread as a Chrome trace-event JSON file
+// (chrome://tracing, ui.perfetto.dev), with timestamps in microseconds since
+// the first zone. Other threads must not be recording zones meanwhile.
+// Returns false if the file could not be written.
+bool profile_write_chrome_trace(string path);
+
+// Drops all recorded zones. Same restriction as profile_write_chrome_trace.
+void profile_reset(void);
+
+typedef struct {
+    uint8_t unused;
+} ProfileScope;
+
+static inline ProfileScope profile_scope_begin(const char *name) {
+    profile_begin(name);
+    return (ProfileScope){0};
+}
+
+static inline void profile_scope_end(ProfileScope *scope) {
+    (void)scope;
+    profile_end();
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(WITH_PROFILE)
+#define PROFILE_BEGIN(name) profile_begin(name)
+#define PROFILE_END() profile_end()
+#if defined(_MSC_VER)
+#define PROFILE_ZONE(name) ((void)0)
+#else
+#define PROFILE_ZONE(name) \
+    ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__) \
+        __attribute__((cleanup(profile_scope_end), unused)) = profile_scope_begin(name)
+#endif
+#else
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#define PROFILE_ZONE(name) ((void)0)
+#endif
@@ -10,20 +10,38 @@ Scratch scratch_begin() {
     return scratch_begin_avoid_conflict(NULL);
 }
 
-Arena* scratch_arenas[2] = {NULL, NULL};
+// Used by the main thread (and any thread that never called
+// thread_context_begin).
+static ThreadContext main_thread_context = {0};
 
-void init_scratch_arenas() {
-    scratch_arenas[0] = arena_new(1024);
-    scratch_arenas[1] = arena_new(1024);
+ThreadContext *thread_context_get(void) {
+    ThreadContext *ctx = platform_tls_get();
+    return ctx ? ctx : &main_thread_context;
+}
+
+void thread_context_begin(ThreadContext *ctx) {
+    ctx->scratch_arenas[0] = arena_new(1024);
+    ctx->scratch_arenas[1] = arena_new(1024);
+    platform_tls_set(ctx);
+}
+
+void thread_context_end(ThreadContext *ctx) {
+    arena_free(ctx->scratch_arenas[0]);
+    arena_free(ctx->scratch_arenas[1]);
+    ctx->scratch_arenas[0] = NULL;
+    ctx->scratch_arenas[1] = NULL;
+    platform_tls_set(NULL);
 }
 
 Scratch scratch_begin_avoid_conflict(Arena *conflict) {
-    if (scratch_arenas[0] == NULL) {
-        init_scratch_arenas();
+    ThreadContext *ctx = thread_context_get();
+    if (ctx->scratch_arenas[0] == NULL) {
+        ctx->scratch_arenas[0] = arena_new(1024);
+        ctx->scratch_arenas[1] = arena_new(1024);
     }
     for (int i = 0; i < 2; i++) {
-        if (scratch_arenas[i] != conflict) {
-            return scratch_begin_from_arena(scratch_arenas[i]);
+        if (ctx->scratch_arenas[i] != conflict) {
+            return scratch_begin_from_arena(ctx->scratch_arenas[i]);
         }
     }
     FATAL_ERROR("Cannot find conflict-free arena.");
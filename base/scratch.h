@@ -8,8 +8,8 @@ typedef struct {
     arena_pos_t saved_pos;
 } Scratch;
 
-// Internally there are 2 scratch arenas. You can use a scratch in the
-// region marked by scratch_begin*() and scratch_end().
+// Internally there are 2 scratch arenas per thread. You can use a scratch in
+// the region marked by scratch_begin*() and scratch_end().
 
 // Use if there are no other arenas that you allocate from in the scratch region.
 // Always returns the first scratch arena.
@@ -52,3 +52,24 @@ Scratch scratch_begin_from_arena(Arena *arena);
 // Marks the end of the scratch region. Resets the arena that was used to
 // create the scratch to the position before the scratch.
 void scratch_end(Scratch scratch);
+
+// Per-thread state. Every thread has its own pair of scratch arenas, so the
+// scratch API can be used from any thread. The main thread's context is
+// created on first use; other threads call thread_context_begin() when they
+// start and thread_context_end() before they exit (the job system does this
+// for its workers).
+typedef struct {
+    Arena *scratch_arenas[2];
+    uint32_t worker_index;  // Index in the job system (0 on the main thread)
+    struct ProfileThread *profile;  // Zones recorded by base/profile.h
+} ThreadContext;
+
+// Creates the scratch arenas in `ctx` and makes it the calling thread's
+// context. `ctx` must stay alive until thread_context_end().
+void thread_context_begin(ThreadContext *ctx);
+
+// Frees the scratch arenas in `ctx` and detaches it from the calling thread.
+void thread_context_end(ThreadContext *ctx);
+
+// Returns the calling thread's context.
+ThreadContext *thread_context_get(void);
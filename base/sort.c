@@ -0,0 +1,143 @@
+#include <base/sort.h>
+
+static inline void sort_swap(char *a, char *b, size_t size) {
+    if (((uintptr_t)a | (uintptr_t)b | size) % sizeof(uint64_t) == 0) {
+        uint64_t *wa = (uint64_t *)a;
+        uint64_t *wb = (uint64_t *)b;
+        for (size_t i = 0; i < size / sizeof(uint64_t); i++) {
+            uint64_t t = wa[i];
+            wa[i] = wb[i];
+            wb[i] = t;
+        }
+        return;
+    }
+    for (size_t i = 0; i < size; i++) {
+        char t = a[i];
+        a[i] = b[i];
+        b[i] = t;
+    }
+}
+
+static void insertion_sort(char *base, size_t count, size_t size, SortCompareFn compare) {
+    for (size_t i = 1; i < count; i++) {
+        for (size_t j = i; j > 0 && compare(base + (j - 1) * size, base + j * size) > 0; j--) {
+            sort_swap(base + (j - 1) * size, base + j * size, size);
+        }
+    }
+}
+
+static void sift_down(char *base, size_t root, size_t count, size_t size, SortCompareFn compare) {
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= count) return;
+        if (child + 1 < count && compare(base + child * size, base + (child + 1) * size) < 0) {
+            child++;
+        }
+        if (compare(base + root * size, base + child * size) >= 0) return;
+        sort_swap(base + root * size, base + child * size, size);
+        root = child;
+    }
+}
+
+static void heap_sort(char *base, size_t count, size_t size, SortCompareFn compare) {
+    for (size_t i = count / 2; i > 0; i--) {
+        sift_down(base, i - 1, count, size, compare);
+    }
+    for (size_t end = count - 1; end > 0; end--) {
+        sort_swap(base, base + end * size, size);
+        sift_down(base, 0, end, size, compare);
+    }
+}
+
+// Partitions count > SORT_INSERTION_THRESHOLD elements around the median of
+// the first, middle and last one. Returns the pivot's final index p: elements
+// before it compare <= and elements after it >= the pivot. Both scans stop on
+// elements equal to the pivot, so equal elements end up on both sides.
+static size_t partition(char *base, size_t count, size_t size, SortCompareFn compare) {
+    char *first = base + size;
+    char *mid = base + (count / 2) * size;
+    char *last = base + (count - 1) * size;
+    if (compare(mid, first) < 0) sort_swap(mid, first, size);
+    if (compare(last, mid) < 0) {
+        sort_swap(last, mid, size);
+        if (compare(mid, first) < 0) sort_swap(mid, first, size);
+    }
+    // The pivot goes first; first <= pivot <= last stop the scans
+    sort_swap(base, mid, size);
+
+    size_t i = 1;
+    size_t j = count - 1;
+    for (;;) {
+        do i++; while (compare(base + i * size, base) < 0);
+        do j--; while (compare(base, base + j * size) < 0);
+        if (i >= j) break;
+        sort_swap(base + i * size, base + j * size, size);
+    }
+    sort_swap(base, base + j * size, size);
+    return j;
+}
+
+// Recursion depth after which heapsort takes over
+static uint32_t depth_limit(size_t count) {
+    return 2 * sort_log2(count);
+}
+
+static void introsort(char *base, size_t count, size_t size, SortCompareFn compare, uint32_t depth) {
+    while (count > SORT_INSERTION_THRESHOLD) {
+        if (depth == 0) {
+            heap_sort(base, count, size, compare);
+            return;
+        }
+        depth--;
+        size_t p = partition(base, count, size, compare);
+        // Recurse into the smaller side, loop on the larger one
+        if (p < count - p - 1) {
+            introsort(base, p, size, compare, depth);
+            base += (p + 1) * size;
+            count -= p + 1;
+        } else {
+            introsort(base + (p + 1) * size, count - p - 1, size, compare, depth);
+            count = p;
+        }
+    }
+    insertion_sort(base, count, size, compare);
+}
+
+void sort(void *base, size_t count, size_t size, SortCompareFn compare) {
+    if (count < 2) return;
+    introsort(base, count, size, compare, depth_limit(count));
+}
+
+void sort_select(void *base, size_t count, size_t size, size_t nth, SortCompareFn compare) {
+    if (nth >= count) return;
+    char *b = base;
+    uint32_t depth = depth_limit(count);
+    while (count > SORT_INSERTION_THRESHOLD) {
+        if (depth == 0) {
+            heap_sort(b, count, size, compare);
+            return;
+        }
+        depth--;
+        size_t p = partition(b, count, size, compare);
+        if (p == nth) return;
+        if (nth < p) {
+            count = p;
+        } else {
+            b += (p + 1) * size;
+            nth -= p + 1;
+            count -= p + 1;
+        }
+    }
+    insertion_sort(b, count, size, compare);
+}
+
+void sort_partial(void *base, size_t count, size_t size, size_t k, SortCompareFn compare) {
+    if (k >= count) {
+        sort(base, count, size, compare);
+        return;
+    }
+    if (k == 0) return;
+    // The k smallest end up before index k, then only they are sorted
+    sort_select(base, count, size, k, compare);
+    sort(base, k, size, compare);
+}
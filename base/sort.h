@@ -0,0 +1,237 @@
+#pragma once
+
+#include <base_types.h>
+#include <base/generic.h>
+
+// In-place sorting and selection of arrays of `count` elements of `size`
+// bytes. `compare` returns <0, 0 or >0 like memcmp; elements are ordered
+// ascending.
+//
+// sort is an introsort: quicksort with median-of-three pivots and a
+// partition that splits runs of equal elements evenly, falling back to
+// heapsort when the recursion gets too deep and to insertion sort for short
+// ranges. It takes O(n log n) time in the worst case and O(log n) stack, and
+// is not stable.
+
+typedef int (*SortCompareFn)(const void *a, const void *b);
+
+void sort(void *base, size_t count, size_t size, SortCompareFn compare);
+
+// Rearranges the array so that the element at `nth` is the one that would be
+// there if the array were sorted, no element before it compares greater and
+// no element after it compares less (nth_element). O(n) on average. Does
+// nothing if nth >= count.
+void sort_select(void *base, size_t count, size_t size, size_t nth, SortCompareFn compare);
+
+// Sorts the `k` smallest elements into the first `k` positions; the order of
+// the rest is unspecified. O(n + k log k) on average, so finding the top K of
+// many elements is much cheaper than sorting all of them.
+void sort_partial(void *base, size_t count, size_t size, size_t k, SortCompareFn compare);
+
+// Type-specialized sorting, generated for one element type and comparison:
+//
+//     #define U64_LESS(a, b) (*(a) < *(b))
+//     DEFINE_SORT_FOR_TYPE(uint64_t, U64_LESS, U64Sort)
+//
+//     U64Sort_sort(values, count);
+//
+// CMP(a, b) receives two `const TYPE *` and is true if *a must come before
+// *b; it is expanded inline, so there is no call per comparison as with a
+// SortCompareFn. NAME_sort, NAME_select and NAME_partial behave like sort,
+// sort_select and sort_partial above.
+//
+// NAME_sort is a pattern-defeating quicksort (pdqsort): median-of-three (or
+// of nine) pivots, a branchless partition, insertion sort for short ranges,
+// and two defenses against bad inputs. Runs of elements equal to an earlier
+// pivot are partitioned off in one pass, and after an unbalanced partition a
+// few elements are swapped to break up the pattern, falling back to heapsort
+// after log2(n) of them.
+
+// Ranges up to this size are insertion sorted
+#define SORT_INSERTION_THRESHOLD 24
+// Ranges larger than this use the median of nine as pivot
+#define SORT_NINTHER_THRESHOLD 128
+
+static inline uint32_t sort_log2(size_t count) {
+    uint32_t log = 0;
+    for (; count > 1; count >>= 1) log++;
+    return log;
+}
+
+#define DEFINE_SORT_FOR_TYPE(TYPE, CMP, NAME) \
+    static inline void _GV_CONCAT(NAME, _swap)(TYPE *a, TYPE *b) { \
+        TYPE t = *a; \
+        *a = *b; \
+        *b = t; \
+    } \
+    \
+    /* Orders *a, *b, *c */ \
+    static inline void _GV_CONCAT(NAME, _sort3)(TYPE *a, TYPE *b, TYPE *c) { \
+        if (CMP(b, a)) _GV_CONCAT(NAME, _swap)(a, b); \
+        if (CMP(c, b)) { \
+            _GV_CONCAT(NAME, _swap)(b, c); \
+            if (CMP(b, a)) _GV_CONCAT(NAME, _swap)(a, b); \
+        } \
+    } \
+    \
+    static inline void _GV_CONCAT(NAME, _insertion_sort)(TYPE *data, size_t count) { \
+        for (size_t i = 1; i < count; i++) { \
+            if (!CMP(&data[i], &data[i - 1])) continue; \
+            TYPE x = data[i]; \
+            size_t j = i; \
+            do { \
+                data[j] = data[j - 1]; \
+                j--; \
+            } while (j > 0 && CMP(&x, &data[j - 1])); \
+            data[j] = x; \
+        } \
+    } \
+    \
+    static inline void _GV_CONCAT(NAME, _sift_down)(TYPE *data, size_t root, size_t count) { \
+        for (;;) { \
+            size_t child = 2 * root + 1; \
+            if (child >= count) return; \
+            if (child + 1 < count && CMP(&data[child], &data[child + 1])) child++; \
+            if (!CMP(&data[root], &data[child])) return; \
+            _GV_CONCAT(NAME, _swap)(&data[root], &data[child]); \
+            root = child; \
+        } \
+    } \
+    \
+    static inline void _GV_CONCAT(NAME, _heap_sort)(TYPE *data, size_t count) { \
+        for (size_t i = count / 2; i > 0; i--) { \
+            _GV_CONCAT(NAME, _sift_down)(data, i - 1, count); \
+        } \
+        for (size_t end = count - 1; end > 0; end--) { \
+            _GV_CONCAT(NAME, _swap)(&data[0], &data[end]); \
+            _GV_CONCAT(NAME, _sift_down)(data, 0, end); \
+        } \
+    } \
+    \
+    /* Moves the median of three (of nine for large ranges) to data[0] */ \
+    static inline void _GV_CONCAT(NAME, _choose_pivot)(TYPE *data, size_t count) { \
+        size_t half = count / 2; \
+        if (count > SORT_NINTHER_THRESHOLD) { \
+            _GV_CONCAT(NAME, _sort3)(&data[0], &data[half], &data[count - 1]); \
+            _GV_CONCAT(NAME, _sort3)(&data[1], &data[half - 1], &data[count - 2]); \
+            _GV_CONCAT(NAME, _sort3)(&data[2], &data[half + 1], &data[count - 3]); \
+            _GV_CONCAT(NAME, _sort3)(&data[half - 1], &data[half], &data[half + 1]); \
+            _GV_CONCAT(NAME, _swap)(&data[0], &data[half]); \
+        } else { \
+            _GV_CONCAT(NAME, _sort3)(&data[half], &data[0], &data[count - 1]); \
+        } \
+    } \
+    \
+    /* Partitions around the pivot data[0] and returns its final index. */ \
+    /* Elements before it compare less than it, or not greater if */ \
+    /* `equal_left`. Branchless: every element is stored to both candidate */ \
+    /* places and the boundary advances by the comparison result. */ \
+    static inline size_t _GV_CONCAT(NAME, _partition)(TYPE *data, size_t count, bool equal_left) { \
+        TYPE pivot = data[0]; \
+        size_t store = 1; \
+        for (size_t i = 1; i < count; i++) { \
+            TYPE x = data[i]; \
+            size_t goes_left = equal_left ? !CMP(&pivot, &x) : CMP(&x, &pivot); \
+            data[i] = data[store]; \
+            data[store] = x; \
+            store += goes_left; \
+        } \
+        data[0] = data[store - 1]; \
+        data[store - 1] = pivot; \
+        return store - 1; \
+    } \
+    \
+    /* Breaks up patterns after an unbalanced partition at p */ \
+    static inline void _GV_CONCAT(NAME, _shuffle)(TYPE *data, size_t count, size_t p) { \
+        size_t left = p; \
+        size_t right = count - p - 1; \
+        if (left >= SORT_INSERTION_THRESHOLD) { \
+            _GV_CONCAT(NAME, _swap)(&data[0], &data[left / 4]); \
+            _GV_CONCAT(NAME, _swap)(&data[p - 1], &data[p - left / 4]); \
+        } \
+        if (right >= SORT_INSERTION_THRESHOLD) { \
+            _GV_CONCAT(NAME, _swap)(&data[p + 1], &data[p + 1 + right / 4]); \
+            _GV_CONCAT(NAME, _swap)(&data[count - 1], &data[count - right / 4]); \
+        } \
+    } \
+    \
+    /* `leftmost`: no enclosing pivot precedes data. Otherwise data[-1] is */ \
+    /* not greater than any element of data, and if it is not less than the */ \
+    /* new pivot either, every element equal to it is already in place. */ \
+    static inline void _GV_CONCAT(NAME, _pdqsort)(TYPE *data, size_t count, uint32_t bad_allowed, bool leftmost) { \
+        for (;;) { \
+            if (count <= SORT_INSERTION_THRESHOLD) { \
+                _GV_CONCAT(NAME, _insertion_sort)(data, count); \
+                return; \
+            } \
+            _GV_CONCAT(NAME, _choose_pivot)(data, count); \
+            if (!leftmost && !CMP(&data[-1], &data[0])) { \
+                size_t p = _GV_CONCAT(NAME, _partition)(data, count, true); \
+                data += p + 1; \
+                count -= p + 1; \
+                continue; \
+            } \
+            size_t p = _GV_CONCAT(NAME, _partition)(data, count, false); \
+            if (p < count / 8 || count - p - 1 < count / 8) { \
+                if (--bad_allowed == 0) { \
+                    _GV_CONCAT(NAME, _heap_sort)(data, count); \
+                    return; \
+                } \
+                _GV_CONCAT(NAME, _shuffle)(data, count, p); \
+            } \
+            _GV_CONCAT(NAME, _pdqsort)(data, p, bad_allowed, leftmost); \
+            data += p + 1; \
+            count -= p + 1; \
+            leftmost = false; \
+        } \
+    } \
+    \
+    static inline void _GV_CONCAT(NAME, _sort)(TYPE *data, size_t count) { \
+        if (count < 2) return; \
+        _GV_CONCAT(NAME, _pdqsort)(data, count, sort_log2(count), true); \
+    } \
+    \
+    static inline void _GV_CONCAT(NAME, _select)(TYPE *data, size_t count, size_t nth) { \
+        if (nth >= count) return; \
+        uint32_t bad_allowed = sort_log2(count); \
+        bool leftmost = true; \
+        while (count > SORT_INSERTION_THRESHOLD) { \
+            _GV_CONCAT(NAME, _choose_pivot)(data, count); \
+            if (!leftmost && !CMP(&data[-1], &data[0])) { \
+                size_t p = _GV_CONCAT(NAME, _partition)(data, count, true); \
+                if (nth <= p) return; \
+                data += p + 1; \
+                nth -= p + 1; \
+                count -= p + 1; \
+                continue; \
+            } \
+            size_t p = _GV_CONCAT(NAME, _partition)(data, count, false); \
+            if (p == nth) return; \
+            if (p < count / 8 || count - p - 1 < count / 8) { \
+                if (--bad_allowed == 0) { \
+                    _GV_CONCAT(NAME, _heap_sort)(data, count); \
+                    return; \
+                } \
+                _GV_CONCAT(NAME, _shuffle)(data, count, p); \
+            } \
+            if (nth < p) { \
+                count = p; \
+            } else { \
+                data += p + 1; \
+                nth -= p + 1; \
+                count -= p + 1; \
+                leftmost = false; \
+            } \
+        } \
+        _GV_CONCAT(NAME, _insertion_sort)(data, count); \
+    } \
+    \
+    static inline void _GV_CONCAT(NAME, _partial)(TYPE *data, size_t count, size_t k) { \
+        if (k >= count) { \
+            _GV_CONCAT(NAME, _sort)(data, count); \
+            return; \
+        } \
+        if (k == 0) return; \
+        _GV_CONCAT(NAME, _select)(data, count, k); \
+        _GV_CONCAT(NAME, _sort)(data, k); \
+    }
@@ -0,0 +1,94 @@
+#include <base/sync.h>
+#include <platform/platform.h>
+
+// Spin this many times before sleeping in the kernel; most critical sections
+// are short enough that the lock is released in the meantime.
+#define MUTEX_SPIN_COUNT 100
+
+void mutex_lock(Mutex *m) {
+    uint32_t c = 0;
+    if (atomic_compare_exchange_u32(&m->state, &c, 1)) return;
+
+    for (int i = 0; i < MUTEX_SPIN_COUNT; i++) {
+        cpu_relax();
+        c = 0;
+        if (atomic_compare_exchange_u32(&m->state, &c, 1)) return;
+    }
+
+    // Mark the mutex as contended, then sleep until we are the one that
+    // flips it from unlocked. We keep it marked as contended because other
+    // threads may still be waiting.
+    if (c != 2) c = atomic_exchange_u32(&m->state, 2);
+    while (c != 0) {
+        platform_futex_wait(&m->state.value, 2);
+        c = atomic_exchange_u32(&m->state, 2);
+    }
+}
+
+bool mutex_try_lock(Mutex *m) {
+    uint32_t c = 0;
+    return atomic_compare_exchange_u32(&m->state, &c, 1);
+}
+
+void mutex_unlock(Mutex *m) {
+    if (atomic_fetch_sub_u32(&m->state, 1) != 1) {
+        // There were waiters
+        atomic_store_u32(&m->state, 0, ATOMIC_RELEASE);
+        platform_futex_wake_one(&m->state.value);
+    }
+}
+
+void condvar_wait(CondVar *cv, Mutex *m) {
+    // Reading the sequence before unlocking means a signal sent after the
+    // unlock changes it, so the futex wait below cannot miss it.
+    uint32_t seq = atomic_load_u32(&cv->seq, ATOMIC_ACQUIRE);
+    mutex_unlock(m);
+    platform_futex_wait(&cv->seq.value, seq);
+    mutex_lock(m);
+}
+
+void condvar_signal(CondVar *cv) {
+    atomic_fetch_add_u32(&cv->seq, 1);
+    platform_futex_wake_one(&cv->seq.value);
+}
+
+void condvar_broadcast(CondVar *cv) {
+    atomic_fetch_add_u32(&cv->seq, 1);
+    platform_futex_wake_all(&cv->seq.value);
+}
+
+void semaphore_init(Semaphore *s, uint32_t count) {
+    atomic_store_u32(&s->count, count, ATOMIC_RELAXED);
+    atomic_store_u32(&s->waiters, 0, ATOMIC_RELAXED);
+}
+
+bool semaphore_try_wait(Semaphore *s) {
+    uint32_t c = atomic_load_u32(&s->count, ATOMIC_RELAXED);
+    while (c > 0) {
+        if (atomic_compare_exchange_u32(&s->count, &c, c - 1)) return true;
+    }
+    return false;
+}
+
+void semaphore_wait(Semaphore *s) {
+    while (!semaphore_try_wait(s)) {
+        // Registering as a waiter before the futex re-checks the count pairs
+        // with semaphore_post bumping the count before reading `waiters`, so
+        // either the post sees us or we see the post.
+        atomic_fetch_add_u32(&s->waiters, 1);
+        platform_futex_wait(&s->count.value, 0);
+        atomic_fetch_sub_u32(&s->waiters, 1);
+    }
+}
+
+void semaphore_post(Semaphore *s, uint32_t n) {
+    if (n == 0) return;
+    atomic_fetch_add_u32(&s->count, n);
+    if (atomic_load_u32(&s->waiters, ATOMIC_SEQ_CST) > 0) {
+        if (n == 1) {
+            platform_futex_wake_one(&s->count.value);
+        } else {
+            platform_futex_wake_all(&s->count.value);
+        }
+    }
+}
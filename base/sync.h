@@ -0,0 +1,46 @@
+#pragma once
+
+#include <base_types.h>
+#include <atomics.h>
+
+// Blocking synchronization primitives built on the platform futex
+// (platform_futex_wait/platform_futex_wake_*). All of them are plain structs
+// that are ready to use when zero-initialized, e.g. `Mutex m = {0};`, and
+// need no cleanup.
+
+// A non-recursive mutex (Drepper's three-state futex mutex: 0 = unlocked,
+// 1 = locked, 2 = locked with possible waiters). Unlocking only enters the
+// kernel when another thread is waiting.
+typedef struct {
+    atomic_u32 state;
+} Mutex;
+
+void mutex_lock(Mutex *m);
+// Returns true if the mutex was acquired without blocking.
+bool mutex_try_lock(Mutex *m);
+void mutex_unlock(Mutex *m);
+
+// A condition variable. Wakeups may be spurious: always wait in a loop that
+// re-checks the condition.
+typedef struct {
+    atomic_u32 seq;  // Bumped on every signal/broadcast
+} CondVar;
+
+// Atomically releases `m` and waits for a signal, then re-acquires `m`.
+void condvar_wait(CondVar *cv, Mutex *m);
+void condvar_signal(CondVar *cv);
+void condvar_broadcast(CondVar *cv);
+
+// A counting semaphore.
+typedef struct {
+    atomic_u32 count;
+    atomic_u32 waiters;  // Threads blocked (or about to block) in semaphore_wait
+} Semaphore;
+
+void semaphore_init(Semaphore *s, uint32_t count);
+// Decrements the count, blocking while it is zero.
+void semaphore_wait(Semaphore *s);
+// Decrements the count if it is nonzero. Returns true on success.
+bool semaphore_try_wait(Semaphore *s);
+// Increments the count by n, waking up to n waiters.
+void semaphore_post(Semaphore *s, uint32_t n);
@@ -4,13 +4,7 @@
 #include <base/assert.h>
 #include <base/arena.h>
 #include <base/mem.h>
-
-// --- Helper Macros (internal use) ---
-#define _GV_CONCAT_IMPL(a, b) a##b
-#define _GV_CONCAT(a, b) _GV_CONCAT_IMPL(a, b)
-
-#define _GV_CONCAT3_IMPL(a, b, c) a##b##c
-#define _GV_CONCAT3(a, b, c) _GV_CONCAT3_IMPL(a, b, c)
+#include <base/generic.h>
 
 // --- Conditional Compilation Helper for WITH_BASE_ASSERT ---
 #if defined(WITH_BASE_ASSERT)
@@ -0,0 +1,509 @@
+#include <base/io.h>
+#include <base/arena.h>
+#include <base/scratch.h>
+#include <base/buddy.h>
+#include <base/base_string.h>
+#include <base/hashtable.h>
+#include <base/vector.h>
+#include <platform/platform.h>
+#include <base/mem.h>
+#include <base/numconv.h>
+#include <base/format.h>
+#include <base/base_io.h>
+#include <base/sort.h>
+
+// Microbenchmarks for base/.
+//
+// Every benchmark runs a fixed number of operations per sample, so native and
+// wasmtime runs do the same work and their numbers can be compared directly.
+// Each benchmark is warmed up, then timed for a number of samples; the output
+// is CSV on stdout (lines starting with '#' are comments):
+//
+//     name,bytes_per_op,ops_per_sample,samples,median_ns,p99_ns,min_ns,mb_per_s
+//
+// The *_ns columns are nanoseconds per operation. mb_per_s is derived from the
+// median and is 0 for benchmarks that do not process bytes.
+//
+// Usage: bench_base [--samples N] [--warmup N] [--filter SUBSTRING]
+
+#define DEFAULT_SAMPLES 101
+#define DEFAULT_WARMUP 10
+
+// Size of the file read by the read_file benchmark
+#define READ_FILE_SIZE (4 * 1024 * 1024)
+#define READ_FILE_NAME "bench_base_read.bin"
+
+#define HASH_KEY_COUNT 4096
+
+// Elements sorted per sample by the sort benchmarks
+#define SORT_COUNT (64 * 1024)
+
+#define U64Table_HASH(key) (size_t)((key) * 0x9E3779B97F4A7C15ull >> 32)
+#define U64Table_EQUAL(a, b) ((a) == (b))
+DEFINE_HASHTABLE_FOR_TYPES(uint64_t, uint64_t, U64Table)
+
+#define U64Sort_BEFORE(a, b) (*(a) < *(b))
+DEFINE_SORT_FOR_TYPE(uint64_t, U64Sort_BEFORE, U64Sort)
+
+typedef struct {
+    Arena *arena;          // Reset after every sample
+    arena_pos_t arena_start;
+    char *src;             // 1 MiB of pseudo-random bytes
+    char *dst;             // 1 MiB
+    uint64_t *keys;        // HASH_KEY_COUNT distinct keys
+    U64Table table;        // Holds all keys, for lookups
+    uint64_t rng;
+} BenchState;
+
+typedef void (*BenchFn)(BenchState *s, uint32_t ops);
+
+typedef struct {
+    const char *name;
+    BenchFn fn;
+    uint32_t ops;           // Operations per sample
+    uint64_t bytes_per_op;  // 0 if the benchmark does not process bytes
+} Benchmark;
+
+// Results are accumulated here so that the compiler cannot drop the work
+static volatile uint64_t g_sink;
+
+static uint64_t rng_next(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+// --- buddy ---
+
+static void bench_buddy_64(BenchState *s, uint32_t ops) {
+    (void)s;
+    for (uint32_t i = 0; i < ops; i++) {
+        void *p = buddy_alloc(64, NULL);
+        g_sink += (uintptr_t)p;
+        buddy_free(p);
+    }
+}
+
+static void bench_buddy_4k(BenchState *s, uint32_t ops) {
+    (void)s;
+    for (uint32_t i = 0; i < ops; i++) {
+        void *p = buddy_alloc(4096, NULL);
+        g_sink += (uintptr_t)p;
+        buddy_free(p);
+    }
+}
+
+// Allocates 64 blocks of mixed sizes, then frees them in a shuffled order
+static void bench_buddy_mixed(BenchState *s, uint32_t ops) {
+    void *blocks[64];
+    uint64_t rng = 0x2545F4914F6CDD1Dull;
+    for (uint32_t done = 0; done < ops; done += 64) {
+        for (uint32_t i = 0; i < 64; i++) {
+            blocks[i] = buddy_alloc(16u << (rng_next(&rng) % 9), NULL);
+        }
+        for (uint32_t i = 63; i > 0; i--) {
+            uint32_t j = (uint32_t)(rng_next(&rng) % (i + 1));
+            void *tmp = blocks[i];
+            blocks[i] = blocks[j];
+            blocks[j] = tmp;
+        }
+        for (uint32_t i = 0; i < 64; i++) {
+            buddy_free(blocks[i]);
+        }
+    }
+    (void)s;
+}
+
+// --- arena ---
+
+static void bench_arena_alloc(BenchState *s, uint32_t ops, size_t size) {
+    for (uint32_t i = 0; i < ops; i++) {
+        char *p = arena_alloc(s->arena, size);
+        p[0] = 1;
+        g_sink += (uintptr_t)p;
+    }
+}
+
+static void bench_arena_16(BenchState *s, uint32_t ops) {
+    bench_arena_alloc(s, ops, 16);
+}
+
+static void bench_arena_256(BenchState *s, uint32_t ops) {
+    bench_arena_alloc(s, ops, 256);
+}
+
+static void bench_arena_4k(BenchState *s, uint32_t ops) {
+    bench_arena_alloc(s, ops, 4096);
+}
+
+// --- str_hash ---
+
+static void bench_str_hash(BenchState *s, uint32_t ops, size_t size) {
+    uint64_t h = 0;
+    for (uint32_t i = 0; i < ops; i++) {
+        string str = {s->src + (i & 255), size};
+        h += str_hash(str);
+    }
+    g_sink += h;
+}
+
+static void bench_str_hash_16(BenchState *s, uint32_t ops) {
+    bench_str_hash(s, ops, 16);
+}
+
+static void bench_str_hash_1k(BenchState *s, uint32_t ops) {
+    bench_str_hash(s, ops, 1024);
+}
+
+// --- hashtable ---
+
+// Inserts all keys into a table that starts small and grows
+static void bench_hashtable_insert(BenchState *s, uint32_t ops) {
+    U64Table table;
+    U64Table_init(s->arena, &table, 16);
+    for (uint32_t i = 0; i < ops; i++) {
+        U64Table_insert(s->arena, &table, s->keys[i % HASH_KEY_COUNT], i);
+    }
+    g_sink += table.size;
+}
+
+static void bench_hashtable_get(BenchState *s, uint32_t ops) {
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < ops; i++) {
+        uint64_t *value = U64Table_get(&s->table, s->keys[(i * 7) % HASH_KEY_COUNT]);
+        sum += *value;
+    }
+    g_sink += sum;
+}
+
+static void bench_hashtable_get_miss(BenchState *s, uint32_t ops) {
+    uint64_t found = 0;
+    for (uint32_t i = 0; i < ops; i++) {
+        // Keys are odd, see bench_setup
+        found += U64Table_get(&s->table, s->keys[i % HASH_KEY_COUNT] + 1) != NULL;
+    }
+    g_sink += found;
+}
+
+// --- vector ---
+
+static void bench_vector_push_back(BenchState *s, uint32_t ops) {
+    vector_i64 v;
+    vector_i64_reserve(s->arena, &v, 16);
+    for (uint32_t i = 0; i < ops; i++) {
+        vector_i64_push_back(s->arena, &v, i);
+    }
+    g_sink += v.size;
+}
+
+// --- sort ---
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Sorts `ops` random values, with a comparison callback
+static void bench_sort_callback(BenchState *s, uint32_t ops) {
+    uint64_t *values = (uint64_t *)s->dst;
+    base_memcpy(values, s->src, ops * sizeof(uint64_t));
+    sort(values, ops, sizeof(uint64_t), compare_u64);
+    g_sink += values[0];
+}
+
+// Sorts `ops` random values, with the comparison inlined
+static void bench_sort_typed(BenchState *s, uint32_t ops) {
+    uint64_t *values = (uint64_t *)s->dst;
+    base_memcpy(values, s->src, ops * sizeof(uint64_t));
+    U64Sort_sort(values, ops);
+    g_sink += values[0];
+}
+
+// Moves the 100 smallest of `ops` random values to the front, sorted
+static void bench_sort_partial(BenchState *s, uint32_t ops) {
+    uint64_t *values = (uint64_t *)s->dst;
+    base_memcpy(values, s->src, ops * sizeof(uint64_t));
+    U64Sort_partial(values, ops, 100);
+    g_sink += values[0];
+}
+
+// --- memcpy / memset ---
+
+static void bench_memcpy(BenchState *s, uint32_t ops, size_t size) {
+    for (uint32_t i = 0; i < ops; i++) {
+        base_memcpy(s->dst, s->src, size);
+    }
+    g_sink += (uint8_t)s->dst[size - 1];
+}
+
+static void bench_memcpy_64(BenchState *s, uint32_t ops) {
+    bench_memcpy(s, ops, 64);
+}
+
+static void bench_memcpy_4k(BenchState *s, uint32_t ops) {
+    bench_memcpy(s, ops, 4096);
+}
+
+static void bench_memcpy_1m(BenchState *s, uint32_t ops) {
+    bench_memcpy(s, ops, 1024 * 1024);
+}
+
+static void bench_memset(BenchState *s, uint32_t ops, size_t size) {
+    for (uint32_t i = 0; i < ops; i++) {
+        base_memset(s->dst, (int)i, size);
+    }
+    g_sink += (uint8_t)s->dst[size - 1];
+}
+
+static void bench_memset_64(BenchState *s, uint32_t ops) {
+    bench_memset(s, ops, 64);
+}
+
+static void bench_memset_4k(BenchState *s, uint32_t ops) {
+    bench_memset(s, ops, 4096);
+}
+
+static void bench_memset_1m(BenchState *s, uint32_t ops) {
+    bench_memset(s, ops, 1024 * 1024);
+}
+
+// --- format / numconv ---
+
+static void bench_format(BenchState *s, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        string str = format(s->arena, str_lit("{}: {} = {:.3}"),
+                str_lit("value"), (int64_t)i, (double)i * 0.25);
+        g_sink += str.size;
+    }
+}
+
+static void bench_uint64_to_str(BenchState *s, uint32_t ops) {
+    char buf[32];
+    uint64_t value = 1;
+    size_t total = 0;
+    for (uint32_t i = 0; i < ops; i++) {
+        total += uint64_to_str(value, buf);
+        value = value * 31 + i;
+    }
+    g_sink += total;
+    (void)s;
+}
+
+static void bench_double_to_str(BenchState *s, uint32_t ops) {
+    char buf[64];
+    double value = 0.001;
+    size_t total = 0;
+    for (uint32_t i = 0; i < ops; i++) {
+        total += double_to_str(value, buf, 6);
+        value = value * 1.37 + 0.5;
+        if (value > 1e9) value = 0.001;
+    }
+    g_sink += total;
+    (void)s;
+}
+
+// --- read_file ---
+
+static void bench_read_file(BenchState *s, uint32_t ops) {
+    for (uint32_t i = 0; i < ops; i++) {
+        string text;
+        if (!read_file(s->arena, str_lit(READ_FILE_NAME), &text)) {
+            println(str_lit("Error: Failed to read {}"), str_lit(READ_FILE_NAME));
+            wasi_proc_exit(1);
+        }
+        g_sink += (uint8_t)text.str[text.size / 2];
+    }
+}
+
+static const Benchmark g_benchmarks[] = {
+    {"buddy_alloc_free_64", bench_buddy_64, 1024, 0},
+    {"buddy_alloc_free_4k", bench_buddy_4k, 1024, 0},
+    {"buddy_alloc_free_mixed", bench_buddy_mixed, 1024, 0},
+    {"arena_alloc_16", bench_arena_16, 4096, 0},
+    {"arena_alloc_256", bench_arena_256, 4096, 0},
+    {"arena_alloc_4k", bench_arena_4k, 1024, 0},
+    {"str_hash_16", bench_str_hash_16, 4096, 16},
+    {"str_hash_1k", bench_str_hash_1k, 256, 1024},
+    {"hashtable_insert", bench_hashtable_insert, HASH_KEY_COUNT, 0},
+    {"hashtable_get_hit", bench_hashtable_get, 4096, 0},
+    {"hashtable_get_miss", bench_hashtable_get_miss, 4096, 0},
+    {"vector_push_back", bench_vector_push_back, 4096, 0},
+    {"sort_callback_64k", bench_sort_callback, SORT_COUNT, 8},
+    {"sort_typed_64k", bench_sort_typed, SORT_COUNT, 8},
+    {"sort_partial_100_of_64k", bench_sort_partial, SORT_COUNT, 8},
+    {"memcpy_64", bench_memcpy_64, 4096, 64},
+    {"memcpy_4k", bench_memcpy_4k, 256, 4096},
+    {"memcpy_1m", bench_memcpy_1m, 4, 1024 * 1024},
+    {"memset_64", bench_memset_64, 4096, 64},
+    {"memset_4k", bench_memset_4k, 256, 4096},
+    {"memset_1m", bench_memset_1m, 4, 1024 * 1024},
+    {"format", bench_format, 256, 0},
+    {"uint64_to_str", bench_uint64_to_str, 4096, 0},
+    {"double_to_str", bench_double_to_str, 1024, 0},
+    {"read_file_4m", bench_read_file, 1, READ_FILE_SIZE},
+};
+
+static void bench_setup(BenchState *s, Arena *arena) {
+    s->rng = 0x9E3779B97F4A7C15ull;
+    s->src = arena_alloc(arena, 1024 * 1024);
+    s->dst = arena_alloc(arena, 1024 * 1024);
+    for (size_t i = 0; i < 1024 * 1024; i += 8) {
+        uint64_t r = rng_next(&s->rng);
+        base_memcpy(s->src + i, &r, 8);
+    }
+
+    // Odd keys, so that key + 1 is never in the table
+    s->keys = arena_alloc_array(arena, uint64_t, HASH_KEY_COUNT);
+    U64Table_init(arena, &s->table, 16);
+    for (uint32_t i = 0; i < HASH_KEY_COUNT; i++) {
+        uint64_t key;
+        do {
+            key = rng_next(&s->rng) | 1;
+        } while (U64Table_get(&s->table, key));
+        s->keys[i] = key;
+        U64Table_insert(arena, &s->table, key, i);
+    }
+
+    s->arena = arena_new(1024 * 1024);
+    s->arena_start = arena_get_pos(s->arena);
+}
+
+static bool write_read_file(BenchState *s) {
+    wasi_fd_t fd = wasi_path_open(READ_FILE_NAME, sizeof(READ_FILE_NAME) - 1,
+            WASI_RIGHTS_WRITE, WASI_O_CREAT | WASI_O_TRUNC);
+    if (fd < 0) return false;
+    bool ok = true;
+    for (size_t written = 0; ok && written < READ_FILE_SIZE; written += 1024 * 1024) {
+        ciovec_t iov = {.buf = s->src, .buf_len = 1024 * 1024};
+        ok = write_all(fd, &iov, 1) == 0;
+    }
+    wasi_fd_close(fd);
+    return ok;
+}
+
+static void run_benchmark(BenchState *s, const Benchmark *b, uint64_t *samples,
+        uint32_t sample_count, uint32_t warmup) {
+    for (uint32_t i = 0; i < warmup; i++) {
+        b->fn(s, b->ops);
+        arena_reset(s->arena, s->arena_start);
+    }
+    for (uint32_t i = 0; i < sample_count; i++) {
+        uint64_t start = platform_now_ns();
+        b->fn(s, b->ops);
+        samples[i] = platform_now_ns() - start;
+        arena_reset(s->arena, s->arena_start);
+    }
+    U64Sort_sort(samples, sample_count);
+
+    // Nearest-rank percentiles
+    uint64_t median = samples[sample_count / 2];
+    uint64_t p99 = samples[(sample_count * 99 + 99) / 100 - 1];
+    double ops = (double)b->ops;
+    double mb_per_s = 0.0;
+    if (b->bytes_per_op > 0 && median > 0) {
+        mb_per_s = (double)b->bytes_per_op * ops * 1000.0 / (double)median;
+    }
+    println(str_lit("{},{},{},{},{:.2},{:.2},{:.2},{:.1}"),
+            str_from_cstr_view((char *)b->name), b->bytes_per_op, (uint64_t)b->ops,
+            (uint64_t)sample_count, (double)median / ops, (double)p99 / ops,
+            (double)samples[0] / ops, mb_per_s);
+}
+
+static const char *platform_name(void) {
+#if defined(__wasm__)
+    return "wasm";
+#elif defined(_WIN32)
+    return "windows";
+#elif defined(__APPLE__)
+    return "macos";
+#else
+    return "linux";
+#endif
+}
+
+static bool parse_u32(const char *s, uint32_t *result) {
+    uint64_t value = 0;
+    if (*s == '\0') return false;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9') return false;
+        value = value * 10 + (uint64_t)(*s - '0');
+        if (value > 0xFFFFFFFFu) return false;
+    }
+    *result = (uint32_t)value;
+    return true;
+}
+
+static void print_usage(void) {
+    println(str_lit("Usage: bench_base [--samples N] [--warmup N] [--filter SUBSTRING]"));
+}
+
+int app_main(void) {
+    Scratch scratch = scratch_begin();
+
+    size_t argc;
+    size_t argv_buf_size;
+    if (wasi_args_sizes_get(&argc, &argv_buf_size) != 0) {
+        println(str_lit("Error: Failed to get argument sizes"));
+        scratch_end(scratch);
+        return 1;
+    }
+    char **argv = (char **)arena_alloc(scratch.arena, (argc + 1) * sizeof(char*));
+    char *argv_buf = (char *)arena_alloc(scratch.arena, argv_buf_size + 1);
+    if (wasi_args_get(argv, argv_buf) != 0) {
+        println(str_lit("Error: Failed to get arguments"));
+        scratch_end(scratch);
+        return 1;
+    }
+
+    uint32_t sample_count = DEFAULT_SAMPLES;
+    uint32_t warmup = DEFAULT_WARMUP;
+    const char *filter = NULL;
+    for (size_t i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (base_strcmp(argv[i], "--samples") == 0 && has_value) {
+            if (!parse_u32(argv[++i], &sample_count) || sample_count == 0) {
+                println(str_lit("Error: Invalid sample count"));
+                scratch_end(scratch);
+                return 1;
+            }
+        } else if (base_strcmp(argv[i], "--warmup") == 0 && has_value) {
+            if (!parse_u32(argv[++i], &warmup)) {
+                println(str_lit("Error: Invalid warmup count"));
+                scratch_end(scratch);
+                return 1;
+            }
+        } else if (base_strcmp(argv[i], "--filter") == 0 && has_value) {
+            filter = argv[++i];
+        } else {
+            print_usage();
+            scratch_end(scratch);
+            return 1;
+        }
+    }
+
+    BenchState state;
+    bench_setup(&state, scratch.arena);
+    if (!write_read_file(&state)) {
+        println(str_lit("Error: Failed to write {}"), str_lit(READ_FILE_NAME));
+        scratch_end(scratch);
+        return 1;
+    }
+    uint64_t *samples = arena_alloc_array(scratch.arena, uint64_t, sample_count);
+
+    println(str_lit("# bench_base platform={} samples={} warmup={}"),
+            str_from_cstr_view((char *)platform_name()), sample_count, warmup);
+    println(str_lit("name,bytes_per_op,ops_per_sample,samples,median_ns,p99_ns,min_ns,mb_per_s"));
+    for (size_t i = 0; i < sizeof(g_benchmarks) / sizeof(g_benchmarks[0]); i++) {
+        const Benchmark *b = &g_benchmarks[i];
+        if (filter && !base_strstr(b->name, filter)) continue;
+        run_benchmark(&state, b, samples, sample_count, warmup);
+    }
+
+    arena_free(state.arena);
+    scratch_end(scratch);
+    return 0;
+}
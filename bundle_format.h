@@ -0,0 +1,99 @@
+/*
+ * Asset Bundle Format (JSFS version 3)
+ *
+ * A read-only archive of files written by bundler.c and read by
+ * sdl/wasm/SDL_wasm_bundle.js. The header holds an open-addressing hash
+ * index of the paths, so a file is found straight from the mapped bytes
+ * without parsing the bundle first. Each file is stored as is or compressed
+ * on its own, so a reader only decodes the files it uses. Files with the
+ * same content share it, and contents start at a multiple of the bundle's
+ * alignment, so a mapped file can be handed to SIMD code or a GPU upload
+ * without a realigning copy.
+ *
+ * All integers are little-endian, and all offsets are absolute byte offsets
+ * from the start of the bundle.
+ */
+
+#ifndef BUNDLE_FORMAT_H
+#define BUNDLE_FORMAT_H
+
+#include <stdint.h>
+
+#define BUNDLE_MAGIC "JSFS"
+#define BUNDLE_VERSION 3
+
+// How a file's content is stored
+#define BUNDLE_CODEC_NONE 0    // As is
+#define BUNDLE_CODEC_LZ 1      // An LZ frame (base/lz.h) of the file
+
+// Bundle header
+typedef struct {
+    char magic[4];             // BUNDLE_MAGIC, not NUL-terminated
+    uint8_t version;           // BUNDLE_VERSION (version 2 has no codecs, 1 no index)
+    uint8_t align_shift;       // Non-empty contents start at multiples of 1 << align_shift
+    uint8_t reserved[2];
+    uint32_t file_count;       // Number of BundleEntry
+    uint32_t slot_count;       // Index slots, a power of two >= 2 * file_count
+    uint32_t index_offset;     // uint32_t slots[slot_count]
+    uint32_t entries_offset;   // BundleEntry entries[file_count], in manifest order
+    uint32_t strings_offset;   // Paths, each followed by a NUL
+    uint32_t strings_size;
+    uint64_t total_size;       // Size of the whole bundle
+} BundleHeader;
+
+// One bundled file
+typedef struct {
+    uint32_t path_hash;        // bundle_path_hash(path)
+    uint32_t path_offset;      // Path (UTF-8, '/' separated, relative)
+    uint32_t path_size;        // Without the NUL
+    uint32_t codec;            // BUNDLE_CODEC_*, 0 in version 2
+    uint64_t offset;           // Stored content
+    uint64_t size;             // Stored size, the file size for BUNDLE_CODEC_NONE
+} BundleEntry;
+
+// Bundle layout:
+// [BundleHeader]
+// [uint32_t slots]        ← index_offset: entry index + 1, 0 for an empty slot
+// [BundleEntry array]     ← entries_offset
+// [Path strings]          ← strings_offset
+// [Contents]              ← in entry order, zero-padded to the alignment
+//
+// Entries whose files have the same content have the same offset, size and
+// codec. Empty files are not aligned: their offset can be anywhere up to
+// total_size.
+//
+// A path is stored in the first free slot at or after
+// bundle_path_hash(path) & (slot_count - 1), wrapping around. At least half
+// of the slots are empty, so most lookups take a single probe and every
+// miss ends at an empty slot.
+
+// FNV-1a, the same as str_hash in base/base_string.h
+static inline uint32_t bundle_path_hash(const char *path, uint32_t size) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < size; i++) {
+        hash ^= (uint8_t)path[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Finds `path` in the bundle at `data`, whose header, index, entries and
+// strings must be in bounds. Returns NULL if the path is not bundled.
+static inline const BundleEntry *bundle_find_entry(const uint8_t *data, const char *path, uint32_t path_size) {
+    const BundleHeader *header = (const BundleHeader *)data;
+    const uint32_t *slots = (const uint32_t *)(data + header->index_offset);
+    const BundleEntry *entries = (const BundleEntry *)(data + header->entries_offset);
+    uint32_t hash = bundle_path_hash(path, path_size);
+    uint32_t mask = header->slot_count - 1;
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+        if (slots[i] == 0) return 0;
+        const BundleEntry *entry = &entries[slots[i] - 1];
+        if (entry->path_hash != hash || entry->path_size != path_size) continue;
+        const char *entry_path = (const char *)data + entry->path_offset;
+        uint32_t j = 0;
+        while (j < path_size && entry_path[j] == path[j]) j++;
+        if (j == path_size) return entry;
+    }
+}
+
+#endif // BUNDLE_FORMAT_H
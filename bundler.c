@@ -1,82 +1,131 @@
 #define _CRT_SECURE_NO_WARNINGS
 #define _CRT_NONSTDC_NO_WARNINGS
+#define _GNU_SOURCE             // copy_file_range
+#define _FILE_OFFSET_BITS 64
 
 /*
  * Simple Bundler in C
  * 
- * Usage: ./bundler <manifest.txt> <bundle.bin>
+ * Usage: ./bundler [--compress] [--align <bytes>] <manifest.txt> <bundle.bin>
  * 
  * Manifest format: One relative file path per line (UTF-8, trimmed whitespace).
  * Paths are relative to the current working directory.
  * 
- * Bundle Format (binary, read-only):
- * - Header (9 bytes):
- *   - Magic bytes: 'JSFS' (4 bytes, ASCII).
- *   - Version: 1 (1 byte, unsigned).
- *   - Number of files: uint32 big-endian (4 bytes).
- * - Metadata (variable length, one entry per file):
- *   - Path length: uint16 big-endian (2 bytes, max 65535).
- *   - Path: UTF-8 encoded string (path length bytes, relative path using '/' separator, no leading/trailing '/').
- *   - File size: uint64 big-endian (8 bytes, bytes in content).
- *   - Content offset: uint64 big-endian (8 bytes, absolute byte offset in bundle where content starts).
- * - Contents (concatenated): Raw binary bytes of each file's content, in the order of metadata entries.
+ * Bundle Format: JSFS version 3, see bundle_format.h. The header holds a
+ * hash index of the paths, so readers look files up without parsing.
+ *
+ * --compress stores each file as an LZ frame (base/lz.h) of independently
+ * compressed 256 KiB blocks, unless that saves less than 1/16 of its size
+ * (JPEG, PNG and other already compressed formats, mostly).
+ *
+ * --align starts the content of every non-empty file at a multiple of
+ * <bytes>, a power of two up to 1 MiB (default 1: back to back), for
+ * example 64 for SIMD loads or 4096 for page-aligned mapped files.
+ *
+ * Files with the same content are stored once: each file is hashed before
+ * it is written, and a file whose size and hash match one written before is
+ * compared with it byte for byte and, if equal, shares its content.
+ *
+ * Incremental rebuilds: the bundler keeps <bundle.bin>.cache next to the
+ * bundle, with the size, mtime, content hash and stored location of every
+ * file. When the options and the list of paths are the same as last time, a
+ * file whose size and mtime are unchanged is trusted to be (like make), and
+ * a file whose mtime alone changed is hashed and compared. The bundle is
+ * then left alone if no file changed, or kept up to the first file that did
+ * and rewritten from there on. Anything else (no cache, other options or
+ * paths, a bundle that changed since) rebuilds it from scratch. The changed
+ * files and the reason for a full rebuild are printed.
  * 
  * Assumptions/Limits:
- * - Up to 2^32 - 1 files.
- * - File paths < 64KB.
+ * - Header, index, entries and paths < 4 GiB together.
  * - File sizes < 2^64 bytes.
  * - No directories in manifest (paths include dirs, e.g., "src/file.txt").
- * - Overwrites bundle if exists.
+ * - A path listed more than once is bundled once.
+ * - Overwrites bundle if exists (or rewrites its tail, see above).
  * - Errors (missing files/manifest) cause exit(1).
- * - Memory: Loads all contents into RAM (suitable for small bundles).
+ * - Memory: Sizes come from stat, then each file is streamed into the bundle,
+ *   so memory use does not depend on the file sizes. A file that changes size
+ *   in between is an error. Each file is read twice, to hash and to copy it
+ *   (the second time usually from the page cache).
+ * - Runs on little-endian hosts only, like the bundle format.
  * 
- * Compilation: gcc -o bundler bundler.c
+ * Compilation: gcc -I . -o bundler bundler.c base/lz.c
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
-#include <sys/stat.h>  // For potential stat, but using fseek/ftell
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <errno.h>
+#endif
+
+#include "bundle_format.h"
+#include "base/lz.h"
 
 #define INITIAL_CAPACITY 16
+#define COPY_BUFFER_SIZE (1024 * 1024)
+#define MAX_ALIGNMENT (1024 * 1024)
 
 typedef uint64_t u64;
 typedef uint32_t u32;
-typedef uint16_t u16;
 
 typedef struct {
     char* path;
     size_t plen;
     u64 size;
-    u64 offset;
-    char* content;
+    u64 mtime;             // Nanoseconds, see file_mtime
+    u64 hash;              // Of the content, see hash_file
+    BundleEntry* bundled;  // NULL for a path listed before
 } Entry;
 
-void write_u16_be(FILE* f, u16 v) {
-    fputc((v >> 8) & 0xFF, f);
-    fputc(v & 0xFF, f);
-}
+#if defined(_WIN32)
+typedef struct _stat64 FileStat;
+#define file_stat _stat64
+#define file_seek _fseeki64
+#define file_truncate(fp, size) _chsize_s(_fileno(fp), (long long)(size))
+#else
+typedef struct stat FileStat;
+#define file_stat stat
+#define file_seek fseeko
+#define file_truncate(fp, size) ftruncate(fileno(fp), (off_t)(size))
+#endif
 
-void write_u32_be(FILE* f, u32 v) {
-    fputc((v >> 24) & 0xFF, f);
-    fputc((v >> 16) & 0xFF, f);
-    fputc((v >> 8) & 0xFF, f);
-    fputc(v & 0xFF, f);
-}
+#if defined(__linux__)
+#define file_mtime(st) ((u64)(st).st_mtim.tv_sec * 1000000000u + (u64)(st).st_mtim.tv_nsec)
+#elif defined(__APPLE__)
+#define file_mtime(st) ((u64)(st).st_mtimespec.tv_sec * 1000000000u + (u64)(st).st_mtimespec.tv_nsec)
+#else
+#define file_mtime(st) ((u64)(st).st_mtime * 1000000000u)
+#endif
 
-void write_u64_be(FILE* f, u64 v) {
-    fputc((v >> 56) & 0xFF, f);
-    fputc((v >> 48) & 0xFF, f);
-    fputc((v >> 40) & 0xFF, f);
-    fputc((v >> 32) & 0xFF, f);
-    fputc((v >> 24) & 0xFF, f);
-    fputc((v >> 16) & 0xFF, f);
-    fputc((v >> 8) & 0xFF, f);
-    fputc(v & 0xFF, f);
-}
+// A file as bundled by the previous run, see read_cache
+typedef struct {
+    char* path;
+    u64 size;
+    u64 mtime;
+    u64 hash;
+    u64 offset;
+    u64 stored_size;
+    u32 codec;
+} CachedFile;
 
-void add_entry(Entry** entries, size_t* capacity, size_t* count, const char* path_str, u64 fsize, char* content) {
+typedef struct {
+    int compress;
+    u64 alignment;
+    u64 bundle_size;
+    u64 bundle_mtime;
+    CachedFile* files;     // One per bundled path, in entry order
+    u32 count;
+} Cache;
+
+void add_entry(Entry** entries, size_t* capacity, size_t* count, const char* path_str, u64 fsize, u64 mtime) {
     if (*count >= *capacity) {
         *capacity = *capacity ? *capacity * 2 : INITIAL_CAPACITY;
         *entries = realloc(*entries, *capacity * sizeof(Entry));
@@ -93,19 +142,285 @@ void add_entry(Entry** entries, size_t* capacity, size_t* count, const char* pat
     }
     e->plen = strlen(path_str);
     e->size = fsize;
-    e->offset = 0;  // To be set later
-    e->content = content;
+    e->mtime = mtime;
+    e->hash = 0;        // Set when the file is written or kept
+    e->bundled = NULL;  // To be set later
     (*count)++;
 }
 
+void free_entries(Entry* entries, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        free(entries[i].path);
+    }
+    free(entries);
+}
+
+void free_cache(Cache* cache) {
+    for (u32 i = 0; i < cache->count; i++) {
+        free(cache->files[i].path);
+    }
+    free(cache->files);
+    memset(cache, 0, sizeof(*cache));
+}
+
+// Reads the cache written by write_cache. Returns 0 if there is none or it is
+// malformed.
+//
+// Format: a line "bundler-cache 1 <compress> <alignment> <bundle size>
+// <bundle mtime> <count>", then one line per bundled file, in entry order:
+// "<size> <mtime> <hash> <offset> <stored size> <codec> <path>".
+int read_cache(const char* path, Cache* cache) {
+    memset(cache, 0, sizeof(*cache));
+    FILE* fp = fopen(path, "r");
+    if (!fp) return 0;
+    char line[4200];
+    unsigned long long alignment, bundle_size, bundle_mtime;
+    unsigned count;
+    int ok = fgets(line, sizeof(line), fp) &&
+             sscanf(line, "bundler-cache 1 %d %llu %llu %llu %u", &cache->compress, &alignment, &bundle_size,
+                    &bundle_mtime, &count) == 5;
+    if (ok) {
+        cache->alignment = alignment;
+        cache->bundle_size = bundle_size;
+        cache->bundle_mtime = bundle_mtime;
+        cache->files = calloc(count ? count : 1, sizeof(CachedFile));
+        ok = cache->files != NULL;
+    }
+    for (u32 i = 0; ok && i < count; i++) {
+        unsigned long long size, mtime, hash, offset, stored_size;
+        unsigned codec;
+        int path_pos = 0;
+        ok = fgets(line, sizeof(line), fp) &&
+             sscanf(line, "%llu %llu %llx %llu %llu %u%n", &size, &mtime, &hash, &offset, &stored_size, &codec,
+                    &path_pos) == 6 &&
+             line[path_pos] == ' ';
+        if (!ok) break;
+        char* file_path = line + path_pos + 1;
+        file_path[strcspn(file_path, "\n")] = '\0';
+        CachedFile* cf = &cache->files[i];
+        *cf = (CachedFile){strdup(file_path), size, mtime, hash, offset, stored_size, codec};
+        cache->count = i + 1;
+        ok = cf->path != NULL;
+    }
+    fclose(fp);
+    if (!ok) free_cache(cache);
+    return ok;
+}
+
+// Writes the cache for the bundle just written. Returns 0 on success.
+int write_cache(const char* path, const char* bundle_path, int compress, u64 alignment, Entry* entries,
+                size_t count, u32 file_count) {
+    FileStat st;
+    if (file_stat(bundle_path, &st) != 0) return 1;
+    FILE* fp = fopen(path, "w");
+    if (!fp) return 1;
+    fprintf(fp, "bundler-cache 1 %d %llu %llu %llu %u\n", compress, (unsigned long long)alignment,
+            (unsigned long long)st.st_size, (unsigned long long)file_mtime(st), file_count);
+    for (size_t i = 0; i < count; i++) {
+        const Entry* e = &entries[i];
+        const BundleEntry* be = e->bundled;
+        if (!be) continue;
+        fprintf(fp, "%llu %llu %016llx %llu %llu %u %s\n", (unsigned long long)e->size,
+                (unsigned long long)e->mtime, (unsigned long long)e->hash, (unsigned long long)be->offset,
+                (unsigned long long)be->size, be->codec, e->path);
+    }
+    return fclose(fp) != 0;
+}
+
+// Returns 1 if `cache` lists the bundled paths of `entries`, in order
+int cache_has_paths(const Cache* cache, const Entry* entries, size_t count, u32 file_count) {
+    if (cache->count != file_count) return 0;
+    u32 j = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (entries[i].bundled && strcmp(entries[i].path, cache->files[j++].path) != 0) return 0;
+    }
+    return 1;
+}
+
+#if defined(__linux__)
+// Copies in the kernel, without a round trip through user space (and as a
+// reflink on filesystems that support it). Returns the number of bytes
+// copied, which is less than `size` if copy_file_range is unavailable for
+// these files or fails.
+u64 copy_file_range_all(int out_fd, int in_fd, u64 size) {
+    u64 copied = 0;
+    while (copied < size) {
+        u64 chunk = size - copied < (1u << 30) ? size - copied : (1u << 30);
+        ssize_t n = copy_file_range(in_fd, NULL, out_fd, NULL, (size_t)chunk, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            break;
+        }
+        copied += (u64)n;
+    }
+    return copied;
+}
+#endif
+
+// FNV-1a over 8-byte words, with a shift to mix the high bits back down.
+// Equal hashes are confirmed with files_equal, so this only has to be fast
+// and rarely collide.
+u64 hash_bytes(u64 hash, const uint8_t* data, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        u64 word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Hashes the `size` bytes of `in` and rewinds it. Returns 0 on success.
+int hash_file(FILE* in, u64 size, char* buffer, u64* hash) {
+    u64 h = 0xcbf29ce484222325ull;
+    for (u64 done = 0; done < size;) {
+        size_t chunk = size - done < COPY_BUFFER_SIZE ? (size_t)(size - done) : COPY_BUFFER_SIZE;
+        if (fread(buffer, 1, chunk, in) != chunk) return 1;
+        h = hash_bytes(h, (const uint8_t*)buffer, chunk);
+        done += chunk;
+    }
+    *hash = h;
+    rewind(in);
+    return 0;
+}
+
+// Returns 1 if the first `size` bytes of both files are equal, 0 if not or
+// on a read error. `buffer` holds COPY_BUFFER_SIZE bytes.
+int files_equal(const char* path_a, const char* path_b, u64 size, char* buffer) {
+    FILE* a = fopen(path_a, "rb");
+    FILE* b = fopen(path_b, "rb");
+    int equal = a && b;
+    size_t half = COPY_BUFFER_SIZE / 2;
+    for (u64 done = 0; done < size && equal;) {
+        size_t chunk = size - done < half ? (size_t)(size - done) : half;
+        equal = fread(buffer, 1, chunk, a) == chunk && fread(buffer + half, 1, chunk, b) == chunk &&
+                memcmp(buffer, buffer + half, chunk) == 0;
+        done += chunk;
+    }
+    if (a) fclose(a);
+    if (b) fclose(b);
+    return equal;
+}
+
+// Returns a file bundled before with the same content as `e`, whose hash is
+// set. Otherwise adds `e` to the content index (`slots`, a power of two
+// larger than the number of files, holding entry index + 1) and returns NULL.
+// Without `compare`, for files kept from the previous bundle (which were
+// compared when it was written), files with the same hash and size match if
+// they already share their stored content.
+Entry* find_or_add_content(Entry* entries, u32* slots, u32 slot_count, Entry* e, int compare, char* buffer) {
+    u32 mask = slot_count - 1;
+    u32 slot = (u32)e->hash & mask;
+    for (; slots[slot] != 0; slot = (slot + 1) & mask) {
+        Entry* other = &entries[slots[slot] - 1];
+        if (other->hash != e->hash || other->size != e->size) continue;
+        if (compare ? files_equal(other->path, e->path, e->size, buffer) : other->bundled->offset == e->bundled->offset) {
+            return other;
+        }
+    }
+    slots[slot] = (u32)(e - entries) + 1;
+    return NULL;
+}
+
+// Writes `size` zero bytes to `out`
+void write_padding(FILE* out, u64 size) {
+    static const char zeros[4096];
+    while (size > 0) {
+        size_t chunk = size < sizeof(zeros) ? (size_t)size : sizeof(zeros);
+        fwrite(zeros, 1, chunk, out);
+        size -= chunk;
+    }
+}
+
+// Appends the first `size` bytes of `in` to `out`. Returns 0 on success.
+int copy_file(FILE* out, FILE* in, u64 size, char* buffer) {
+    u64 copied = 0;
+#if defined(__linux__)
+    // Both streams are unbuffered at this point: `in` was just opened or
+    // rewound and `out` is flushed, so the kernel copy continues at their
+    // file offsets
+    fflush(out);
+    copied = copy_file_range_all(fileno(out), fileno(in), size);
+#endif
+    while (copied < size) {
+        size_t chunk = size - copied < COPY_BUFFER_SIZE ? (size_t)(size - copied) : COPY_BUFFER_SIZE;
+        if (fread(buffer, 1, chunk, in) != chunk) return 1;
+        if (fwrite(buffer, 1, chunk, out) != chunk) return 1;
+        copied += chunk;
+    }
+    return 0;
+}
+
+// Appends `in` (`size` bytes) to `out`, at `offset`, as an LZ frame. Returns
+// the frame size, or 0 on a read error. `buffer` holds two blocks.
+u64 compress_file(FILE* out, u64 offset, FILE* in, u64 size, char* buffer) {
+    size_t prefix_size = lz_frame_prefix_size(size, LZ_FRAME_BLOCK_SIZE);
+    uint8_t* prefix = malloc(prefix_size);
+    if (!prefix) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    lz_frame_begin(prefix, size, LZ_FRAME_BLOCK_SIZE);
+
+    // Blocks follow the prefix, which is complete once they are written
+    u64 frame_size = prefix_size;
+    file_seek(out, (long long)(offset + prefix_size), SEEK_SET);
+    u32 block_count = (u32)((size + LZ_FRAME_BLOCK_SIZE - 1) / LZ_FRAME_BLOCK_SIZE);
+    for (u32 i = 0; i < block_count; i++) {
+        u64 begin = (u64)i * LZ_FRAME_BLOCK_SIZE;
+        size_t block_size = size - begin < LZ_FRAME_BLOCK_SIZE ? (size_t)(size - begin) : LZ_FRAME_BLOCK_SIZE;
+        if (fread(buffer, 1, block_size, in) != block_size) {
+            free(prefix);
+            return 0;
+        }
+        size_t stored = lz_frame_compress_block(prefix, i, buffer, buffer + LZ_FRAME_BLOCK_SIZE);
+        fwrite(buffer + LZ_FRAME_BLOCK_SIZE, 1, stored, out);
+        frame_size += stored;
+    }
+    file_seek(out, (long long)offset, SEEK_SET);
+    fwrite(prefix, 1, prefix_size, out);
+    file_seek(out, (long long)(offset + frame_size), SEEK_SET);
+    free(prefix);
+    return frame_size;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <manifest.txt> <bundle.bin>\n", argv[0]);
+    int compress = 0;
+    u64 alignment = 1;
+    int arg = 1;
+    for (; arg < argc - 2; arg++) {
+        if (strcmp(argv[arg], "--compress") == 0) {
+            compress = 1;
+        } else if (strcmp(argv[arg], "--align") == 0 && arg + 1 < argc - 2) {
+            char* end;
+            alignment = strtoull(argv[++arg], &end, 10);
+            if (*end != '\0' || alignment == 0 || alignment > MAX_ALIGNMENT || (alignment & (alignment - 1)) != 0) {
+                fprintf(stderr, "Error: --align takes a power of two up to %d\n", MAX_ALIGNMENT);
+                return 1;
+            }
+        } else {
+            break;
+        }
+    }
+    if (arg != argc - 2) {
+        fprintf(stderr, "Usage: %s [--compress] [--align <bytes>] <manifest.txt> <bundle.bin>\n", argv[0]);
+        return 1;
+    }
+    uint8_t align_shift = 0;
+    while ((1ull << align_shift) < alignment) align_shift++;
+
+    uint16_t endian_probe = 1;
+    if (*(uint8_t*)&endian_probe != 1) {
+        fprintf(stderr, "Error: Big-endian hosts are not supported\n");
         return 1;
     }
 
-    char* manifest_path = argv[1];
-    char* bundle_path = argv[2];
+    char* manifest_path = argv[argc - 2];
+    char* bundle_path = argv[argc - 1];
 
     FILE* mfp = fopen(manifest_path, "r");
     if (!mfp) {
@@ -125,100 +440,298 @@ int main(int argc, char* argv[]) {
         }
         if (line[0] == '\0') continue;  // Skip empty lines
 
-        FILE* fp = fopen(line, "rb");
-        if (!fp) {
+        FileStat st;
+        if (file_stat(line, &st) != 0 || (st.st_mode & S_IFMT) != S_IFREG) {
             fprintf(stderr, "Error: Cannot open file '%s'\n", line);
             fclose(mfp);
-            // Clean up existing entries
-            for (size_t i = 0; i < count; i++) {
-                free(entries[i].content);
-                free(entries[i].path);
-            }
-            free(entries);
+            free_entries(entries, count);
             return 1;
         }
+        u64 fsize = (u64)st.st_size;
 
-        fseek(fp, 0, SEEK_END);
-        long fsz_long = ftell(fp);
-        fseek(fp, 0, SEEK_SET);
-        if (fsz_long < 0) {
-            fprintf(stderr, "Error: Invalid file size for '%s'\n", line);
-            fclose(fp);
-            fclose(mfp);
-            // Cleanup...
-            return 1;
-        }
-        u64 fsize = (u64)fsz_long;
-
-        char* content = malloc(fsize);
-        if (!content || fread(content, 1, fsize, fp) != fsize) {
-            fprintf(stderr, "Error: Failed to read file '%s'\n", line);
-            free(content);
-            fclose(fp);
-            fclose(mfp);
-            // Cleanup...
-            return 1;
-        }
-        fclose(fp);
-
-        add_entry(&entries, &capacity, &count, line, fsize, content);
+        add_entry(&entries, &capacity, &count, line, fsize, file_mtime(st));
     }
     fclose(mfp);
 
     if (count == 0) {
         fprintf(stderr, "Error: No files in manifest\n");
-        free(entries);
+        free_entries(entries, count);
         return 1;
     }
 
-    // Compute total metadata size
-    size_t total_meta = 0;
+    // Metadata: header, index, entries and paths
+    u32 slot_count = 2;
+    while (slot_count < 2 * count) slot_count *= 2;
+    size_t strings_size = 0;
     for (size_t i = 0; i < count; i++) {
-        total_meta += 2 + entries[i].plen + 16;  // u16 + path + u64 + u64
+        strings_size += entries[i].plen + 1;
+    }
+    size_t index_offset = sizeof(BundleHeader);
+    size_t entries_offset = index_offset + (size_t)slot_count * sizeof(u32);
+    size_t strings_offset = entries_offset + count * sizeof(BundleEntry);
+    size_t meta_size = strings_offset + strings_size;
+    if (meta_size > UINT32_MAX) {
+        fprintf(stderr, "Error: Too many files or paths too long\n");
+        return 1;
+    }
+
+    uint8_t* meta = calloc(1, meta_size);
+    if (!meta) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
     }
+    BundleHeader* header = (BundleHeader*)meta;
+    memcpy(header->magic, BUNDLE_MAGIC, 4);
+    header->version = BUNDLE_VERSION;
+    header->align_shift = align_shift;
+    header->slot_count = slot_count;
+    header->index_offset = (u32)index_offset;
+    header->entries_offset = (u32)entries_offset;
+    header->strings_offset = (u32)strings_offset;
+    header->strings_size = (u32)strings_size;
+    u32* slots = (u32*)(meta + index_offset);
+    BundleEntry* bundle_entries = (BundleEntry*)(meta + entries_offset);
 
-    u64 content_start = 9ULL + (u64)total_meta;
-    u64 cur_offset = content_start;
+    size_t string_pos = strings_offset;
+    u32 file_count = 0;
     for (size_t i = 0; i < count; i++) {
-        entries[i].offset = cur_offset;
-        cur_offset += entries[i].size;
+        Entry* e = &entries[i];
+        if (bundle_find_entry(meta, e->path, (u32)e->plen)) {
+            fprintf(stderr, "Warning: '%s' is listed more than once, bundling it once\n", e->path);
+            continue;
+        }
+        BundleEntry* be = &bundle_entries[file_count];
+        be->path_hash = bundle_path_hash(e->path, (u32)e->plen);
+        be->path_offset = (u32)string_pos;
+        be->path_size = (u32)e->plen;
+        memcpy(meta + string_pos, e->path, e->plen);  // NUL from calloc
+        string_pos += e->plen + 1;
+        e->bundled = be;
+
+        u32 slot = be->path_hash & (slot_count - 1);
+        while (slots[slot] != 0) slot = (slot + 1) & (slot_count - 1);
+        slots[slot] = file_count + 1;
+        file_count++;
+        header->file_count = file_count;
+    }
+
+    char* buffer = malloc(COPY_BUFFER_SIZE);
+    u32* content_slots = calloc(slot_count, sizeof(u32));
+    size_t cache_path_size = strlen(bundle_path) + sizeof(".cache");
+    char* cache_path = malloc(cache_path_size);
+    if (!buffer || !content_slots || !cache_path) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    snprintf(cache_path, cache_path_size, "%s.cache", bundle_path);
+
+    u64 cur_offset = meta_size;
+    u64 written_end = meta_size;
+    u64 raw_size = 0;
+    u64 compressed_size = 0;
+    u32 compressed_count = 0;
+    u64 shared_size = 0;
+    u32 shared_count = 0;
+
+    // Keep the previous bundle up to the first file that changed, if the
+    // cache describes it and it has the same options and paths
+    Cache cache;
+    FileStat bundle_st;
+    const char* rebuild = NULL;  // Why the bundle is written from scratch
+    if (!read_cache(cache_path, &cache)) {
+        rebuild = "no cache";
+    } else if (cache.compress != compress || cache.alignment != alignment) {
+        rebuild = "options changed";
+    } else if (!cache_has_paths(&cache, entries, count, file_count)) {
+        rebuild = "manifest changed";
+    } else if (file_stat(bundle_path, &bundle_st) != 0 || (u64)bundle_st.st_size != cache.bundle_size ||
+               file_mtime(bundle_st) != cache.bundle_mtime) {
+        rebuild = "bundle changed since it was written";
     }
+    size_t first = count;  // First file to write
+    u32 kept_count = 0;
+    u32 changed_count = 0;
+    u32 touched_count = 0;
+    for (size_t i = 0, j = 0; i < count && !rebuild; i++) {
+        Entry* e = &entries[i];
+        BundleEntry* be = e->bundled;
+        if (!be) continue;
+        const CachedFile* cf = &cache.files[j++];
+        int unchanged = cf->size == e->size;
+        if (unchanged && cf->mtime != e->mtime && e->size != 0) {
+            // Touched, maybe not modified: compare the content
+            FILE* fp = fopen(e->path, "rb");
+            unchanged = fp && hash_file(fp, e->size, buffer, &e->hash) == 0 && e->hash == cf->hash;
+            if (fp) fclose(fp);
+            touched_count += unchanged;
+        }
+        if (!unchanged) {
+            printf("Changed: %s\n", e->path);
+            changed_count++;
+            if (first == count) first = i;
+            continue;
+        }
+        if (first != count) continue;
 
-    // Write bundle
-    FILE* bfp = fopen(bundle_path, "wb");
+        e->hash = cf->hash;
+        be->offset = cf->offset;
+        be->size = cf->stored_size;
+        be->codec = cf->codec;
+        kept_count++;
+        if (e->size == 0) continue;
+        if (find_or_add_content(entries, content_slots, slot_count, e, 0, buffer)) {
+            shared_size += e->size;
+            shared_count++;
+        } else {
+            if (be->offset + be->size > cur_offset) cur_offset = be->offset + be->size;
+            if (be->codec == BUNDLE_CODEC_LZ) {
+                raw_size += e->size;
+                compressed_size += be->size;
+                compressed_count++;
+            }
+        }
+    }
+    u64 old_size = cache.bundle_size;
+    free_cache(&cache);
+
+    if (!rebuild && changed_count == 0) {
+        // Save the new mtimes of touched files, so they are not hashed again
+        if (touched_count > 0 && write_cache(cache_path, bundle_path, compress, alignment, entries, count, file_count) != 0) {
+            fprintf(stderr, "Warning: Cannot write cache '%s'\n", cache_path);
+        }
+        printf("'%s' is up to date (%u files)\n", bundle_path, file_count);
+        free(buffer);
+        free(content_slots);
+        free(cache_path);
+        free_entries(entries, count);
+        free(meta);
+        return 0;
+    }
+    if (rebuild) {
+        printf("Writing '%s' from scratch: %s\n", bundle_path, rebuild);
+        first = 0;
+        kept_count = 0;
+    }
+
+    // Write bundle: contents after the metadata first (or after the files
+    // that are kept), then the metadata with their offsets and stored sizes.
+    // The cache goes first, so it never describes a half written bundle.
+    remove(cache_path);
+    FILE* bfp = fopen(bundle_path, rebuild ? "wb" : "r+b");
     if (!bfp) {
         fprintf(stderr, "Error: Cannot create bundle '%s'\n", bundle_path);
-        // Cleanup
-        for (size_t i = 0; i < count; i++) {
-            free(entries[i].content);
-            free(entries[i].path);
-        }
-        free(entries);
+        free(buffer);
+        free(content_slots);
+        free(cache_path);
+        free_entries(entries, count);
+        free(meta);
         return 1;
     }
+    if (!rebuild) written_end = old_size;
 
-    // Header
-    fwrite("JSFS", 1, 4, bfp);
-    fputc(1, bfp);
-    write_u32_be(bfp, (u32)count);
+    int failed = 0;
+    u64 rewrite_offset = cur_offset;
+    file_seek(bfp, (long long)cur_offset, SEEK_SET);
+    for (size_t i = first; i < count && !failed; i++) {
+        Entry* e = &entries[i];
+        BundleEntry* be = e->bundled;
+        if (!be) continue;
+        be->offset = cur_offset;
+        be->size = e->size;
+        be->codec = BUNDLE_CODEC_NONE;
+        if (e->size == 0) continue;
 
-    // Metadata
-    for (size_t i = 0; i < count; i++) {
-        write_u16_be(bfp, (u16)entries[i].plen);
-        fwrite(entries[i].path, 1, entries[i].plen, bfp);
-        write_u64_be(bfp, entries[i].size);
-        write_u64_be(bfp, entries[i].offset);
+        FILE* fp = fopen(e->path, "rb");
+        if (!fp) {
+            fprintf(stderr, "Error: Cannot open file '%s'\n", e->path);
+            failed = 1;
+            break;
+        }
+        if (hash_file(fp, e->size, buffer, &e->hash) != 0) {
+            fprintf(stderr, "Error: Cannot read '%s' (changed while bundling?)\n", e->path);
+            fclose(fp);
+            failed = 1;
+            break;
+        }
+        Entry* same = find_or_add_content(entries, content_slots, slot_count, e, 1, buffer);
+        if (same) {
+            be->offset = same->bundled->offset;
+            be->size = same->bundled->size;
+            be->codec = same->bundled->codec;
+            shared_size += e->size;
+            shared_count++;
+            fclose(fp);
+            continue;
+        }
+
+        // The file position is at cur_offset after every file
+        u64 padding = (alignment - cur_offset % alignment) % alignment;
+        write_padding(bfp, padding);
+        cur_offset += padding;
+        be->offset = cur_offset;
+        if (compress) {
+            u64 frame_size = compress_file(bfp, cur_offset, fp, e->size, buffer);
+            if (frame_size != 0 && frame_size <= e->size - e->size / 16) {
+                be->size = frame_size;
+                be->codec = BUNDLE_CODEC_LZ;
+                raw_size += e->size;
+                compressed_size += frame_size;
+                compressed_count++;
+            } else {
+                // Store it as is over the frame
+                if (cur_offset + frame_size > written_end) written_end = cur_offset + frame_size;
+                file_seek(bfp, (long long)cur_offset, SEEK_SET);
+                rewind(fp);
+            }
+        }
+        if (be->codec == BUNDLE_CODEC_NONE && copy_file(bfp, fp, e->size, buffer) != 0) {
+            fprintf(stderr, "Error: Cannot copy '%s' (changed while bundling?)\n", e->path);
+            failed = 1;
+        }
+        fclose(fp);
+        cur_offset += be->size;
     }
+    free(buffer);
+    free(content_slots);
+    header->total_size = cur_offset;
 
-    // Contents
-    for (size_t i = 0; i < count; i++) {
-        fwrite(entries[i].content, 1, entries[i].size, bfp);
-        free(entries[i].content);
-        free(entries[i].path);
+    file_seek(bfp, 0, SEEK_SET);
+    fwrite(meta, 1, meta_size, bfp);
+    free(meta);
+    // A frame that was replaced by a shorter copy of its file, or the old
+    // tail of a bundle that is rewritten, may stick out past the last file
+    if (written_end > cur_offset && !failed) {
+        fflush(bfp);
+        if (file_truncate(bfp, cur_offset) != 0) failed = 1;
     }
-    free(entries);
 
-    fclose(bfp);
-    printf("Bundled %zu files into '%s' (%llu bytes total)\n", count, bundle_path, content_start + (cur_offset - content_start));
+    if (fclose(bfp) != 0 && !failed) {
+        fprintf(stderr, "Error: Cannot write bundle '%s'\n", bundle_path);
+        failed = 1;
+    }
+    if (failed) {
+        remove(bundle_path);
+        free(cache_path);
+        free_entries(entries, count);
+        return 1;
+    }
+    if (write_cache(cache_path, bundle_path, compress, alignment, entries, count, file_count) != 0) {
+        fprintf(stderr, "Warning: Cannot write cache '%s'\n", cache_path);
+    }
+    free(cache_path);
+    free_entries(entries, count);
+    if (kept_count > 0) {
+        printf("Kept %u unchanged files, rewrote %u from byte %llu on\n", kept_count, file_count - kept_count,
+               (unsigned long long)rewrite_offset);
+    }
+    if (shared_count > 0) {
+        printf("Stored %u files with the same content as another once: %llu bytes saved\n", shared_count,
+               (unsigned long long)shared_size);
+    }
+    if (compress) {
+        printf("Compressed %u of %u files: %llu -> %llu bytes\n", compressed_count, file_count,
+               (unsigned long long)raw_size, (unsigned long long)compressed_size);
+    }
+    printf("Bundled %u files into '%s' (%llu bytes total)\n", file_count, bundle_path, (unsigned long long)cur_offset);
     return 0;
 }
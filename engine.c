@@ -11,7 +11,13 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include "base/atomics.h"
 #include "base/base_io.h"
+#include "base/base_math.h"
+#include "base/hash.h"
+#include "base/mem.h"
+#include "base/profile.h"
+#include "base/scratch.h"
 
 // Scene struct (opaque to users)
 struct Scene {
@@ -20,7 +26,26 @@ struct Scene {
     bool use_mmap;           // If true, release via platform_file_unmap
     uint64_t mmap_handle;    // Opaque handle for platform_file_unmap (0 if not mapped)
 
-    SceneHeader *header;     // Pointer to header
+    const SceneHeader *header;  // Pointer to header, in the blob or `upgraded`
+
+    // Older versions are read as the current one: version 2 without
+    // checksums, version 1 also with a single mesh
+    SceneHeader upgraded;
+    SceneMesh v1_mesh;
+
+    // SECTION_* of each section, checked on its first access
+    atomic_u32 section_state[SCENE_SECTION_COUNT];
+};
+
+#define SECTION_UNCHECKED 0
+#define SECTION_VALID 1
+#define SECTION_CORRUPT 2
+
+// Version 2 headers end before the checksums
+#define SCENE_HEADER_V2_SIZE offsetof(SceneHeader, source_key)
+
+static const char *const g_section_names[SCENE_SECTION_COUNT] = {
+    "Vertex", "Index", "Light", "Texture", "Mesh", "String",
 };
 
 // Engine rendering context
@@ -35,149 +60,242 @@ struct Engine {
     SDL_GPUTexture *textures[8];     // One per surface_type_id
     SDL_GPUSampler *samplers[8];     // One per texture
 
+    SceneMesh *meshes;               // Copy of the scene's mesh table, one draw each
+    uint32_t mesh_count;
+    uint32_t vertex_format;          // SCENE_VERTEX_* of the vertex buffer
+    uint32_t mesh_bounds_offset;     // Of the MeshBounds after packed vertices
+
     uint32_t vertex_count;
     uint32_t index_count;
 };
 
+// Per-mesh instance data that packed vertices are dequantized with, bound
+// as a second vertex buffer: draw i uses instance i
+typedef struct {
+    float min[4];
+    float extent[4];
+} MeshBounds;
+
 // ============================================================================
 // Internal Helper Functions
 // ============================================================================
 
-static bool validate_header(SceneHeader *header, uint64_t blob_size) {
-    // Check magic and version
+// Checks that `count` elements of `element_size` bytes at `offset` lie within
+// the blob, including empty sections, whose offset is still used as a
+// pointer. An element_size of 0 skips the size check.
+static bool validate_section(const char *name, uint64_t offset, uint64_t size, uint64_t count,
+                             uint64_t element_size, uint64_t blob_size) {
+    if (offset > blob_size || size > blob_size - offset) {
+        SDL_Log("%s data out of bounds", name);
+        return false;
+    }
+    if (element_size != 0 && size != count * element_size) {
+        SDL_Log("%s size mismatch", name);
+        return false;
+    }
+    return true;
+}
+
+// Checks the fields all versions share at the start of the header
+static bool validate_preamble(const SceneHeader *header, uint64_t blob_size) {
     if (header->magic != SCENE_MAGIC) {
         SDL_Log("Invalid scene magic: 0x%08x (expected 0x%08x)", header->magic, SCENE_MAGIC);
         return false;
     }
-    if (header->version != SCENE_VERSION) {
-        SDL_Log("Invalid scene version: %u (expected %u)", header->version, SCENE_VERSION);
+    if (header->version < 1 || header->version > SCENE_VERSION) {
+        SDL_Log("Invalid scene version: %u (expected 1 to %u)", header->version, SCENE_VERSION);
         return false;
     }
     if (header->total_size != blob_size) {
         SDL_Log("Scene total_size mismatch: %llu != %llu", header->total_size, blob_size);
         return false;
     }
+    return true;
+}
 
-    // Validate vertex data
-    uint64_t vertex_offset = (uint64_t)(uintptr_t)header->vertices;
-    if (header->vertex_count > 0) {
-        if (vertex_offset + header->vertex_size > blob_size) {
-            SDL_Log("Vertex data out of bounds");
-            return false;
-        }
-        if (header->vertex_size != header->vertex_count * sizeof(SceneVertex)) {
-            SDL_Log("Vertex size mismatch");
-            return false;
-        }
+// Checks that the string arena of the blob ends with a terminator, so every
+// offset within it starts a terminated string. Called after validate_section.
+static bool validate_strings(const void *blob, uint64_t offset, uint64_t size) {
+    if (size > 0 && ((const char *)blob)[offset + size - 1] != '\0') {
+        SDL_Log("String data not terminated");
+        return false;
     }
+    return true;
+}
 
-    // Validate index data
-    uint64_t index_offset = (uint64_t)(uintptr_t)header->indices;
-    if (header->index_count > 0) {
-        if (index_offset + header->index_size > blob_size) {
-            SDL_Log("Index data out of bounds");
-            return false;
-        }
-        if (header->index_size != header->index_count * sizeof(uint16_t)) {
-            SDL_Log("Index size mismatch");
-            return false;
-        }
+static bool validate_header_v1(const SceneHeaderV1 *header, uint64_t blob_size) {
+    return validate_section("Vertex", header->vertices, header->vertex_size,
+                            header->vertex_count, sizeof(SceneVertex), blob_size) &&
+           validate_section("Index", header->indices, header->index_size,
+                            header->index_count, sizeof(uint16_t), blob_size) &&
+           validate_section("Light", header->lights, header->light_size,
+                            header->light_count, sizeof(SceneLight), blob_size) &&
+           validate_section("Texture", header->textures, header->texture_size,
+                            header->texture_count, sizeof(SceneTexture), blob_size) &&
+           validate_section("String", header->strings, header->string_size,
+                            header->string_size, 1, blob_size) &&
+           validate_strings(header, header->strings, header->string_size);
+}
+
+// Byte range of a section within the blob
+static void section_range(const SceneHeader *header, int section, uint64_t *offset, uint64_t *size) {
+    switch (section) {
+        case SCENE_SECTION_VERTICES: *offset = header->vertices; *size = header->vertex_size; break;
+        case SCENE_SECTION_INDICES: *offset = header->indices; *size = header->index_size; break;
+        case SCENE_SECTION_LIGHTS: *offset = header->lights; *size = header->light_size; break;
+        case SCENE_SECTION_TEXTURES: *offset = header->textures; *size = header->texture_size; break;
+        case SCENE_SECTION_MESHES: *offset = header->meshes; *size = header->mesh_size; break;
+        default: *offset = header->strings; *size = header->string_size; break;
     }
+}
 
-    // Validate light data
-    uint64_t light_offset = (uint64_t)(uintptr_t)header->lights;
-    if (header->light_count > 0) {
-        if (light_offset + header->light_size > blob_size) {
-            SDL_Log("Light data out of bounds");
-            return false;
-        }
-        if (header->light_size != header->light_count * sizeof(SceneLight)) {
-            SDL_Log("Light size mismatch");
-            return false;
-        }
+// Compares a section of a version 3 blob with its checksum. Called after
+// validate_section.
+static bool verify_section(const void *blob, const SceneHeader *header, int section) {
+    uint64_t offset, size;
+    section_range(header, section, &offset, &size);
+    if (hash64((const uint8_t *)blob + offset, (size_t)size, 0) != header->checksums[section]) {
+        SDL_Log("%s data checksum mismatch", g_section_names[section]);
+        return false;
     }
+    return true;
+}
 
-    // Validate texture data
-    uint64_t texture_offset = (uint64_t)(uintptr_t)header->textures;
-    if (header->texture_count > 0) {
-        if (texture_offset + header->texture_size > blob_size) {
-            SDL_Log("Texture data out of bounds");
+// Checks a version 2 or 3 header. The mesh table and strings, which this
+// reads, are verified here; the other sections on their first access.
+static bool validate_header(const SceneHeader *header, uint64_t blob_size) {
+    bool checksummed = header->version >= 3;
+    if (blob_size < (checksummed ? sizeof(SceneHeader) : SCENE_HEADER_V2_SIZE)) {
+        SDL_Log("Scene too small for a version %u header", header->version);
+        return false;
+    }
+    if (checksummed && hash64(header, offsetof(SceneHeader, header_checksum), 0) != header->header_checksum) {
+        SDL_Log("Scene header checksum mismatch");
+        return false;
+    }
+    if (header->vertex_format != SCENE_VERTEX_FLOAT && header->vertex_format != SCENE_VERTEX_PACKED) {
+        SDL_Log("Invalid vertex format %u", header->vertex_format);
+        return false;
+    }
+    uint64_t vertex_stride = header->vertex_format == SCENE_VERTEX_PACKED ? sizeof(ScenePackedVertex)
+                                                                           : sizeof(SceneVertex);
+    bool sections_valid =
+        validate_section("Vertex", header->vertices, header->vertex_size,
+                         header->vertex_count, vertex_stride, blob_size) &&
+        validate_section("Index", header->indices, header->index_size,
+                         header->index_count, 0, blob_size) &&
+        validate_section("Light", header->lights, header->light_size,
+                         header->light_count, sizeof(SceneLight), blob_size) &&
+        validate_section("Texture", header->textures, header->texture_size,
+                         header->texture_count, sizeof(SceneTexture), blob_size) &&
+        validate_section("String", header->strings, header->string_size,
+                         header->string_size, 1, blob_size) &&
+        validate_section("Mesh", header->meshes, header->mesh_size,
+                         header->mesh_count, sizeof(SceneMesh), blob_size);
+    if (!sections_valid) {
+        return false;
+    }
+    if (checksummed && (!verify_section(header, header, SCENE_SECTION_MESHES) ||
+                        !verify_section(header, header, SCENE_SECTION_STRINGS))) {
+        return false;
+    }
+    if (!validate_strings(header, header->strings, header->string_size)) {
+        return false;
+    }
+    if (header->index_size > UINT32_MAX) {
+        SDL_Log("Index data too large: %llu bytes", header->index_size);
+        return false;
+    }
+
+    // Every mesh must draw vertices and indices of the scene
+    const SceneMesh *meshes = (const SceneMesh *)((const uint8_t *)header + header->meshes);
+    uint64_t index_count = 0;
+    for (uint32_t i = 0; i < header->mesh_count; i++) {
+        const SceneMesh *mesh = &meshes[i];
+        if ((uint64_t)mesh->first_vertex + mesh->vertex_count > header->vertex_count) {
+            SDL_Log("Mesh %u vertices out of bounds", i);
             return false;
         }
-        if (header->texture_size != header->texture_count * sizeof(SceneTexture)) {
-            SDL_Log("Texture size mismatch");
+        if (mesh->index_size != SCENE_INDEX_16 && mesh->index_size != SCENE_INDEX_32) {
+            SDL_Log("Mesh %u has an invalid index size %u", i, mesh->index_size);
             return false;
         }
-    }
-
-    // Validate string arena
-    uint64_t string_offset = (uint64_t)(uintptr_t)header->strings;
-    if (header->string_size > 0) {
-        if (string_offset + header->string_size > blob_size) {
-            SDL_Log("String data out of bounds");
+        if (mesh->index_offset % 4 != 0 || mesh->index_offset > header->index_size ||
+            (uint64_t)mesh->index_count * mesh->index_size > header->index_size - mesh->index_offset) {
+            SDL_Log("Mesh %u indices out of bounds", i);
             return false;
         }
+        index_count += mesh->index_count;
+    }
+    if (index_count != header->index_count) {
+        SDL_Log("Mesh index counts add up to %llu, not %u", (unsigned long long)index_count,
+                header->index_count);
+        return false;
     }
-
     return true;
 }
 
-static void release_scene_blob(void *blob, bool use_mmap, uint64_t mmap_handle) {
-    if (!blob) return;
-    if (use_mmap) {
-        platform_file_unmap(mmap_handle);
-    } else {
-        free(blob);
-    }
+// Reads a version 1 header as a version 2 one
+static void upgrade_header_v1(Scene *scene) {
+    const SceneHeaderV1 *v1 = (const SceneHeaderV1 *)scene->blob;
+    SceneHeader *header = &scene->upgraded;
+    base_memset(header, 0, sizeof(SceneHeader));
+    header->magic = v1->magic;
+    header->version = v1->version;
+    header->total_size = v1->total_size;
+    header->vertices = v1->vertices;
+    header->vertex_size = v1->vertex_size;
+    header->vertex_count = v1->vertex_count;
+    header->indices = v1->indices;
+    header->index_size = v1->index_size;
+    header->index_count = v1->index_count;
+    header->lights = v1->lights;
+    header->light_size = v1->light_size;
+    header->light_count = v1->light_count;
+    header->textures = v1->textures;
+    header->texture_size = v1->texture_size;
+    header->texture_count = v1->texture_count;
+    header->strings = v1->strings;
+    header->string_size = v1->string_size;
+    scene->header = header;
 }
 
-static void fixup_scene_pointers(Scene *scene) {
-    SceneHeader *header = scene->header;
-    char *base = (char *)scene->blob;
-
-    // Fix up array pointers
-    if (header->vertex_count > 0) {
-        header->vertices = (SceneVertex *)(base + (uintptr_t)header->vertices);
-    } else {
-        header->vertices = NULL;
-    }
-
-    if (header->index_count > 0) {
-        header->indices = (uint16_t *)(base + (uintptr_t)header->indices);
-    } else {
-        header->indices = NULL;
-    }
-
-    if (header->light_count > 0) {
-        header->lights = (SceneLight *)(base + (uintptr_t)header->lights);
-    } else {
-        header->lights = NULL;
-    }
+// Reads a version 2 header, which ends before the checksums
+static void upgrade_header_v2(Scene *scene) {
+    SceneHeader *header = &scene->upgraded;
+    base_memset(header, 0, sizeof(SceneHeader));
+    base_memcpy(header, scene->blob, SCENE_HEADER_V2_SIZE);
+    scene->header = header;
+}
 
-    if (header->texture_count > 0) {
-        header->textures = (SceneTexture *)(base + (uintptr_t)header->textures);
-    } else {
-        header->textures = NULL;
+// Describes the indices of a version 1 scene, which index all its vertices,
+// as one mesh. Called after upgrade_header_v1.
+static void add_v1_mesh(Scene *scene) {
+    SceneHeader *header = &scene->upgraded;
+    SceneMesh *mesh = &scene->v1_mesh;
+    base_memset(mesh, 0, sizeof(SceneMesh));
+    mesh->vertex_count = header->vertex_count;
+    mesh->index_count = header->index_count;
+    mesh->index_size = SCENE_INDEX_16;
+    mesh->material = SCENE_MATERIAL_MIXED;
+    const SceneVertex *vertices = scene_vertices(scene);
+    for (uint32_t i = 0; i < header->vertex_count; i++) {
+        const float *position = vertices[i].position;
+        for (int axis = 0; axis < 3; axis++) {
+            if (i == 0 || position[axis] < mesh->bounds_min[axis]) mesh->bounds_min[axis] = position[axis];
+            if (i == 0 || position[axis] > mesh->bounds_max[axis]) mesh->bounds_max[axis] = position[axis];
+        }
     }
+    header->mesh_size = sizeof(SceneMesh);
+    header->mesh_count = header->index_count > 0 ? 1 : 0;
+}
 
-    if (header->string_size > 0) {
-        header->strings = base + (uintptr_t)header->strings;
+static void release_scene_blob(void *blob, bool use_mmap, uint64_t mmap_handle) {
+    if (!blob) return;
+    if (use_mmap) {
+        platform_file_unmap(mmap_handle);
     } else {
-        header->strings = NULL;
-    }
-
-    // Fix up texture path_offset -> pointer
-    for (uint32_t i = 0; i < header->texture_count; i++) {
-        SceneTexture *tex = &header->textures[i];
-        // Validate string offset is within string arena
-        if (tex->path_offset >= header->string_size) {
-            SDL_Log("Warning: texture %u path_offset %llu out of bounds (string_size=%llu)",
-                    i, tex->path_offset, header->string_size);
-            tex->path_offset = 0; // Point to empty string or start of arena
-        }
-        // Convert offset to pointer by storing pointer in path_offset field
-        // This is a bit of a hack, but works since we're converting offset->ptr
-        tex->path_offset = (uint64_t)(uintptr_t)(header->strings + tex->path_offset);
+        free(blob);
     }
 }
 
@@ -191,14 +309,22 @@ Scene* scene_load_from_memory(void *blob, uint64_t blob_size, bool use_mmap, uin
         return NULL;
     }
 
-    if (blob_size < sizeof(SceneHeader)) {
+    if (blob_size < sizeof(SceneHeaderV1)) {
         SDL_Log("scene_load_from_memory: blob too small (%llu bytes)", blob_size);
         release_scene_blob(blob, use_mmap, mmap_handle);
         return NULL;
     }
 
-    SceneHeader *header = (SceneHeader *)blob;
-    if (!validate_header(header, blob_size)) {
+    // Versions 1 and 2 share the fields up to total_size, and
+    // SceneHeaderV1 is smaller than SceneHeader
+    const SceneHeader *header = (const SceneHeader *)blob;
+    bool valid = validate_preamble(header, blob_size);
+    if (valid && header->version == 1) {
+        valid = validate_header_v1((const SceneHeaderV1 *)blob, blob_size);
+    } else if (valid) {
+        valid = validate_header(header, blob_size);
+    }
+    if (!valid) {
         SDL_Log("scene_load_from_memory: header validation failed");
         release_scene_blob(blob, use_mmap, mmap_handle);
         return NULL;
@@ -217,10 +343,25 @@ Scene* scene_load_from_memory(void *blob, uint64_t blob_size, bool use_mmap, uin
     scene->mmap_handle = mmap_handle;
     scene->header = header;
 
-    fixup_scene_pointers(scene);
+    // Sections of older versions have no checksums, and validate_header
+    // verified the mesh table and strings
+    for (int i = 0; i < SCENE_SECTION_COUNT; i++) {
+        bool checked = header->version < 3 || i == SCENE_SECTION_MESHES || i == SCENE_SECTION_STRINGS;
+        atomic_store_u32(&scene->section_state[i], checked ? SECTION_VALID : SECTION_UNCHECKED, ATOMIC_RELAXED);
+    }
 
-    SDL_Log("Loaded scene: %u vertices, %u indices, %u lights, %u textures",
-            header->vertex_count, header->index_count, header->light_count, header->texture_count);
+    if (header->version == 1) {
+        upgrade_header_v1(scene);
+        add_v1_mesh(scene);
+        header = scene->header;
+    } else if (header->version == 2) {
+        upgrade_header_v2(scene);
+        header = scene->header;
+    }
+
+    SDL_Log("Loaded scene v%u: %u vertices, %u indices, %u meshes, %u lights, %u textures",
+            header->version, header->vertex_count, header->index_count, header->mesh_count,
+            header->light_count, header->texture_count);
 
     return scene;
 }
@@ -234,7 +375,10 @@ Scene* scene_load_from_file(const char *path) {
     uint64_t mmap_handle = 0;
     void *data = NULL;
     size_t size = 0;
-    if (platform_read_file_mmap(path, &mmap_handle, &data, &size)) {
+    // The blob is never written, so its pages are shared with every other
+    // process that maps the file
+    if (platform_read_file_mmap(path, PLATFORM_MMAP_READONLY | PLATFORM_MMAP_POPULATE,
+                                &mmap_handle, &data, &size)) {
         if (size == 0 || data == NULL) {
             SDL_Log("scene_load_from_file: file %s is empty", path);
             platform_file_unmap(mmap_handle);
@@ -282,6 +426,121 @@ const SceneHeader* scene_get_header(const Scene *scene) {
     return scene ? scene->header : NULL;
 }
 
+// Verifies a section on its first access. Threads racing here both hash it
+// and store the same state.
+static bool scene_section_valid(const Scene *scene, int section) {
+    // The states are the only part of a scene that its readers change
+    atomic_u32 *state = &((Scene *)scene)->section_state[section];
+    uint32_t value = atomic_load_u32(state, ATOMIC_ACQUIRE);
+    if (value == SECTION_UNCHECKED) {
+        PROFILE_ZONE("scene_verify_section");
+        value = verify_section(scene->blob, scene->header, section) ? SECTION_VALID : SECTION_CORRUPT;
+        atomic_store_u32(state, value, ATOMIC_RELEASE);
+    }
+    return value == SECTION_VALID;
+}
+
+// The start of a section, or NULL if it has no elements or is corrupt
+static const void *scene_section(const Scene *scene, int section, uint64_t offset, uint32_t count) {
+    if (count == 0 || !scene_section_valid(scene, section)) {
+        return NULL;
+    }
+    return (const uint8_t *)scene->blob + offset;
+}
+
+const void* scene_vertices(const Scene *scene) {
+    return scene_section(scene, SCENE_SECTION_VERTICES, scene->header->vertices, scene->header->vertex_count);
+}
+
+const void* scene_indices(const Scene *scene) {
+    return scene_section(scene, SCENE_SECTION_INDICES, scene->header->indices, scene->header->index_count);
+}
+
+const SceneLight* scene_lights(const Scene *scene) {
+    return scene_section(scene, SCENE_SECTION_LIGHTS, scene->header->lights, scene->header->light_count);
+}
+
+const SceneTexture* scene_textures(const Scene *scene) {
+    return scene_section(scene, SCENE_SECTION_TEXTURES, scene->header->textures, scene->header->texture_count);
+}
+
+const SceneMesh* scene_meshes(const Scene *scene) {
+    if (scene->header->version == 1) {
+        return scene->header->mesh_count > 0 ? &scene->v1_mesh : NULL;
+    }
+    return scene_section(scene, SCENE_SECTION_MESHES, scene->header->meshes, scene->header->mesh_count);
+}
+
+const char* scene_texture_path(const Scene *scene, uint32_t texture) {
+    const SceneHeader *header = scene->header;
+    const SceneTexture *textures = scene_textures(scene);
+    if (!textures) {
+        return "";
+    }
+    uint64_t offset = textures[texture].path_offset;
+    if (offset >= header->string_size) {
+        SDL_Log("Warning: texture %u path_offset %llu out of bounds (string_size=%llu)",
+                texture, offset, header->string_size);
+        return "";
+    }
+    return (const char *)scene->blob + header->strings + offset;
+}
+
+bool scene_verify(const Scene *scene) {
+    bool valid = true;
+    for (int i = 0; i < SCENE_SECTION_COUNT; i++) {
+        valid = scene_section_valid(scene, i) && valid;
+    }
+    return valid;
+}
+
+static float half_to_float(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    if (exponent == 0) {
+        float value = (float)mantissa * (1.0f / 16777216.0f);  // Zero or subnormal
+        return sign ? -value : value;
+    }
+    union { uint32_t u; float f; } bits;
+    if (exponent == 31) {
+        bits.u = sign | 0x7F800000 | (mantissa << 13);  // Infinity or NaN
+    } else {
+        bits.u = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    return bits.f;
+}
+
+void scene_unpack_vertex(const Scene *scene, const SceneMesh *mesh, uint32_t index, SceneVertex *out) {
+    if (scene->header->vertex_format != SCENE_VERTEX_PACKED) {
+        *out = ((const SceneVertex *)scene_vertices(scene))[index];
+        return;
+    }
+
+    // The same decoding as the packed scene vertex shader
+    const ScenePackedVertex *v = &((const ScenePackedVertex *)scene_vertices(scene))[index];
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = mesh->bounds_max[axis] - mesh->bounds_min[axis];
+        out->position[axis] = mesh->bounds_min[axis] + (float)v->position[axis] / 65535.0f * extent;
+    }
+    out->surface_type = (float)v->material;
+    out->uv[0] = half_to_float(v->uv[0]);
+    out->uv[1] = half_to_float(v->uv[1]);
+
+    float x = (float)v->normal[0] / 32767.0f;
+    float y = (float)v->normal[1] / 32767.0f;
+    x = x < -1.0f ? -1.0f : x;
+    y = y < -1.0f ? -1.0f : y;
+    float z = 1.0f - base_fabsf(x) - base_fabsf(y);
+    float t = z < 0.0f ? -z : 0.0f;
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+    float length = fast_sqrtf(x * x + y * y + z * z);
+    out->normal[0] = x / length;
+    out->normal[1] = y / length;
+    out->normal[2] = z / length;
+}
+
 void scene_free(Scene *scene) {
     if (!scene) return;
 
@@ -330,6 +589,10 @@ Engine* engine_create(SDL_GPUDevice *device) {
     engine->index_buffer = NULL;
     engine->vertex_transfer_buffer = NULL;
     engine->index_transfer_buffer = NULL;
+    engine->meshes = NULL;
+    engine->mesh_count = 0;
+    engine->vertex_format = SCENE_VERTEX_FLOAT;
+    engine->mesh_bounds_offset = 0;
 
     for (int i = 0; i < 8; i++) {
         engine->textures[i] = NULL;
@@ -343,6 +606,7 @@ Engine* engine_create(SDL_GPUDevice *device) {
 }
 
 bool engine_upload_scene(Engine *engine, const Scene *scene) {
+    PROFILE_ZONE("engine_upload_scene");
     if (!engine || !scene) {
         SDL_Log("engine_upload_scene: NULL parameter");
         return false;
@@ -351,8 +615,9 @@ bool engine_upload_scene(Engine *engine, const Scene *scene) {
     const SceneHeader *header = scene->header;
     uint32_t vertex_count = header->vertex_count;
     uint32_t index_count = header->index_count;
-    const SceneVertex *vertices = header->vertices;
-    const uint16_t *indices = header->indices;
+    const void *vertices = scene_vertices(scene);
+    const void *indices = scene_indices(scene);
+    const SceneMesh *meshes = scene_meshes(scene);
 
     if (!vertices || vertex_count == 0) {
         SDL_Log("engine_upload_scene: no vertices");
@@ -363,12 +628,38 @@ bool engine_upload_scene(Engine *engine, const Scene *scene) {
         return false;
     }
 
-    SDL_Log("Uploading scene: %u vertices, %u indices", vertex_count, index_count);
+    // Meshes are drawn from a copy of the table, so the scene can be freed
+    // after uploading
+    free(engine->meshes);
+    engine->meshes = (SceneMesh *)malloc(sizeof(SceneMesh) * header->mesh_count);
+    if (!engine->meshes) {
+        SDL_Log("engine_upload_scene: failed to allocate mesh table");
+        engine->mesh_count = 0;
+        return false;
+    }
+    SDL_memcpy(engine->meshes, meshes, sizeof(SceneMesh) * header->mesh_count);
+    engine->mesh_count = header->mesh_count;
+
+    SDL_Log("Uploading scene: %u vertices, %u indices, %u meshes", vertex_count, index_count,
+            header->mesh_count);
+
+    // Create vertex buffer. Packed vertices are followed by the bounds of
+    // each mesh.
+    bool packed = header->vertex_format == SCENE_VERTEX_PACKED;
+    uint64_t vertex_buffer_size = header->vertex_size;
+    if (packed) {
+        vertex_buffer_size += sizeof(MeshBounds) * header->mesh_count;
+    }
+    if (vertex_buffer_size > UINT32_MAX) {
+        SDL_Log("engine_upload_scene: vertex data too large (%llu bytes)", (unsigned long long)vertex_buffer_size);
+        return false;
+    }
+    engine->vertex_format = header->vertex_format;
+    engine->mesh_bounds_offset = (uint32_t)header->vertex_size;
 
-    // Create vertex buffer
     SDL_GPUBufferCreateInfo vertex_buffer_info = {
         .usage = SDL_GPU_BUFFERUSAGE_VERTEX,
-        .size = sizeof(SceneVertex) * vertex_count,
+        .size = (Uint32)vertex_buffer_size,
     };
     engine->vertex_buffer = SDL_CreateGPUBuffer(engine->device, &vertex_buffer_info);
     if (!engine->vertex_buffer) {
@@ -379,7 +670,7 @@ bool engine_upload_scene(Engine *engine, const Scene *scene) {
     // Create index buffer
     SDL_GPUBufferCreateInfo index_buffer_info = {
         .usage = SDL_GPU_BUFFERUSAGE_INDEX,
-        .size = sizeof(uint16_t) * index_count,
+        .size = (Uint32)header->index_size,
     };
     engine->index_buffer = SDL_CreateGPUBuffer(engine->device, &index_buffer_info);
     if (!engine->index_buffer) {
@@ -430,7 +721,19 @@ bool engine_upload_scene(Engine *engine, const Scene *scene) {
         engine->index_buffer = NULL;
         return false;
     }
-    SDL_memcpy(mapped_vertices, vertices, vertex_buffer_info.size);
+    SDL_memcpy(mapped_vertices, vertices, (size_t)header->vertex_size);
+    if (packed) {
+        MeshBounds *bounds = (MeshBounds *)((uint8_t *)mapped_vertices + header->vertex_size);
+        for (uint32_t i = 0; i < header->mesh_count; i++) {
+            const SceneMesh *mesh = &meshes[i];
+            for (int axis = 0; axis < 3; axis++) {
+                bounds[i].min[axis] = mesh->bounds_min[axis];
+                bounds[i].extent[axis] = mesh->bounds_max[axis] - mesh->bounds_min[axis];
+            }
+            bounds[i].min[3] = 0.0f;
+            bounds[i].extent[3] = 0.0f;
+        }
+    }
     SDL_UnmapGPUTransferBuffer(engine->device, engine->vertex_transfer_buffer);
 
     // Map and copy index data
@@ -481,13 +784,37 @@ bool engine_upload_scene(Engine *engine, const Scene *scene) {
     return true;
 }
 
-bool engine_load_textures(Engine *engine, const Scene *scene) {
+// Decodes the image at `path`, from the copy in `bundle` if there is one.
+// The WASM IMG_Load_IO only decodes by path, and WASM reads bundled files
+// through the JS file system anyway.
+static SDL_Surface *load_image(const Bundle *bundle, const char *path) {
+#if !defined(__wasm__)
+    if (bundle) {
+        Scratch scratch = scratch_begin();
+        string content;
+        string key = str_from_cstr_len_view_const(path, base_strlen(path));
+        if (bundle_read(bundle, scratch.arena, key, &content)) {
+            SDL_Surface *surface = IMG_Load_IO(SDL_IOFromConstMem(content.str, content.size), true);
+            scratch_end(scratch);
+            return surface;
+        }
+        scratch_end(scratch);
+    }
+#else
+    (void)bundle;
+#endif
+    return IMG_Load(path);
+}
+
+bool engine_load_textures(Engine *engine, const Scene *scene, const Bundle *bundle) {
+    PROFILE_ZONE("engine_load_textures");
     if (!engine || !scene) {
         SDL_Log("engine_load_textures: NULL parameter");
         return false;
     }
 
     const SceneHeader *header = scene->header;
+    const SceneTexture *textures = scene_textures(scene);
     uint32_t texture_count = header->texture_count;
     SDL_Log("Loading %u textures", texture_count);
 
@@ -495,6 +822,10 @@ bool engine_load_textures(Engine *engine, const Scene *scene) {
         SDL_Log("No textures to load");
         return true;
     }
+    if (!textures) {
+        SDL_Log("engine_load_textures: texture table is corrupt");
+        return false;
+    }
 
     if (texture_count > 8) {
         SDL_Log("Warning: scene has %u textures, but engine only supports 8", texture_count);
@@ -503,15 +834,15 @@ bool engine_load_textures(Engine *engine, const Scene *scene) {
 
     // Load each texture
     for (uint32_t i = 0; i < texture_count; i++) {
-        uint32_t surface_type_id = header->textures[i].surface_type_id;
+        uint32_t surface_type_id = textures[i].surface_type_id;
         int binding_slot = map_surface_type_to_slot(surface_type_id);
         if (binding_slot < 0 || binding_slot >= 8) {
             SDL_Log("Warning: texture %u has unsupported surface_type_id %u, skipping", i, surface_type_id);
             continue;
         }
 
-        const char *path = (const char *)(uintptr_t)header->textures[i].path_offset;
-        if (!path || path[0] == '\0') {
+        const char *path = scene_texture_path(scene, i);
+        if (path[0] == '\0') {
             SDL_Log("Warning: texture %u has empty path, skipping", i);
             continue;
         }
@@ -519,7 +850,7 @@ bool engine_load_textures(Engine *engine, const Scene *scene) {
         SDL_Log("Loading texture %u (surface_type=%u -> slot %d) from %s", i, surface_type_id, binding_slot, path);
 
         // Load texture using SDL_image
-        SDL_Surface *surface = IMG_Load(path);
+        SDL_Surface *surface = load_image(bundle, path);
         if (!surface) {
             SDL_Log("Failed to load texture %s: %s", path, SDL_GetError());
             continue; // Skip this texture but continue with others
@@ -661,19 +992,13 @@ bool engine_render(Engine *engine, SDL_GPUCommandBuffer *cmdbuf, SDL_GPURenderPa
         return false;
     }
 
-    // Bind vertex buffer
-    SDL_GPUBufferBinding vertex_binding = {
-        .buffer = engine->vertex_buffer,
-        .offset = 0,
+    // Bind vertex buffer, and the mesh bounds of packed vertices
+    SDL_GPUBufferBinding vertex_bindings[2] = {
+        {.buffer = engine->vertex_buffer, .offset = 0},
+        {.buffer = engine->vertex_buffer, .offset = engine->mesh_bounds_offset},
     };
-    SDL_BindGPUVertexBuffers(render_pass, 0, &vertex_binding, 1);
-
-    // Bind index buffer
-    SDL_GPUBufferBinding index_binding = {
-        .buffer = engine->index_buffer,
-        .offset = 0,
-    };
-    SDL_BindGPUIndexBuffer(render_pass, &index_binding, SDL_GPU_INDEXELEMENTSIZE_16BIT);
+    bool packed = engine->vertex_format == SCENE_VERTEX_PACKED;
+    SDL_BindGPUVertexBuffers(render_pass, 0, vertex_bindings, packed ? 2 : 1);
 
     // Bind textures and samplers (slots 0-7)
     // Bind textures 0-6 plus shared sampler at slot 7 (matches WGSL layout).
@@ -703,8 +1028,25 @@ bool engine_render(Engine *engine, SDL_GPUCommandBuffer *cmdbuf, SDL_GPURenderPa
         SDL_PushGPUFragmentUniformData(cmdbuf, 0, uniforms, uniform_size);
     }
 
-    // Draw indexed
-    SDL_DrawGPUIndexedPrimitives(render_pass, engine->index_count, 1, 0, 0, 0);
+    // Draw each mesh. Its indices count from its first vertex, and the index
+    // buffer is only rebound when the index size changes.
+    uint32_t bound_index_size = 0;
+    for (uint32_t i = 0; i < engine->mesh_count; i++) {
+        const SceneMesh *mesh = &engine->meshes[i];
+        if (mesh->index_size != bound_index_size) {
+            SDL_GPUBufferBinding index_binding = {
+                .buffer = engine->index_buffer,
+                .offset = 0,
+            };
+            SDL_BindGPUIndexBuffer(render_pass, &index_binding,
+                                   mesh->index_size == SCENE_INDEX_16 ? SDL_GPU_INDEXELEMENTSIZE_16BIT
+                                                                       : SDL_GPU_INDEXELEMENTSIZE_32BIT);
+            bound_index_size = mesh->index_size;
+        }
+        SDL_DrawGPUIndexedPrimitives(render_pass, mesh->index_count, 1,
+                                     (Uint32)(mesh->index_offset / mesh->index_size),
+                                     (Sint32)mesh->first_vertex, packed ? i : 0);
+    }
 
     return true;
 }
@@ -726,6 +1068,8 @@ void engine_free(Engine *engine) {
         SDL_ReleaseGPUTransferBuffer(engine->device, engine->index_transfer_buffer);
     }
 
+    free(engine->meshes);
+
     // Release textures and samplers
     for (int i = 0; i < 8; i++) {
         if (engine->textures[i]) {
@@ -10,6 +10,7 @@
 
 #include "scene_format.h"
 #include "sdl_compat.h"
+#include "base/bundle.h"
 #include <SDL3/SDL.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -23,12 +24,33 @@ typedef struct Scene Scene;
 // mmap_handle: opaque handle returned by platform_read_file_mmap (0 if not mapped)
 Scene* scene_load_from_memory(void *blob, uint64_t blob_size, bool use_mmap, uint64_t mmap_handle);
 
-// Load scene from file (uses mmap for zero-copy)
+// Load scene from file (mapped read-only for zero-copy)
 Scene* scene_load_from_file(const char *path);
 
-// Access scene header (owns pointers to all buffers after fixup)
+// Access scene header (counts and sizes; its sections are read through the
+// accessors below)
 const SceneHeader* scene_get_header(const Scene *scene);
 
+// Sections of the scene, resolved from the offsets in its header on each
+// call, as the blob is never written. NULL if the section is empty or does
+// not match its checksum, which is verified on first access.
+const void* scene_vertices(const Scene *scene);  // See SceneHeader.vertex_format
+const void* scene_indices(const Scene *scene);
+const SceneLight* scene_lights(const Scene *scene);
+const SceneTexture* scene_textures(const Scene *scene);
+const SceneMesh* scene_meshes(const Scene *scene);
+
+// Path of texture `texture`, or "" if its path_offset is out of bounds
+const char* scene_texture_path(const Scene *scene, uint32_t texture);
+
+// Verifies every section now rather than on first access. Returns false if
+// any is corrupt. Scenes before version 3 have no checksums and pass.
+bool scene_verify(const Scene *scene);
+
+// Decodes vertex `index` of `scene`, which belongs to `mesh` (whose bounds
+// packed positions are relative to; unused for SCENE_VERTEX_FLOAT)
+void scene_unpack_vertex(const Scene *scene, const SceneMesh *mesh, uint32_t index, SceneVertex *out);
+
 // Free scene (munmap or free blob, free Scene struct)
 void scene_free(Scene *scene);
 
@@ -41,8 +63,9 @@ Engine* engine_create(SDL_GPUDevice *device);
 // Upload scene data to GPU buffers
 bool engine_upload_scene(Engine *engine, const Scene *scene);
 
-// Load textures from scene texture paths
-bool engine_load_textures(Engine *engine, const Scene *scene);
+// Load textures from scene texture paths, looked up in `bundle` first (may
+// be NULL)
+bool engine_load_textures(Engine *engine, const Scene *scene, const Bundle *bundle);
 
 // Render the scene with given uniforms
 // uniforms should be a pointer to SceneUniforms (from game.c)
@@ -22,11 +22,15 @@
 #include <base/arena.h>
 #include <base/buddy.h>
 #include <base/scratch.h>
+#include <base/jobs.h>
+#include <base/profile.h>
 #include <base/mem.h>
 #include <base/mat4.h>
 #include <base/base_math.h>
 #include <base/base_string.h>
 #include <base/io.h>
+#include <base/bundle.h>
+#include <base/hash.h>
 #include <platform/platform.h>
 #include <base/base_io.h>
 
@@ -84,7 +88,7 @@ typedef struct {
     float *normals;
     float *surface_types;
     float *triangle_ids;
-    uint16_t *indices;
+    uint32_t *indices;
     uint32_t position_count;
     uint32_t uv_count;
     uint32_t normal_count;
@@ -216,6 +220,7 @@ typedef struct {
 
     bool quit_requested;
     SDL_GPUShaderFormat shader_format;
+    uint32_t scene_vertex_format;  // SCENE_VERTEX_* the scene vertex shader reads
     char scene_vertex_path[256];
     char scene_fragment_path[256];
     char overlay_vertex_path[256];
@@ -233,6 +238,10 @@ typedef struct {
 
 static GameApp g_App;
 static Arena *g_shader_arena = NULL;
+static Bundle g_asset_bundle = {0};
+
+// Written by `pixi run bundle_shaders`, holds the shaders and assets below
+#define ASSET_BUNDLE_PATH "shaders.bundle"
 
 #define FLOOR_TEXTURE_PATH "assets/WoodFloor007_1K-JPG_Color.jpg"
 #define WALL_TEXTURE_PATH "assets/Concrete046_1K-JPG_Color.jpg"
@@ -248,6 +257,12 @@ static Arena *g_shader_arena = NULL;
 #define CEILING_LIGHT_MODEL_SCALE 0.5f
 #define CEILING_LIGHT_SURFACE_TYPE 7.0f
 
+// Where init_game keeps the built scene between runs. The WASM file system
+// does not persist, so the WASM build always builds the scene.
+#define SCENE_CACHE_PATH "scene_cache.scn"
+// A new cache is written here first, then renamed over SCENE_CACHE_PATH
+#define SCENE_CACHE_TMP_PATH SCENE_CACHE_PATH ".tmp"
+
 static string g_scene_vertex_shader = {0};
 static string g_scene_fragment_shader = {0};
 static string g_overlay_vertex_shader = {0};
@@ -263,11 +278,35 @@ static void ensure_runtime_heap(void) {
     }
 }
 
+// Shaders and textures are read from the asset bundle when there is one, so
+// startup maps one file instead of opening each asset. Returns NULL without
+// a bundle (the WASM build gets the bundled files from the JS file system).
+static const Bundle *asset_bundle(void) {
+    static bool opened = false;
+    if (!opened) {
+        opened = true;
+        ensure_runtime_heap();
+        if (bundle_open(g_shader_arena, str_lit(ASSET_BUNDLE_PATH), &g_asset_bundle)) {
+            SDL_Log("Using asset bundle %s", ASSET_BUNDLE_PATH);
+        }
+    }
+    return g_asset_bundle.data ? &g_asset_bundle : NULL;
+}
+
+// Returns the shader source without a terminator
 static string load_shader_source(string *cache, const char *path_literal) {
     if (cache->str == NULL) {
         ensure_runtime_heap();
         string path = str_from_cstr_len_view_const(path_literal, base_strlen(path_literal));
-        *cache = read_file_ok(g_shader_arena, path);
+        const Bundle *bundle = asset_bundle();
+        if (bundle && bundle_read(bundle, g_shader_arena, path, cache)) {
+            return *cache;
+        }
+        // Shader sources are cached for the lifetime of the app, so the
+        // mapping (if any) is intentionally never released.
+        uint64_t handle;
+        *cache = read_file_view_ok(g_shader_arena, path, &handle);
+        cache->size--;
     }
     return *cache;
 }
@@ -382,13 +421,6 @@ static SDL_GPUTexture *load_texture_from_path(GameApp *app, const char *path, co
     return texture;
 }
 
-static Uint32 shader_code_size(string source) {
-    if (source.size == 0) {
-        return 0;
-    }
-    return (Uint32)(source.size - 1);
-}
-
 
 static inline float clamp_pitch(float pitch) {
     const float max_pitch = PI / 2.0f - 0.01f;
@@ -716,6 +748,50 @@ static int find_start_position(int *map, int width, int height,
     return 0;
 }
 
+// Initializes g_map_data from the default map and takes the start position
+// out of it (light markers are left for scene_builder)
+static void init_scene_map(float *out_spawn_x, float *out_spawn_z, float *out_spawn_yaw) {
+    for (int z = 0; z < MAP_HEIGHT; z++) {
+        for (int x = 0; x < MAP_WIDTH; x++) {
+            g_map_data[z * MAP_WIDTH + x] = g_default_map[z][x];
+        }
+    }
+
+    *out_spawn_x = 1.5f;
+    *out_spawn_z = 1.5f;
+    *out_spawn_yaw = 0.0f;
+    find_start_position(g_map_data, MAP_WIDTH, MAP_HEIGHT, out_spawn_x, out_spawn_z, out_spawn_yaw);
+}
+
+// Identifies everything build_scene_blob builds from, so that a cached scene
+// built from anything else is rebuilt: the scene format and builder versions,
+// the map, the vertex format, and the path, size and modification time of
+// each asset. Call after init_scene_map.
+static uint64_t scene_source_key(const GameApp *app) {
+    static const char *const paths[] = {
+        SPHERE_OBJ_PATH, BOOK_OBJ_PATH, CHAIR_OBJ_PATH, CEILING_LIGHT_MODEL_PATH,
+        FLOOR_TEXTURE_PATH, WALL_TEXTURE_PATH, CEILING_TEXTURE_PATH, SPHERE_TEXTURE_PATH,
+        BOOK_TEXTURE_PATH, CHAIR_TEXTURE_PATH, WINDOW_TEXTURE_PATH,
+    };
+    const uint32_t versions[2] = {SCENE_VERSION, SCENE_BUILDER_VERSION};
+    uint64_t key = hash64(versions, sizeof(versions), 0);
+    key = hash64(g_map_data, sizeof(g_map_data), key);
+    key = hash64(&app->scene_vertex_format, sizeof(app->scene_vertex_format), key);
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        size_t length = base_strlen(paths[i]);
+        filestat_t stat = {0};
+        wasi_fd_t fd = wasi_path_open(paths[i], length, WASI_RIGHTS_READ, 0);
+        if (fd >= 0) {
+            wasi_fd_filestat_get(fd, &stat);
+            wasi_fd_close(fd);
+        }
+        key = hash64(paths[i], length, key);
+        key = hash64(&stat.size, sizeof(stat.size), key);
+        key = hash64(&stat.mtim, sizeof(stat.mtim), key);
+    }
+    return key;
+}
+
 // Build a scene blob using scene_builder (shared by runtime and export paths).
 // On success, returns heap-owned blob (caller frees via scene_free) and spawn info.
 static bool build_scene_blob(GameApp *app,
@@ -726,17 +802,8 @@ static bool build_scene_blob(GameApp *app,
         return false;
     }
 
-    // Initialize map data from default map (leave light markers for scene_builder)
-    for (int z = 0; z < MAP_HEIGHT; z++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            g_map_data[z * MAP_WIDTH + x] = g_default_map[z][x];
-        }
-    }
-
-    float spawn_x = 1.5f;
-    float spawn_z = 1.5f;
-    float spawn_yaw = 0.0f;
-    find_start_position(g_map_data, MAP_WIDTH, MAP_HEIGHT, &spawn_x, &spawn_z, &spawn_yaw);
+    float spawn_x, spawn_z, spawn_yaw;
+    init_scene_map(&spawn_x, &spawn_z, &spawn_yaw);
 
     Arena *scene_arena = arena_new(8 * 1024 * 1024);
     SceneBuilder *builder = scene_builder_create(scene_arena);
@@ -759,6 +826,8 @@ static bool build_scene_blob(GameApp *app,
     config.chair_texture_path = CHAIR_TEXTURE_PATH;
     config.window_texture_path = WINDOW_TEXTURE_PATH;
     config.ceiling_light_texture_path = CHAIR_TEXTURE_PATH;
+    config.vertex_format = app->scene_vertex_format;
+    config.source_key = scene_source_key(app);
 
     bool ok = scene_builder_generate(builder, &config);
     if (!ok) {
@@ -801,14 +870,17 @@ static bool build_scene_blob(GameApp *app,
 // OBJ export functions
 // ============================================================================
 
-// Helper: copy SceneHeader data into a temporary MeshData view (SoA arrays).
-static bool build_mesh_view_from_scene(const SceneHeader *scene, Scratch scratch, MeshData *out) {
+// Helper: copy scene data into a temporary MeshData view (SoA arrays).
+static bool build_mesh_view_from_scene(const Scene *scene, Scratch scratch, MeshData *out) {
     if (!scene || !out) {
         return false;
     }
 
-    uint32_t vertex_count = scene->vertex_count;
-    uint32_t index_count = scene->index_count;
+    const SceneHeader *header = scene_get_header(scene);
+    const SceneMesh *meshes = scene_meshes(scene);
+    const void *indices = scene_indices(scene);
+    uint32_t vertex_count = header->vertex_count;
+    uint32_t index_count = header->index_count;
 
     out->vertex_count = vertex_count;
     out->index_count = index_count;
@@ -821,27 +893,47 @@ static bool build_mesh_view_from_scene(const SceneHeader *scene, Scratch scratch
     out->normals = (float *)arena_alloc(scratch.arena, sizeof(float) * vertex_count * 3);
     out->surface_types = (float *)arena_alloc(scratch.arena, sizeof(float) * vertex_count);
     out->triangle_ids = NULL;
-    out->indices = (uint16_t *)scene->indices;
+    out->indices = (uint32_t *)arena_alloc(scratch.arena, sizeof(uint32_t) * index_count);
 
-    if (!out->positions || !out->uvs || !out->normals || !out->surface_types) {
+    if (!out->positions || !out->uvs || !out->normals || !out->surface_types || !out->indices) {
         SDL_Log("build_mesh_view_from_scene: allocation failed");
         return false;
     }
 
-    const SceneVertex *verts = scene->vertices;
-    for (uint32_t i = 0; i < vertex_count; i++) {
-        out->positions[i * 3 + 0] = verts[i].position[0];
-        out->positions[i * 3 + 1] = verts[i].position[1];
-        out->positions[i * 3 + 2] = verts[i].position[2];
+    // Vertices are decoded per mesh, as packed ones are relative to its
+    // bounds. Vertices outside every mesh are never drawn and stay zero.
+    base_memset(out->positions, 0, sizeof(float) * vertex_count * 3);
+    base_memset(out->uvs, 0, sizeof(float) * vertex_count * 2);
+    base_memset(out->normals, 0, sizeof(float) * vertex_count * 3);
+    base_memset(out->surface_types, 0, sizeof(float) * vertex_count);
+    for (uint32_t m = 0; m < header->mesh_count; m++) {
+        const SceneMesh *mesh = &meshes[m];
+        for (uint32_t i = mesh->first_vertex; i < mesh->first_vertex + mesh->vertex_count; i++) {
+            SceneVertex vert;
+            scene_unpack_vertex(scene, mesh, i, &vert);
+
+            out->positions[i * 3 + 0] = vert.position[0];
+            out->positions[i * 3 + 1] = vert.position[1];
+            out->positions[i * 3 + 2] = vert.position[2];
 
-        out->uvs[i * 2 + 0] = verts[i].uv[0];
-        out->uvs[i * 2 + 1] = verts[i].uv[1];
+            out->uvs[i * 2 + 0] = vert.uv[0];
+            out->uvs[i * 2 + 1] = vert.uv[1];
 
-        out->normals[i * 3 + 0] = verts[i].normal[0];
-        out->normals[i * 3 + 1] = verts[i].normal[1];
-        out->normals[i * 3 + 2] = verts[i].normal[2];
+            out->normals[i * 3 + 0] = vert.normal[0];
+            out->normals[i * 3 + 1] = vert.normal[1];
+            out->normals[i * 3 + 2] = vert.normal[2];
 
-        out->surface_types[i] = verts[i].surface_type;
+            out->surface_types[i] = vert.surface_type;
+        }
+    }
+
+    // Indices of all meshes, as indices into all the vertices
+    uint32_t index = 0;
+    for (uint32_t m = 0; m < header->mesh_count; m++) {
+        const SceneMesh *mesh = &meshes[m];
+        for (uint32_t i = 0; i < mesh->index_count; i++) {
+            out->indices[index++] = scene_mesh_index(indices, mesh, i);
+        }
     }
 
     return true;
@@ -1129,19 +1221,20 @@ static bool write_geometry_usd(const char *filename, const char *mesh_name,
 }
 
 // Export mesh and scene to USD file
-static bool export_to_usd(GameApp *app, const SceneHeader *scene, const char *filename,
+static bool export_to_usd(GameApp *app, const Scene *scene, const char *filename,
                           float camera_x, float camera_y, float camera_z,
                           float camera_yaw, float camera_pitch) {
     if (!scene || !filename || !app) {
         SDL_Log("export_to_usd: invalid arguments");
         return false;
     }
+    const SceneHeader *header = scene_get_header(scene);
 
     SDL_Log("Exporting scene to USD: %s", filename);
     SDL_Log("Camera: pos(%.2f,%.2f,%.2f) yaw=%.2f pitch=%.2f",
             camera_x, camera_y, camera_z, camera_yaw, camera_pitch);
     SDL_Log("Mesh data: vertices=%u indices=%u",
-            scene->vertex_count, scene->index_count);
+            header->vertex_count, header->index_count);
 
     Scratch scratch = scratch_begin();
     ensure_runtime_heap();
@@ -1608,8 +1701,8 @@ static bool export_to_usd(GameApp *app, const SceneHeader *scene, const char *fi
     }
 
     // === Static lights ===
-    const uint32_t static_light_count = scene->light_count;
-    const SceneLight *static_lights = scene->lights;
+    const uint32_t static_light_count = header->light_count;
+    const SceneLight *static_lights = scene_lights(scene);
     for (uint32_t i = 0; i < static_light_count; i++) {
         const SceneLight *light = &static_lights[i];
 
@@ -1807,7 +1900,7 @@ static bool save_state_to_json(const GameState *state, const char *filename) {
 }
 
 // Export mesh to OBJ file
-static bool export_mesh_to_obj(const SceneHeader *scene, const char *filename) {
+static bool export_mesh_to_obj(const Scene *scene, const char *filename) {
     Scratch scratch = scratch_begin();
     if (!scene || !filename) {
         SDL_Log("export_mesh_to_obj: invalid arguments");
@@ -1935,9 +2028,9 @@ static bool export_mesh_to_obj(const SceneHeader *scene, const char *filename) {
     for (int i = 0; use_floor[i]; i++) obj_buffer[pos++] = use_floor[i];
 
     for (uint32_t i = 0; i < mesh->index_count && pos < (int)estimated_size - 300; i += 3) {
-        uint16_t i0 = mesh->indices[i + 0];
-        uint16_t i1 = mesh->indices[i + 1];
-        uint16_t i2 = mesh->indices[i + 2];
+        uint32_t i0 = mesh->indices[i + 0];
+        uint32_t i1 = mesh->indices[i + 1];
+        uint32_t i2 = mesh->indices[i + 2];
 
         // Check if this face is floor
         float st0 = mesh->surface_types[i0];
@@ -1989,9 +2082,9 @@ static bool export_mesh_to_obj(const SceneHeader *scene, const char *filename) {
     for (int i = 0; use_wall[i]; i++) obj_buffer[pos++] = use_wall[i];
 
     for (uint32_t i = 0; i < mesh->index_count && pos < (int)estimated_size - 300; i += 3) {
-        uint16_t i0 = mesh->indices[i + 0];
-        uint16_t i1 = mesh->indices[i + 1];
-        uint16_t i2 = mesh->indices[i + 2];
+        uint32_t i0 = mesh->indices[i + 0];
+        uint32_t i1 = mesh->indices[i + 1];
+        uint32_t i2 = mesh->indices[i + 2];
 
         float st0 = mesh->surface_types[i0];
         if (st0 >= 0.5f && st0 < 1.5f) {  // wall
@@ -2039,9 +2132,9 @@ static bool export_mesh_to_obj(const SceneHeader *scene, const char *filename) {
     for (int i = 0; use_ceiling[i]; i++) obj_buffer[pos++] = use_ceiling[i];
 
     for (uint32_t i = 0; i < mesh->index_count && pos < (int)estimated_size - 300; i += 3) {
-        uint16_t i0 = mesh->indices[i + 0];
-        uint16_t i1 = mesh->indices[i + 1];
-        uint16_t i2 = mesh->indices[i + 2];
+        uint32_t i0 = mesh->indices[i + 0];
+        uint32_t i1 = mesh->indices[i + 1];
+        uint32_t i2 = mesh->indices[i + 2];
 
         float st0 = mesh->surface_types[i0];
         if (st0 >= 1.5f) {  // ceiling
@@ -2271,6 +2364,7 @@ static const char *direction_from_yaw(float yaw) {
 }
 
 static void build_overlay(GameApp *app) {
+    PROFILE_ZONE("build_overlay");
     GameState *state = &app->state;
     app->overlay_vertex_count = 0;
 
@@ -2439,12 +2533,33 @@ static bool create_scene_pipeline(GameApp *app, SDL_GPUShader *vertex_shader, SD
         .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
     };
 
+    // Packed vertices are read as four words, with the bounds of their mesh
+    // as per-instance data (see engine_render)
+    SDL_GPUVertexAttribute packed_attributes[] = {
+        {.location = 0, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_UINT4, .offset = 0},
+        {.location = 1, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = 0},
+        {.location = 2, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = sizeof(float) * 4},
+    };
+
+    SDL_GPUVertexBufferDescription packed_buffer_descs[] = {
+        {.slot = 0, .pitch = sizeof(ScenePackedVertex), .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX},
+        {.slot = 1, .pitch = sizeof(float) * 8, .input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE},
+    };
+
     SDL_GPUVertexInputState vertex_state = {
         .vertex_buffer_descriptions = &buffer_desc,
         .num_vertex_buffers = 1,
         .vertex_attributes = attributes,
         .num_vertex_attributes = SDL_arraysize(attributes),
     };
+    if (app->scene_vertex_format == SCENE_VERTEX_PACKED) {
+        vertex_state = (SDL_GPUVertexInputState){
+            .vertex_buffer_descriptions = packed_buffer_descs,
+            .num_vertex_buffers = SDL_arraysize(packed_buffer_descs),
+            .vertex_attributes = packed_attributes,
+            .num_vertex_attributes = SDL_arraysize(packed_attributes),
+        };
+    }
 
     SDL_GPUDepthStencilState depth_state = {
         .enable_depth_test = true,
@@ -2517,6 +2632,44 @@ static bool create_overlay_pipeline(GameApp *app, SDL_GPUShader *vertex_shader,
     return app->overlay_pipeline != NULL;
 }
 
+// Maps the scene cached by a previous run if it was built from the same
+// inputs and passes its checksums, so warm starts skip building it.
+// Otherwise builds the scene and caches it for the next run.
+static Scene *load_or_build_scene(GameApp *app, float *spawn_x, float *spawn_z, float *spawn_yaw) {
+#if !defined(__wasm__)
+    init_scene_map(spawn_x, spawn_z, spawn_yaw);
+    uint64_t source_key = scene_source_key(app);
+    Scene *cached = scene_load_from_file(SCENE_CACHE_PATH);
+    if (cached) {
+        const SceneHeader *header = scene_get_header(cached);
+        if (header->version == SCENE_VERSION && header->source_key == source_key && scene_verify(cached)) {
+            SDL_Log("Using cached scene %s", SCENE_CACHE_PATH);
+            return cached;
+        }
+        SDL_Log("Cached scene %s is out of date or corrupt, rebuilding it", SCENE_CACHE_PATH);
+        scene_free(cached);
+    }
+#endif
+
+    uint8_t *blob = NULL;
+    uint64_t blob_size = 0;
+    if (!build_scene_blob(app, &blob, &blob_size, spawn_x, spawn_z, spawn_yaw)) {
+        return NULL;
+    }
+#if !defined(__wasm__)
+    // Another running game may have the old cache mapped. Truncating it in
+    // place would make that game fault (SIGBUS) on its next read, while the
+    // rename leaves it the old file.
+    if (write_string_to_file(SCENE_CACHE_TMP_PATH, (const char *)blob, (size_t)blob_size) &&
+        wasi_path_rename(SCENE_CACHE_TMP_PATH, base_strlen(SCENE_CACHE_TMP_PATH),
+                         SCENE_CACHE_PATH, base_strlen(SCENE_CACHE_PATH)) != 0) {
+        SDL_Log("Failed to replace %s", SCENE_CACHE_PATH);
+    }
+#endif
+    // Takes ownership of the blob, and frees it if it is invalid
+    return scene_load_from_memory(blob, blob_size, false, 0);
+}
+
 static int complete_gpu_setup(GameApp *app) {
     if (app->device == NULL || app->window == NULL) {
         SDL_Log("GPU setup requires valid device and window");
@@ -2543,7 +2696,7 @@ static int complete_gpu_setup(GameApp *app) {
     SDL_Log("Loaded scene vertex shader: %llu bytes from %s", scene_vs_code.size, app->scene_vertex_path);
     SDL_GPUShaderCreateInfo shader_info = {
         .code = (const Uint8 *)scene_vs_code.str,
-        .code_size = shader_code_size(scene_vs_code),
+        .code_size = (Uint32)scene_vs_code.size,
         .entrypoint = shader_entrypoint,
         .format = app->shader_format,
         .stage = SDL_GPU_SHADERSTAGE_VERTEX,
@@ -2562,7 +2715,7 @@ static int complete_gpu_setup(GameApp *app) {
 
     string scene_fs_code = load_shader_source(&g_scene_fragment_shader, app->scene_fragment_path);
     shader_info.code = (const Uint8 *)scene_fs_code.str;
-    shader_info.code_size = shader_code_size(scene_fs_code);
+    shader_info.code_size = (Uint32)scene_fs_code.size;
     shader_info.entrypoint = shader_entrypoint;
     shader_info.stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
     shader_info.num_samplers = 8;  // 7 textures + 1 sampler in set 2 = 8 bindings
@@ -2578,7 +2731,7 @@ static int complete_gpu_setup(GameApp *app) {
 
     string overlay_vs_code = load_shader_source(&g_overlay_vertex_shader, app->overlay_vertex_path);
     shader_info.code = (const Uint8 *)overlay_vs_code.str;
-    shader_info.code_size = shader_code_size(overlay_vs_code);
+    shader_info.code_size = (Uint32)overlay_vs_code.size;
     shader_info.entrypoint = shader_entrypoint;
     shader_info.stage = SDL_GPU_SHADERSTAGE_VERTEX;
     shader_info.num_samplers = 0;
@@ -2593,7 +2746,7 @@ static int complete_gpu_setup(GameApp *app) {
 
     string overlay_fs_code = load_shader_source(&g_overlay_fragment_shader, app->overlay_fragment_path);
     shader_info.code = (const Uint8 *)overlay_fs_code.str;
-    shader_info.code_size = shader_code_size(overlay_fs_code);
+    shader_info.code_size = (Uint32)overlay_fs_code.size;
     shader_info.entrypoint = shader_entrypoint;
     shader_info.stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
     shader_info.num_samplers = 0;
@@ -2630,18 +2783,10 @@ static int complete_gpu_setup(GameApp *app) {
     SDL_ReleaseGPUShader(app->device, overlay_vs);
     SDL_ReleaseGPUShader(app->device, overlay_fs);
 
-    uint8_t *scene_blob = NULL;
-    uint64_t scene_blob_size = 0;
     float spawn_x = 0.0f, spawn_z = 0.0f, spawn_yaw = 0.0f;
-    if (!build_scene_blob(app, &scene_blob, &scene_blob_size, &spawn_x, &spawn_z, &spawn_yaw)) {
-        return -1;
-    }
-
-    // Load scene from blob (engine will free owned_blob on shutdown)
-    app->scene = scene_load_from_memory(scene_blob, scene_blob_size, false, 0);
+    app->scene = load_or_build_scene(app, &spawn_x, &spawn_z, &spawn_yaw);
     if (!app->scene) {
         SDL_Log("Failed to load scene");
-        free(scene_blob);
         return -1;
     }
 
@@ -2664,7 +2809,7 @@ static int complete_gpu_setup(GameApp *app) {
     }
 
     // Load textures
-    if (!engine_load_textures(app->engine, app->scene)) {
+    if (!engine_load_textures(app->engine, app->scene, asset_bundle())) {
         SDL_Log("Failed to load textures");
         engine_free(app->engine);
         scene_free(app->scene);
@@ -2780,8 +2925,12 @@ static int init_game(GameApp *app) {
         shader_ext = ".dxil";
 #if defined(__wasi__)
     } else if (base_strcmp(driver, "wgsl") == 0) {
+        // WGSL is compiled from source at runtime, so it has the packed
+        // vertex shader; the other formats are generated by
+        // scripts/compile_shaders.sh.
         shader_dir = "shaders/WGSL/";
         app->shader_format = SDL_GPU_SHADERFORMAT_WGSL;
+        app->scene_vertex_format = SCENE_VERTEX_PACKED;
         shader_ext = ".wgsl";
 #endif
     } else {
@@ -2791,8 +2940,10 @@ static int init_game(GameApp *app) {
 
     SDL_Log("Using %s backend, loading shaders from %s", driver, shader_dir);
 
-    SDL_snprintf(app->scene_vertex_path, sizeof(app->scene_vertex_path),
-                 "%smousecircle_scene_vertex%s", shader_dir, shader_ext);
+    SDL_snprintf(app->scene_vertex_path, sizeof(app->scene_vertex_path), "%s%s%s", shader_dir,
+                 app->scene_vertex_format == SCENE_VERTEX_PACKED ? "mousecircle_scene_packed_vertex"
+                                                                : "mousecircle_scene_vertex",
+                 shader_ext);
     SDL_snprintf(app->scene_fragment_path, sizeof(app->scene_fragment_path),
                  "%smousecircle_scene_fragment%s", shader_dir, shader_ext);
     SDL_snprintf(app->overlay_vertex_path, sizeof(app->overlay_vertex_path),
@@ -2804,6 +2955,7 @@ static int init_game(GameApp *app) {
 }
 
 static void update_game(GameApp *app) {
+    PROFILE_ZONE("update_game");
     Uint32 now = SDL_GetTicks();
     if (!app->has_tick_base) {
         app->last_ticks = now;
@@ -2852,7 +3004,7 @@ static void update_game(GameApp *app) {
         const SceneHeader *scene_header = scene_get_header(app->scene);
         if (scene_header) {
             light_count = scene_header->light_count;
-            lights = scene_header->lights;
+            lights = scene_lights(app->scene);
         }
     }
     if (light_count > MAX_STATIC_LIGHTS) {
@@ -2937,6 +3089,7 @@ static void update_game(GameApp *app) {
 }
 
 static int render_game(GameApp *app) {
+    PROFILE_ZONE("render_game");
     SDL_Log("render_game: START");
     SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(app->device);
     if (!cmdbuf) {
@@ -3094,6 +3247,7 @@ static int simple_atoi(const char *str) {
 
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
     platform_init(argc, argv);
+    jobs_init(0);
 
     // Parse command-line arguments
     g_App.test_frames_max = 0;    // 0 = unlimited
@@ -3162,14 +3316,7 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
             return SDL_APP_FAILURE;
         }
 
-        const SceneHeader *header = scene_get_header(scene);
-        if (!header) {
-            SDL_Log("Failed to access scene header");
-            scene_free(scene);
-            return SDL_APP_FAILURE;
-        }
-
-        bool obj_success = export_mesh_to_obj(header, g_App.export_obj_path);
+        bool obj_success = export_mesh_to_obj(scene, g_App.export_obj_path);
         bool mtl_success = export_mtl_file(g_App.export_obj_path);
 
         scene_free(scene);
@@ -3201,13 +3348,6 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
             return SDL_APP_FAILURE;
         }
 
-        const SceneHeader *header = scene_get_header(scene);
-        if (!header) {
-            SDL_Log("Failed to access scene header");
-            scene_free(scene);
-            return SDL_APP_FAILURE;
-        }
-
         // Try to load camera position from saved state
         float camera_x = start_x;
         float camera_y = 1.7f;  // Default person height
@@ -3219,7 +3359,7 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
         // For now, use defaults
 
         // Export to USD file with scene, camera, and lights
-        bool usd_success = export_to_usd(&g_App, header, g_App.export_usd_path,
+        bool usd_success = export_to_usd(&g_App, scene, g_App.export_usd_path,
                                           camera_x, camera_y, camera_z,
                                           camera_yaw, camera_pitch);
         scene_free(scene);
@@ -3329,4 +3469,10 @@ void SDL_AppQuit(void *appstate, SDL_AppResult result) {
     if (app) {
         shutdown_game(app);
     }
+    jobs_shutdown();
+#ifdef WITH_PROFILE
+    if (profile_write_chrome_trace(str_lit("profile_trace.json"))) {
+        SDL_Log("Wrote profile to profile_trace.json");
+    }
+#endif
 }
@@ -286,7 +286,8 @@ int app_main(void) {
     // println(str_lit("Hotel to glTF converter"));
 
     // Read hotel.txt
-    string hotel_text = read_file_ok(arena, str_lit("hotel.txt"));
+    uint64_t hotel_handle;
+    string hotel_text = read_file_view_ok(arena, str_lit("hotel.txt"), &hotel_handle);
     // println(str_lit("Read hotel.txt: {} bytes"), (int64_t)hotel_text.size);
 
     // Skip the legend (first 17 lines) - start parsing from line 18
@@ -340,6 +341,7 @@ int app_main(void) {
             col++;
         }
     }
+    read_file_view_release(hotel_handle);
 
     // Estimate capacity: 24 vertices and 36 indices per cell
     uint32_t max_cells = rows * cols;
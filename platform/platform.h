@@ -101,10 +101,11 @@ typedef struct iovec_s {
 #define WASI_RIGHT_FD_WRITE  0x40  // __WASI_RIGHTS_FD_WRITE (1 << 6)
 #define WASI_RIGHT_FD_SEEK   0x4   // __WASI_RIGHTS_FD_SEEK (1 << 2)
 #define WASI_RIGHT_FD_TELL   0x20  // __WASI_RIGHTS_FD_TELL (1 << 5)
+#define WASI_RIGHT_FD_FILESTAT_GET 0x200000  // __WASI_RIGHTS_FD_FILESTAT_GET (1 << 21)
 
 // Common rights combinations
-#define WASI_RIGHTS_READ  (WASI_RIGHT_FD_READ | WASI_RIGHT_FD_SEEK | WASI_RIGHT_FD_TELL)
-#define WASI_RIGHTS_WRITE (WASI_RIGHT_FD_WRITE | WASI_RIGHT_FD_SEEK | WASI_RIGHT_FD_TELL)
+#define WASI_RIGHTS_READ  (WASI_RIGHT_FD_READ | WASI_RIGHT_FD_SEEK | WASI_RIGHT_FD_TELL | WASI_RIGHT_FD_FILESTAT_GET)
+#define WASI_RIGHTS_WRITE (WASI_RIGHT_FD_WRITE | WASI_RIGHT_FD_SEEK | WASI_RIGHT_FD_TELL | WASI_RIGHT_FD_FILESTAT_GET)
 #define WASI_RIGHTS_RDWR  (WASI_RIGHTS_READ | WASI_RIGHTS_WRITE)
 
 // File creation flags (WASI oflags - passed through directly)
@@ -127,6 +128,12 @@ typedef struct iovec_s {
 // Returns a file descriptor on success, or -1 on error.
 wasi_fd_t wasi_path_open(const char* path, size_t path_len, uint64_t rights, int oflags);
 
+// Rename a file, atomically replacing `new_path` if it exists. Processes that
+// have the replaced file open or mapped keep reading its old contents (on
+// Windows the rename fails instead while it is open).
+// Returns 0 on success, or errno on error.
+int wasi_path_rename(const char* old_path, size_t old_path_len, const char* new_path, size_t new_path_len);
+
 // Close a file descriptor.
 // Returns 0 on success, or errno on error.
 int wasi_fd_close(wasi_fd_t fd);
@@ -143,6 +150,100 @@ int wasi_fd_seek(wasi_fd_t fd, int64_t offset, int whence, uint64_t* newoffset);
 // Returns 0 on success with position in *offset, or errno on error.
 int wasi_fd_tell(wasi_fd_t fd, uint64_t* offset);
 
+// Read from a file descriptor at the given offset, without using or updating
+// the file position (on Windows the position is updated, but never used by
+// this call). Safe to call concurrently on the same fd.
+// Returns 0 on success with bytes read in *nread, or errno on error.
+int wasi_fd_pread(wasi_fd_t fd, const iovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nread);
+
+// Write to a file descriptor at the given offset, with the same file
+// position semantics as wasi_fd_pread.
+// Returns 0 on success with bytes written in *nwritten, or errno on error.
+int wasi_fd_pwrite(wasi_fd_t fd, const ciovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nwritten);
+
+// File types (WASI filetype values)
+#define WASI_FILETYPE_UNKNOWN          0
+#define WASI_FILETYPE_BLOCK_DEVICE     1
+#define WASI_FILETYPE_CHARACTER_DEVICE 2
+#define WASI_FILETYPE_DIRECTORY        3
+#define WASI_FILETYPE_REGULAR_FILE     4
+#define WASI_FILETYPE_SOCKET_DGRAM     5
+#define WASI_FILETYPE_SOCKET_STREAM    6
+#define WASI_FILETYPE_SYMBOLIC_LINK    7
+
+// File attributes (same layout as WASI's __wasi_filestat_t)
+typedef struct filestat_s {
+    uint64_t dev;       // Device ID
+    uint64_t ino;       // File serial number
+    uint8_t filetype;   // One of WASI_FILETYPE_*
+    uint64_t nlink;     // Number of hard links
+    uint64_t size;      // File size in bytes
+    uint64_t atim;      // Last access time (ns since the Unix epoch)
+    uint64_t mtim;      // Last modification time (ns since the Unix epoch)
+    uint64_t ctim;      // Last status change time (ns since the Unix epoch)
+} filestat_t;
+
+// Get the attributes of an open file.
+// Returns 0 on success with the attributes in *stat, or errno on error.
+int wasi_fd_filestat_get(wasi_fd_t fd, filestat_t* stat);
+
+// Returns true if fd is a terminal, like isatty(): a tty on Linux and macOS,
+// a console on Windows. WASI has no terminal query, so on WASM any character
+// device counts, as in wasi-libc's isatty().
+bool platform_fd_is_terminal(wasi_fd_t fd);
+
+
+// Asynchronous File I/O
+//
+// A single process-wide queue of positional reads and writes. Requests are
+// queued with platform_aio_read/platform_aio_write, handed to the kernel with
+// platform_aio_submit, and their completions are reaped with platform_aio_poll
+// (non-blocking) or platform_aio_wait (blocking). Completions can arrive in
+// any order; `user_data` identifies the request.
+//
+// Platform behavior:
+//   - Linux: io_uring, driven directly through its syscalls. If io_uring is
+//     unavailable (old kernel, disabled by sysctl or seccomp) the synchronous
+//     fallback below is used instead.
+//   - macOS/Windows/WASM: synchronous fallback. Each request is performed
+//     (with wasi_fd_pread/wasi_fd_pwrite) when it is queued and its
+//     completion is reported by the next poll/wait.
+//
+// The queue is not thread-safe.
+
+typedef struct {
+    uint64_t user_data;  // Value passed when the request was queued
+    int64_t result;      // Bytes transferred (may be short at EOF), or
+                         // -errno on error
+} platform_aio_completion_t;
+
+// Initializes the queue for up to `queue_depth` requests in flight (queued,
+// submitted or completed but not yet reaped). Returns true on success.
+bool platform_aio_init(uint32_t queue_depth);
+
+// Tears down the queue. Requests still in flight are waited for first.
+void platform_aio_shutdown(void);
+
+// Queues a read of `len` bytes at `offset` of `fd` into `buf`, or a write of
+// `len` bytes from `buf`. The buffer must stay valid until the completion is
+// reaped. Returns false if the queue is full or not initialized.
+bool platform_aio_read(wasi_fd_t fd, void *buf, size_t len, uint64_t offset, uint64_t user_data);
+bool platform_aio_write(wasi_fd_t fd, const void *buf, size_t len, uint64_t offset, uint64_t user_data);
+
+// Submits all queued requests. Returns the number of requests handed to the
+// kernel (always 0 for the synchronous fallback, where requests run when they
+// are queued).
+uint32_t platform_aio_submit(void);
+
+// Stores up to `max` completions in `out` without blocking and returns how
+// many were stored.
+size_t platform_aio_poll(platform_aio_completion_t *out, size_t max);
+
+// Submits queued requests, then blocks until at least `min_complete`
+// completions (but no more than `max`) are stored in `out`, or nothing is left
+// in flight. Returns how many were stored.
+size_t platform_aio_wait(platform_aio_completion_t *out, size_t max, size_t min_complete);
+
 
 // Command Line Arguments
 //
@@ -201,7 +302,15 @@ float fast_sqrtf(float x);
 // File mapping (read-only, private)
 //=============================================================================
 //
-// Attempts to map a file into memory for read-only, private (COW) access.
+// Mapping flags for platform_read_file_mmap
+#define PLATFORM_MMAP_READONLY 0x1  // Map read-only (pages can be shared with
+                                    // the page cache, writes fault)
+#define PLATFORM_MMAP_POPULATE 0x2  // Prefault the whole mapping up front
+
+// Attempts to map a file into memory for private access.
+// flags: 0 for a private copy-on-write mapping (the caller may write to the
+//   bytes, the file is never modified), or a combination of
+//   PLATFORM_MMAP_READONLY and PLATFORM_MMAP_POPULATE.
 // On success:
 //   *out_handle is set to an opaque handle that must be passed to
 //     platform_file_unmap when done (may be 0 for empty files)
@@ -211,13 +320,104 @@ float fast_sqrtf(float x);
 //
 // Platform behavior:
 //   - Linux/macOS/Windows: uses mmap/MapViewOfFile. If mapping fails,
-//     returns false (no heap copy fallback here).
+//     returns false (no heap copy fallback here). The number of concurrent
+//     mappings is only limited by memory.
 //   - WASM: returns false immediately (no mmap available).
 //
 // Callers should fall back to a regular buffered read (e.g., read_file)
 // when this returns false.
-bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **out_data, size_t *out_size);
+bool platform_read_file_mmap(const char *filename, uint32_t flags, uint64_t *out_handle, void **out_data, size_t *out_size);
 
 // Releases a mapping obtained from platform_read_file_mmap.
 // Safe to call with handle == 0. Resets/cleans any internal state for that handle.
 void platform_file_unmap(uint64_t handle);
+
+// Access pattern hints for platform_file_advise (can be combined)
+#define PLATFORM_ADVISE_SEQUENTIAL 0x1  // Read ahead aggressively
+#define PLATFORM_ADVISE_RANDOM     0x2  // Disable read ahead
+#define PLATFORM_ADVISE_WILLNEED   0x4  // Start paging the whole mapping in now
+
+// Hints the kernel about how a mapping obtained from platform_read_file_mmap
+// will be accessed (madvise on Linux/macOS, PrefetchVirtualMemory on Windows).
+// Returns true if the hint was applied, false for an invalid handle or when
+// the platform has no equivalent (WASM). Hints never change the contents.
+bool platform_file_advise(uint64_t handle, uint32_t advice);
+
+
+// Threads
+//
+// Platform behavior:
+//   - Linux: clone() with an mmap'd stack in the nostdlib builds, pthreads
+//     when linked against libc (PLATFORM_SKIP_ENTRY).
+//   - macOS: pthreads from libSystem.
+//   - Windows: CreateThread.
+//   - WASM: threads are not available (the module has no shared memory),
+//     platform_thread_create returns false and callers should run the work
+//     inline.
+//
+// The buddy allocator is thread-safe. Arenas are not; each thread has its own
+// scratch arenas once it has called thread_context_begin (base/scratch.h).
+
+typedef uint64_t platform_thread_t;
+typedef int (*platform_thread_fn)(void *arg);
+
+// Starts a new thread running fn(arg).
+// Returns true on success with the thread in *thread, which must be passed to
+// platform_thread_join exactly once.
+bool platform_thread_create(platform_thread_t *thread, platform_thread_fn fn, void *arg);
+
+// Waits for the thread to finish, releases its resources and returns the
+// value returned by its function.
+int platform_thread_join(platform_thread_t thread);
+
+// Gives up the rest of the calling thread's time slice.
+void platform_thread_yield(void);
+
+// Returns the number of CPUs the process can run on (at least 1).
+uint32_t platform_cpu_count(void);
+
+// Thread-local storage: a single pointer-sized slot per thread, NULL until
+// set. Available after platform_init() on the main thread and from the start
+// of every thread created by platform_thread_create.
+void platform_tls_set(void *value);
+void *platform_tls_get(void);
+
+// Futex: wait on / wake up threads blocked on a 32-bit word.
+//
+// platform_futex_wait blocks while *addr == expected, until woken by
+// platform_futex_wake_*. It returns immediately if *addr != expected and may
+// return spuriously, so callers must re-check their condition in a loop.
+// Only threads of the same process can be woken (private futexes).
+//
+// Platform behavior:
+//   - Linux: futex(FUTEX_WAIT_PRIVATE/FUTEX_WAKE_PRIVATE).
+//   - macOS: __ulock_wait/__ulock_wake.
+//   - Windows: WaitOnAddress/WakeByAddress* (needs synchronization.lib).
+//   - WASM: single-threaded, wait returns immediately and wake does nothing.
+void platform_futex_wait(volatile uint32_t *addr, uint32_t expected);
+void platform_futex_wake_one(volatile uint32_t *addr);
+void platform_futex_wake_all(volatile uint32_t *addr);
+
+
+// Time
+//
+// Platform behavior:
+//   - Linux: clock_gettime(CLOCK_MONOTONIC), through the vDSO when it is
+//     available (no kernel entry), otherwise the syscall.
+//   - macOS: mach_absolute_time.
+//   - Windows: QueryPerformanceCounter.
+//   - WASM: WASI clock_time_get(CLOCK_MONOTONIC).
+
+// Returns the current time of a monotonic clock in nanoseconds. The epoch is
+// unspecified, only differences between two readings are meaningful.
+uint64_t platform_now_ns(void);
+
+// Returns the CPU's cycle counter: rdtsc on x86_64, cntvct_el0 on arm64. It is
+// much cheaper to read than platform_now_ns and meant for fine-grained
+// profiling; convert with platform_cycle_frequency. On WASM, which has no
+// counter, it returns platform_now_ns().
+uint64_t platform_cycles(void);
+
+// Returns the platform_cycles rate in ticks per second. On x86_64 it is
+// measured against platform_now_ns on the first call, which takes about 10 ms.
+uint64_t platform_cycle_frequency(void);
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <platform.h>
+#include <base_types.h>
+#include <buddy.h>
+
+// Synchronous fallback for the asynchronous file I/O API (platform_aio_* in
+// platform.h), shared by the platform backends. It is only meant to be
+// included from a single platform_*.c file.
+//
+// Each request is performed with wasi_fd_pread/wasi_fd_pwrite when it is queued,
+// and its completion is stored in a ring until it is reaped, so the observable
+// behavior (bounded queue, completions reported by poll/wait) matches the
+// asynchronous backends.
+
+typedef struct {
+    platform_aio_completion_t *ring;
+    uint32_t capacity;
+    uint32_t head;   // Index of the oldest unreaped completion
+    uint32_t count;  // Number of unreaped completions
+} AioSyncQueue;
+
+static AioSyncQueue g_aio_sync = {0};
+
+static bool aio_sync_init(uint32_t queue_depth) {
+    if (g_aio_sync.ring || queue_depth == 0) return false;
+    g_aio_sync.ring = buddy_alloc(queue_depth * sizeof(platform_aio_completion_t), NULL);
+    if (!g_aio_sync.ring) return false;
+    g_aio_sync.capacity = queue_depth;
+    g_aio_sync.head = 0;
+    g_aio_sync.count = 0;
+    return true;
+}
+
+static void aio_sync_shutdown(void) {
+    if (g_aio_sync.ring) buddy_free(g_aio_sync.ring);
+    g_aio_sync.ring = NULL;
+    g_aio_sync.capacity = 0;
+    g_aio_sync.head = 0;
+    g_aio_sync.count = 0;
+}
+
+static bool aio_sync_rw(wasi_fd_t fd, void *buf, size_t len, uint64_t offset, uint64_t user_data, bool write) {
+    if (!g_aio_sync.ring || g_aio_sync.count == g_aio_sync.capacity) return false;
+
+    size_t n;
+    int err;
+    if (write) {
+        ciovec_t iov = {.buf = buf, .buf_len = len};
+        err = wasi_fd_pwrite(fd, &iov, 1, offset, &n);
+    } else {
+        iovec_t iov = {.iov_base = buf, .iov_len = len};
+        err = wasi_fd_pread(fd, &iov, 1, offset, &n);
+    }
+    int64_t result = (err == 0) ? (int64_t)n : -(int64_t)err;
+
+    uint32_t tail = (g_aio_sync.head + g_aio_sync.count) % g_aio_sync.capacity;
+    g_aio_sync.ring[tail].user_data = user_data;
+    g_aio_sync.ring[tail].result = result;
+    g_aio_sync.count++;
+    return true;
+}
+
+static size_t aio_sync_poll(platform_aio_completion_t *out, size_t max) {
+    size_t n = 0;
+    while (n < max && g_aio_sync.count > 0) {
+        out[n++] = g_aio_sync.ring[g_aio_sync.head];
+        g_aio_sync.head = (g_aio_sync.head + 1) % g_aio_sync.capacity;
+        g_aio_sync.count--;
+    }
+    return n;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <platform.h>
+#include <base_types.h>
+
+// Cycle counter (platform_cycles/platform_cycle_frequency in platform.h),
+// shared by the platform backends. It is only meant to be included from a
+// single platform_*.c file, which must also provide platform_now_ns.
+
+#if defined(_MSC_VER)
+unsigned __int64 __rdtsc(void);
+#pragma intrinsic(__rdtsc)
+#endif
+
+// Length of the x86_64 frequency calibration
+#define CYCLES_CALIBRATION_NS 10000000ull
+
+static inline uint64_t cycles_read(void) {
+#if defined(_MSC_VER)
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return platform_now_ns();
+#endif
+}
+
+static uint64_t cycles_calibrated_frequency = 0;
+
+static uint64_t cycles_frequency(void) {
+    if (cycles_calibrated_frequency) return cycles_calibrated_frequency;
+#if defined(__aarch64__) && !defined(_MSC_VER)
+    uint64_t frequency;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+#elif defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    // The TSC runs at a constant rate on every x86_64 CPU from the last
+    // decade, but nothing reports that rate portably: measure it.
+    uint64_t start_ns = platform_now_ns();
+    uint64_t start = cycles_read();
+    uint64_t elapsed_ns;
+    do {
+        elapsed_ns = platform_now_ns() - start_ns;
+    } while (elapsed_ns < CYCLES_CALIBRATION_NS);
+    uint64_t cycles = cycles_read() - start;
+    uint64_t frequency = cycles / elapsed_ns * 1000000000ull +
+                         cycles % elapsed_ns * 1000000000ull / elapsed_ns;
+#else
+    uint64_t frequency = 1000000000ull;
+#endif
+    // Racing threads compute about the same value, whichever write wins is fine
+    cycles_calibrated_frequency = frequency;
+    return frequency;
+}
@@ -1,6 +1,8 @@
 #include <platform.h>
 #include <base_types.h>
 #include <buddy.h>
+#include "platform_aio_sync.h"
+#include "platform_cycles.h"
 
 // =============================================================================
 // == Linux (x86_64) Implementation
@@ -10,17 +12,32 @@
 #define SYS_READ 0
 #define SYS_OPEN 2
 #define SYS_CLOSE 3
+#define SYS_FSTAT 5
+#define SYS_IOCTL 16
 #define SYS_LSEEK 8
 #define SYS_MMAP 9
 #define SYS_MPROTECT 10
 #define SYS_MUNMAP 11
 #define SYS_READV 19
 #define SYS_WRITEV 20
+#define SYS_SCHED_YIELD 24
+#define SYS_MADVISE 28
+#define SYS_PREADV 295
+#define SYS_PWRITEV 296
 #define SYS_DUP 32
 #define SYS_DUP2 33
+#define SYS_CLONE 56
 #define SYS_EXIT 60
 #define SYS_FCNTL 72
+#define SYS_ARCH_PRCTL 158
+#define SYS_CLOCK_GETTIME 228
+#define SYS_FUTEX 202
+#define SYS_SCHED_GETAFFINITY 204
+#define SYS_EXIT_GROUP 231
 #define SYS_OPENAT 257
+#define SYS_RENAMEAT 264
+#define SYS_IO_URING_SETUP 425
+#define SYS_IO_URING_ENTER 426
 
 // AT_FDCWD: special value meaning "current working directory" for openat
 #define AT_FDCWD -100
@@ -28,13 +45,55 @@
 // fcntl commands
 #define F_DUPFD 0
 
+// ioctl request reading the terminal attributes; fails with ENOTTY for
+// anything but a terminal
+#define TCGETS 0x5401
+
 // mmap flags
 #define PROT_READ  0x1
 #define PROT_WRITE 0x2
 #define MAP_PRIVATE 0x02
 #define MAP_ANONYMOUS 0x20
+#define MAP_SHARED 0x01
+#define MAP_POPULATE 0x8000
 #define MAP_FAILED ((void*)-1)
 
+// st_mode file type bits
+#define S_IFMT   0170000
+#define S_IFSOCK 0140000
+#define S_IFLNK  0120000
+#define S_IFREG  0100000
+#define S_IFBLK  0060000
+#define S_IFDIR  0040000
+#define S_IFCHR  0020000
+
+// Kernel struct stat layout on x86_64
+typedef struct {
+    uint64_t st_dev;
+    uint64_t st_ino;
+    uint64_t st_nlink;
+    uint32_t st_mode;
+    uint32_t st_uid;
+    uint32_t st_gid;
+    uint32_t __pad0;
+    uint64_t st_rdev;
+    int64_t st_size;
+    int64_t st_blksize;
+    int64_t st_blocks;
+    uint64_t st_atime;
+    uint64_t st_atime_nsec;
+    uint64_t st_mtime;
+    uint64_t st_mtime_nsec;
+    uint64_t st_ctime;
+    uint64_t st_ctime_nsec;
+    int64_t __unused[3];
+} linux_stat_t;
+
+// madvise advice values
+#define MADV_RANDOM 1
+#define MADV_SEQUENTIAL 2
+#define MADV_WILLNEED 3
+
 // Our emulated heap state for Linux
 static uint8_t* linux_heap_base = NULL;
 static size_t committed_pages = 0;
@@ -48,10 +107,16 @@ typedef struct {
     void* addr;
     size_t size;
     bool in_use;
+    uint32_t next_free;  // Next slot in the free list (index+1, 0 = end)
 } MmapHandle;
 
-#define MMAP_HANDLE_CAP 10
-static MmapHandle g_mmap_handles[MMAP_HANDLE_CAP] = {0};
+// Growable table of mappings; handles are slot index+1. Freed slots are kept
+// in a free list so acquiring and releasing a handle is O(1).
+#define MMAP_HANDLE_INITIAL_CAP 16
+static MmapHandle* g_mmap_handles = NULL;
+static uint32_t g_mmap_handle_cap = 0;
+static uint32_t g_mmap_handle_count = 0;  // Slots ever handed out
+static uint32_t g_mmap_free_head = 0;     // Free list head (index+1, 0 = empty)
 
 // Helper function to make a raw syscall.
 static inline long syscall(long n, long a1, long a2, long a3, long a4, long a5, long a6) {
@@ -80,7 +145,8 @@ uint32_t wasi_fd_write(int fd, const ciovec_t* iovs, size_t iovs_len, size_t* nw
 }
 
 void wasi_proc_exit(int status) {
-    syscall(SYS_EXIT, (long)status, 0, 0, 0, 0, 0);
+    // exit_group, so that exiting from any thread ends the whole process
+    syscall(SYS_EXIT_GROUP, (long)status, 0, 0, 0, 0, 0);
     __builtin_unreachable();
 }
 
@@ -164,10 +230,221 @@ float fast_sqrtf(float x) {
     return result;
 }
 
+#ifdef PLATFORM_SKIP_ENTRY
+// Linked against libc, which owns the thread pointer
+static __thread void* g_tls_slot = NULL;
+
+void platform_tls_set(void *value) {
+    g_tls_slot = value;
+}
+
+void* platform_tls_get(void) {
+    return g_tls_slot;
+}
+
+static void tls_init(void) {
+}
+#else
+// Without libc the thread pointer (FS base) is ours. It points at a LinuxTls
+// block: the main thread's is installed by platform_init, other threads get
+// theirs from clone(CLONE_SETTLS).
+#define ARCH_SET_FS 0x1002
+
+typedef struct {
+    void* self;             // %fs:0, the thread pointer as per the x86_64 TLS ABI
+    void* slot;             // %fs:8, platform_tls_get/platform_tls_set
+    uint64_t reserved[6];   // Keeps %fs:0x28 (stack protector canary) readable
+} LinuxTls;
+
+static LinuxTls g_main_tls;
+
+void platform_tls_set(void *value) {
+    __asm__ volatile("mov %0, %%fs:8" : : "r"(value) : "memory");
+}
+
+void* platform_tls_get(void) {
+    void* value;
+    __asm__ volatile("mov %%fs:8, %0" : "=r"(value) : : "memory");
+    return value;
+}
+
+static void tls_init(void) {
+    g_main_tls.self = &g_main_tls;
+    syscall(SYS_ARCH_PRCTL, ARCH_SET_FS, (long)&g_main_tls, 0, 0, 0, 0);
+}
+#endif
+
+// Time
+
+#define CLOCK_MONOTONIC 1
+
+typedef struct {
+    int64_t tv_sec;
+    int64_t tv_nsec;
+} linux_timespec_t;
+
+#ifdef PLATFORM_SKIP_ENTRY
+// libc's clock_gettime already goes through the vDSO
+extern int clock_gettime(int clock_id, linux_timespec_t *ts);
+
+static void vdso_init(char **argv) {
+    (void)argv;
+}
+
+uint64_t platform_now_ns(void) {
+    linux_timespec_t ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#else
+// The vDSO is a small shared library the kernel maps into every process. Its
+// clock_gettime reads the clock from a page shared with the kernel, which is
+// several times faster than the syscall. It is found through the auxiliary
+// vector and its symbols are looked up with the minimal ELF parsing below.
+#define AT_NULL 0
+#define AT_SYSINFO_EHDR 33
+#define PT_LOAD 1
+#define PT_DYNAMIC 2
+#define DT_NULL 0
+#define DT_HASH 4
+#define DT_STRTAB 5
+#define DT_SYMTAB 6
+#define STT_FUNC 2
+#define SHN_UNDEF 0
+
+typedef struct {
+    uint8_t e_ident[16];
+    uint16_t e_type;
+    uint16_t e_machine;
+    uint32_t e_version;
+    uint64_t e_entry;
+    uint64_t e_phoff;
+    uint64_t e_shoff;
+    uint32_t e_flags;
+    uint16_t e_ehsize;
+    uint16_t e_phentsize;
+    uint16_t e_phnum;
+    uint16_t e_shentsize;
+    uint16_t e_shnum;
+    uint16_t e_shstrndx;
+} elf64_ehdr_t;
+
+typedef struct {
+    uint32_t p_type;
+    uint32_t p_flags;
+    uint64_t p_offset;
+    uint64_t p_vaddr;
+    uint64_t p_paddr;
+    uint64_t p_filesz;
+    uint64_t p_memsz;
+    uint64_t p_align;
+} elf64_phdr_t;
+
+typedef struct {
+    int64_t d_tag;
+    uint64_t d_val;
+} elf64_dyn_t;
+
+typedef struct {
+    uint32_t st_name;
+    uint8_t st_info;
+    uint8_t st_other;
+    uint16_t st_shndx;
+    uint64_t st_value;
+    uint64_t st_size;
+} elf64_sym_t;
+
+typedef int (*vdso_clock_gettime_fn)(int clock_id, linux_timespec_t *ts);
+static vdso_clock_gettime_fn g_vdso_clock_gettime = NULL;
+
+static bool vdso_name_equal(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// Returns the address of the function `name` in the vDSO mapped at `base`, or
+// NULL if it is not found.
+static void *vdso_lookup(const uint8_t *base, const char *name) {
+    const elf64_ehdr_t *ehdr = (const elf64_ehdr_t *)base;
+    const elf64_phdr_t *phdr = (const elf64_phdr_t *)(base + ehdr->e_phoff);
+    uintptr_t load_offset = 0;
+    bool found_load = false;
+    const elf64_dyn_t *dyn = NULL;
+    for (uint16_t i = 0; i < ehdr->e_phnum; i++) {
+        if (phdr[i].p_type == PT_LOAD && !found_load) {
+            load_offset = (uintptr_t)base + phdr[i].p_offset - phdr[i].p_vaddr;
+            found_load = true;
+        } else if (phdr[i].p_type == PT_DYNAMIC) {
+            dyn = (const elf64_dyn_t *)(base + phdr[i].p_offset);
+        }
+    }
+    if (!found_load || !dyn) return NULL;
+
+    const uint32_t *hash = NULL;
+    const char *strtab = NULL;
+    const elf64_sym_t *symtab = NULL;
+    for (; dyn->d_tag != DT_NULL; dyn++) {
+        if (dyn->d_tag == DT_HASH) hash = (const uint32_t *)(load_offset + dyn->d_val);
+        if (dyn->d_tag == DT_STRTAB) strtab = (const char *)(load_offset + dyn->d_val);
+        if (dyn->d_tag == DT_SYMTAB) symtab = (const elf64_sym_t *)(load_offset + dyn->d_val);
+    }
+    if (!hash || !strtab || !symtab) return NULL;
+
+    // The second word of the SysV hash table is the number of symbols
+    uint32_t symbol_count = hash[1];
+    for (uint32_t i = 0; i < symbol_count; i++) {
+        const elf64_sym_t *sym = &symtab[i];
+        if ((sym->st_info & 0xf) != STT_FUNC || sym->st_shndx == SHN_UNDEF) continue;
+        if (vdso_name_equal(strtab + sym->st_name, name)) {
+            return (void *)(load_offset + sym->st_value);
+        }
+    }
+    return NULL;
+}
+
+static void vdso_init(char **argv) {
+    if (!argv) return;
+    // The initial stack holds argv, envp and then the auxiliary vector, each
+    // terminated by NULL.
+    char **p = argv;
+    while (*p) p++;
+    p++;
+    while (*p) p++;
+    p++;
+    for (uint64_t *aux = (uint64_t *)p; aux[0] != AT_NULL; aux += 2) {
+        if (aux[0] == AT_SYSINFO_EHDR) {
+            g_vdso_clock_gettime = (vdso_clock_gettime_fn)vdso_lookup((const uint8_t *)aux[1], "__vdso_clock_gettime");
+            break;
+        }
+    }
+}
+
+uint64_t platform_now_ns(void) {
+    linux_timespec_t ts;
+    if (!g_vdso_clock_gettime || g_vdso_clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        syscall(SYS_CLOCK_GETTIME, CLOCK_MONOTONIC, (long)&ts, 0, 0, 0, 0);
+    }
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+uint64_t platform_cycles(void) {
+    return cycles_read();
+}
+
+uint64_t platform_cycle_frequency(void) {
+    return cycles_frequency();
+}
+
 // Public initialization function for manual use (e.g., SDL apps using external stdlib)
 void platform_init(int argc, char** argv) {
     stored_argc = argc;
     stored_argv = argv;
+    tls_init();
+    vdso_init(argv);
     ensure_heap_initialized();
     buddy_init();
 }
@@ -238,6 +515,11 @@ int wasi_fd_close(wasi_fd_t fd) {
     return (result < 0) ? (int)(-result) : 0;
 }
 
+int wasi_path_rename(const char* old_path, size_t old_path_len, const char* new_path, size_t new_path_len) {
+    long result = syscall(SYS_RENAMEAT, (long)AT_FDCWD, (long)old_path, (long)AT_FDCWD, (long)new_path, 0, 0);
+    return (result < 0) ? (int)(-result) : 0;
+}
+
 int wasi_fd_read(wasi_fd_t fd, const iovec_t* iovs, size_t iovs_len, size_t* nread) {
     long result = syscall(SYS_READV, (long)fd, (long)iovs, (long)iovs_len, 0, 0, 0);
     if (result < 0) {
@@ -268,6 +550,62 @@ int wasi_fd_tell(wasi_fd_t fd, uint64_t* offset) {
     return 0;  // Success
 }
 
+// preadv/pwritev take the offset split into low/high words; on 64-bit the
+// kernel ignores the high word, so the whole offset goes in the low one.
+int wasi_fd_pread(wasi_fd_t fd, const iovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nread) {
+    long result = syscall(SYS_PREADV, (long)fd, (long)iovs, (long)iovs_len, (long)offset, 0, 0);
+    if (result < 0) {
+        *nread = 0;
+        return (int)(-result);  // Return errno
+    }
+    *nread = (size_t)result;
+    return 0;  // Success
+}
+
+int wasi_fd_pwrite(wasi_fd_t fd, const ciovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nwritten) {
+    long result = syscall(SYS_PWRITEV, (long)fd, (long)iovs, (long)iovs_len, (long)offset, 0, 0);
+    if (result < 0) {
+        *nwritten = 0;
+        return (int)(-result);  // Return errno
+    }
+    *nwritten = (size_t)result;
+    return 0;  // Success
+}
+
+static uint8_t filetype_from_mode(uint32_t mode) {
+    switch (mode & S_IFMT) {
+        case S_IFREG:  return WASI_FILETYPE_REGULAR_FILE;
+        case S_IFDIR:  return WASI_FILETYPE_DIRECTORY;
+        case S_IFCHR:  return WASI_FILETYPE_CHARACTER_DEVICE;
+        case S_IFBLK:  return WASI_FILETYPE_BLOCK_DEVICE;
+        case S_IFLNK:  return WASI_FILETYPE_SYMBOLIC_LINK;
+        case S_IFSOCK: return WASI_FILETYPE_SOCKET_STREAM;
+        default:       return WASI_FILETYPE_UNKNOWN;
+    }
+}
+
+int wasi_fd_filestat_get(wasi_fd_t fd, filestat_t* stat) {
+    linux_stat_t st;
+    long result = syscall(SYS_FSTAT, (long)fd, (long)&st, 0, 0, 0, 0);
+    if (result < 0) {
+        return (int)(-result);  // Return errno
+    }
+    stat->dev = st.st_dev;
+    stat->ino = st.st_ino;
+    stat->filetype = filetype_from_mode(st.st_mode);
+    stat->nlink = st.st_nlink;
+    stat->size = (uint64_t)st.st_size;
+    stat->atim = st.st_atime * 1000000000ULL + st.st_atime_nsec;
+    stat->mtim = st.st_mtime * 1000000000ULL + st.st_mtime_nsec;
+    stat->ctim = st.st_ctime * 1000000000ULL + st.st_ctime_nsec;
+    return 0;  // Success
+}
+
+bool platform_fd_is_terminal(wasi_fd_t fd) {
+    uint8_t termios[64];  // Kernel struct termios is 36 bytes
+    return syscall(SYS_IOCTL, (long)fd, TCGETS, (long)termios, 0, 0, 0) == 0;
+}
+
 // Command line arguments implementation
 int wasi_args_sizes_get(size_t* argc, size_t* argv_buf_size) {
     *argc = (size_t)stored_argc;
@@ -283,7 +621,35 @@ int wasi_args_sizes_get(size_t* argc, size_t* argv_buf_size) {
     return 0;
 }
 
-bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **out_data, size_t *out_size) {
+// Returns a free slot index in the mmap handle table, growing the table from
+// buddy memory if needed. Returns -1 if the table cannot grow.
+static int64_t mmap_handle_acquire(void) {
+    if (g_mmap_free_head != 0) {
+        uint32_t idx = g_mmap_free_head - 1;
+        g_mmap_free_head = g_mmap_handles[idx].next_free;
+        return idx;
+    }
+    if (g_mmap_handle_count == g_mmap_handle_cap) {
+        uint32_t new_cap = g_mmap_handle_cap ? g_mmap_handle_cap * 2 : MMAP_HANDLE_INITIAL_CAP;
+        MmapHandle* new_handles = buddy_alloc(new_cap * sizeof(MmapHandle), NULL);
+        if (!new_handles) return -1;
+        for (uint32_t i = 0; i < g_mmap_handle_count; i++) {
+            new_handles[i] = g_mmap_handles[i];
+        }
+        if (g_mmap_handles) buddy_free(g_mmap_handles);
+        g_mmap_handles = new_handles;
+        g_mmap_handle_cap = new_cap;
+    }
+    return g_mmap_handle_count++;
+}
+
+static MmapHandle* mmap_handle_get(uint64_t handle) {
+    if (handle == 0 || handle > g_mmap_handle_count) return NULL;
+    MmapHandle* h = &g_mmap_handles[handle - 1];
+    return h->in_use ? h : NULL;
+}
+
+bool platform_read_file_mmap(const char *filename, uint32_t flags, uint64_t *out_handle, void **out_data, size_t *out_size) {
     if (!filename || !out_handle || !out_data || !out_size) return false;
     *out_handle = 0;
     *out_data = NULL;
@@ -294,18 +660,12 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
         return false;
     }
 
-    long end = syscall(SYS_LSEEK, fd, 0, WASI_SEEK_END, 0, 0, 0);
-    if (end < 0) {
-        syscall(SYS_CLOSE, fd, 0, 0, 0, 0, 0);
-        return false;
-    }
-    size_t file_size = (size_t)end;
-
-    // Reset to start
-    if (syscall(SYS_LSEEK, fd, 0, WASI_SEEK_SET, 0, 0, 0) < 0) {
+    filestat_t stat;
+    if (wasi_fd_filestat_get((wasi_fd_t)fd, &stat) != 0) {
         syscall(SYS_CLOSE, fd, 0, 0, 0, 0, 0);
         return false;
     }
+    size_t file_size = (size_t)stat.size;
 
     if (file_size == 0) {
         syscall(SYS_CLOSE, fd, 0, 0, 0, 0, 0);
@@ -313,12 +673,15 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
         return true;
     }
 
+    long prot = (flags & PLATFORM_MMAP_READONLY) ? PROT_READ : (PROT_READ | PROT_WRITE);
+    long map_flags = MAP_PRIVATE;
+    if (flags & PLATFORM_MMAP_POPULATE) map_flags |= MAP_POPULATE;
     void* addr = (void*)syscall(
         SYS_MMAP,
         (long)NULL,
         (long)file_size,
-        (long)(PROT_READ | PROT_WRITE),
-        (long)MAP_PRIVATE,
+        prot,
+        map_flags,
         (long)fd,
         (long)0
     );
@@ -328,14 +691,8 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
         return false;
     }
 
-    int slot = -1;
-    for (int i = 0; i < MMAP_HANDLE_CAP; i++) {
-        if (!g_mmap_handles[i].in_use) {
-            slot = i;
-            break;
-        }
-    }
-    if (slot == -1) {
+    int64_t slot = mmap_handle_acquire();
+    if (slot < 0) {
         syscall(SYS_MUNMAP, (long)addr, (long)file_size, 0, 0, 0, 0);
         return false;
     }
@@ -343,6 +700,7 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
     g_mmap_handles[slot].addr = addr;
     g_mmap_handles[slot].size = file_size;
     g_mmap_handles[slot].in_use = true;
+    g_mmap_handles[slot].next_free = 0;
 
     *out_handle = (uint64_t)(slot + 1);
     *out_data = addr;
@@ -351,17 +709,32 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
 }
 
 void platform_file_unmap(uint64_t handle) {
-    if (handle == 0) return;
-    uint64_t idx = handle - 1;
-    if (idx >= MMAP_HANDLE_CAP) return;
-    MmapHandle *h = &g_mmap_handles[idx];
-    if (!h->in_use) return;
+    MmapHandle *h = mmap_handle_get(handle);
+    if (!h) return;
     if (h->addr && h->size > 0) {
         syscall(SYS_MUNMAP, (long)h->addr, (long)h->size, 0, 0, 0, 0);
     }
     h->addr = NULL;
     h->size = 0;
     h->in_use = false;
+    h->next_free = g_mmap_free_head;
+    g_mmap_free_head = (uint32_t)handle;
+}
+
+bool platform_file_advise(uint64_t handle, uint32_t advice) {
+    MmapHandle *h = mmap_handle_get(handle);
+    if (!h) return false;
+    bool ok = true;
+    if (advice & PLATFORM_ADVISE_SEQUENTIAL) {
+        ok &= syscall(SYS_MADVISE, (long)h->addr, (long)h->size, MADV_SEQUENTIAL, 0, 0, 0) == 0;
+    }
+    if (advice & PLATFORM_ADVISE_RANDOM) {
+        ok &= syscall(SYS_MADVISE, (long)h->addr, (long)h->size, MADV_RANDOM, 0, 0, 0) == 0;
+    }
+    if (advice & PLATFORM_ADVISE_WILLNEED) {
+        ok &= syscall(SYS_MADVISE, (long)h->addr, (long)h->size, MADV_WILLNEED, 0, 0, 0) == 0;
+    }
+    return ok;
 }
 
 int wasi_args_get(char** argv, char* argv_buf) {
@@ -377,6 +750,444 @@ int wasi_args_get(char** argv, char* argv_buf) {
     return 0;
 }
 
+// =============================================================================
+// == Asynchronous file I/O (io_uring)
+// =============================================================================
+//
+// The kernel ABI structures below follow <linux/io_uring.h>.
+
+struct io_sqring_offsets {
+    uint32_t head, tail, ring_mask, ring_entries, flags, dropped, array, resv1;
+    uint64_t user_addr;
+};
+
+struct io_cqring_offsets {
+    uint32_t head, tail, ring_mask, ring_entries, overflow, cqes, flags, resv1;
+    uint64_t user_addr;
+};
+
+struct io_uring_params {
+    uint32_t sq_entries;
+    uint32_t cq_entries;
+    uint32_t flags;
+    uint32_t sq_thread_cpu;
+    uint32_t sq_thread_idle;
+    uint32_t features;
+    uint32_t wq_fd;
+    uint32_t resv[3];
+    struct io_sqring_offsets sq_off;
+    struct io_cqring_offsets cq_off;
+};
+
+struct io_uring_sqe {
+    uint8_t opcode;
+    uint8_t flags;
+    uint16_t ioprio;
+    int32_t fd;
+    uint64_t off;
+    uint64_t addr;
+    uint32_t len;
+    uint32_t rw_flags;
+    uint64_t user_data;
+    uint16_t buf_index;
+    uint16_t personality;
+    int32_t splice_fd_in;
+    uint64_t addr3;
+    uint64_t pad2;
+};
+
+struct io_uring_cqe {
+    uint64_t user_data;
+    int32_t res;
+    uint32_t flags;
+};
+
+#define IORING_OFF_SQ_RING 0ULL
+#define IORING_OFF_CQ_RING 0x8000000ULL
+#define IORING_OFF_SQES 0x10000000ULL
+#define IORING_FEAT_SINGLE_MMAP (1U << 0)
+#define IORING_ENTER_GETEVENTS (1U << 0)
+#define IORING_OP_READ 22
+#define IORING_OP_WRITE 23
+
+#define EINTR 4
+
+typedef struct {
+    bool active;           // io_uring is in use (otherwise: sync fallback)
+    long ring_fd;
+    uint8_t *sq_ring;
+    size_t sq_ring_size;
+    uint8_t *cq_ring;      // Equal to sq_ring with IORING_FEAT_SINGLE_MMAP
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    uint32_t *sq_head, *sq_tail, *sq_mask, *sq_array;
+    uint32_t *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+    uint32_t queue_depth;
+    uint32_t in_flight;    // Queued, submitted or completed, but not reaped
+    uint32_t unsubmitted;  // Queued in the SQ ring but not yet entered
+} AioRing;
+
+static AioRing g_aio = {0};
+
+static void aio_ring_unmap(void) {
+    if (g_aio.sqes) syscall(SYS_MUNMAP, (long)g_aio.sqes, (long)g_aio.sqes_size, 0, 0, 0, 0);
+    if (g_aio.cq_ring && g_aio.cq_ring != g_aio.sq_ring) {
+        syscall(SYS_MUNMAP, (long)g_aio.cq_ring, (long)g_aio.cq_ring_size, 0, 0, 0, 0);
+    }
+    if (g_aio.sq_ring) syscall(SYS_MUNMAP, (long)g_aio.sq_ring, (long)g_aio.sq_ring_size, 0, 0, 0, 0);
+    if (g_aio.ring_fd >= 0) syscall(SYS_CLOSE, g_aio.ring_fd, 0, 0, 0, 0, 0);
+    AioRing empty = {0};
+    g_aio = empty;
+}
+
+static void* aio_ring_mmap(size_t size, uint64_t offset) {
+    long ret = syscall(SYS_MMAP, (long)NULL, (long)size, (long)(PROT_READ | PROT_WRITE),
+            (long)(MAP_SHARED | MAP_POPULATE), g_aio.ring_fd, (long)offset);
+    return (ret < 0) ? NULL : (void*)ret;
+}
+
+static bool aio_ring_setup(uint32_t queue_depth) {
+    struct io_uring_params params = {0};
+    g_aio.ring_fd = syscall(SYS_IO_URING_SETUP, (long)queue_depth, (long)&params, 0, 0, 0, 0);
+    if (g_aio.ring_fd < 0) {
+        g_aio.ring_fd = 0;
+        return false;
+    }
+
+    g_aio.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    g_aio.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (g_aio.cq_ring_size > g_aio.sq_ring_size) g_aio.sq_ring_size = g_aio.cq_ring_size;
+        g_aio.cq_ring_size = g_aio.sq_ring_size;
+    }
+    g_aio.sq_ring = aio_ring_mmap(g_aio.sq_ring_size, IORING_OFF_SQ_RING);
+    if (!g_aio.sq_ring) goto fail;
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        g_aio.cq_ring = g_aio.sq_ring;
+    } else {
+        g_aio.cq_ring = aio_ring_mmap(g_aio.cq_ring_size, IORING_OFF_CQ_RING);
+        if (!g_aio.cq_ring) goto fail;
+    }
+    g_aio.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    g_aio.sqes = aio_ring_mmap(g_aio.sqes_size, IORING_OFF_SQES);
+    if (!g_aio.sqes) goto fail;
+
+    g_aio.sq_head = (uint32_t*)(g_aio.sq_ring + params.sq_off.head);
+    g_aio.sq_tail = (uint32_t*)(g_aio.sq_ring + params.sq_off.tail);
+    g_aio.sq_mask = (uint32_t*)(g_aio.sq_ring + params.sq_off.ring_mask);
+    g_aio.sq_array = (uint32_t*)(g_aio.sq_ring + params.sq_off.array);
+    g_aio.cq_head = (uint32_t*)(g_aio.cq_ring + params.cq_off.head);
+    g_aio.cq_tail = (uint32_t*)(g_aio.cq_ring + params.cq_off.tail);
+    g_aio.cq_mask = (uint32_t*)(g_aio.cq_ring + params.cq_off.ring_mask);
+    g_aio.cqes = (struct io_uring_cqe*)(g_aio.cq_ring + params.cq_off.cqes);
+    // The kernel rounds the SQ size up to a power of two; we still cap the
+    // requests in flight at queue_depth so the CQ ring can never overflow.
+    g_aio.queue_depth = queue_depth;
+    g_aio.active = true;
+    return true;
+
+fail:
+    aio_ring_unmap();
+    return false;
+}
+
+bool platform_aio_init(uint32_t queue_depth) {
+    if (g_aio.active || queue_depth == 0) return false;
+    if (aio_ring_setup(queue_depth)) return true;
+    return aio_sync_init(queue_depth);
+}
+
+static bool aio_ring_queue(uint8_t opcode, wasi_fd_t fd, void *buf, size_t len, uint64_t offset, uint64_t user_data) {
+    if (g_aio.in_flight == g_aio.queue_depth) return false;
+    // We are the only producer, so the tail can be read without ordering;
+    // the release store below publishes the filled SQE to the kernel.
+    uint32_t tail = *g_aio.sq_tail;
+    uint32_t idx = tail & *g_aio.sq_mask;
+    struct io_uring_sqe *sqe = &g_aio.sqes[idx];
+    struct io_uring_sqe empty = {0};
+    *sqe = empty;
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    // Linux transfers at most 0x7ffff000 bytes per read/write anyway, so
+    // larger requests simply complete short.
+    sqe->len = (uint32_t)(len > 0x7ffff000 ? 0x7ffff000 : len);
+    sqe->user_data = user_data;
+    g_aio.sq_array[idx] = idx;
+    __atomic_store_n(g_aio.sq_tail, tail + 1, __ATOMIC_RELEASE);
+    g_aio.in_flight++;
+    g_aio.unsubmitted++;
+    return true;
+}
+
+bool platform_aio_read(wasi_fd_t fd, void *buf, size_t len, uint64_t offset, uint64_t user_data) {
+    if (!g_aio.active) return aio_sync_rw(fd, buf, len, offset, user_data, false);
+    return aio_ring_queue(IORING_OP_READ, fd, buf, len, offset, user_data);
+}
+
+bool platform_aio_write(wasi_fd_t fd, const void *buf, size_t len, uint64_t offset, uint64_t user_data) {
+    if (!g_aio.active) return aio_sync_rw(fd, (void*)buf, len, offset, user_data, true);
+    return aio_ring_queue(IORING_OP_WRITE, fd, (void*)buf, len, offset, user_data);
+}
+
+// Enters the ring, submitting all unsubmitted SQEs and optionally waiting for
+// `min_complete` completions. Returns the number of SQEs submitted, or -errno.
+static long aio_ring_enter(uint32_t min_complete) {
+    uint32_t flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    long ret;
+    do {
+        ret = syscall(SYS_IO_URING_ENTER, g_aio.ring_fd, (long)g_aio.unsubmitted,
+                (long)min_complete, (long)flags, 0, 0);
+    } while (ret == -EINTR);
+    if (ret > 0) g_aio.unsubmitted -= (uint32_t)ret;
+    return ret;
+}
+
+uint32_t platform_aio_submit(void) {
+    if (!g_aio.active || g_aio.unsubmitted == 0) return 0;
+    long ret = aio_ring_enter(0);
+    return ret > 0 ? (uint32_t)ret : 0;
+}
+
+size_t platform_aio_poll(platform_aio_completion_t *out, size_t max) {
+    if (!g_aio.active) return aio_sync_poll(out, max);
+    size_t n = 0;
+    uint32_t head = *g_aio.cq_head;
+    uint32_t tail = __atomic_load_n(g_aio.cq_tail, __ATOMIC_ACQUIRE);
+    while (n < max && head != tail) {
+        struct io_uring_cqe *cqe = &g_aio.cqes[head & *g_aio.cq_mask];
+        out[n].user_data = cqe->user_data;
+        out[n].result = cqe->res;
+        n++;
+        head++;
+    }
+    __atomic_store_n(g_aio.cq_head, head, __ATOMIC_RELEASE);
+    g_aio.in_flight -= (uint32_t)n;
+    return n;
+}
+
+size_t platform_aio_wait(platform_aio_completion_t *out, size_t max, size_t min_complete) {
+    if (!g_aio.active) return aio_sync_poll(out, max);
+    if (min_complete > max) min_complete = max;
+    if (g_aio.unsubmitted > 0) aio_ring_enter(0);
+    size_t n = platform_aio_poll(out, max);
+    while (n < min_complete && g_aio.in_flight > g_aio.unsubmitted) {
+        uint32_t want = (uint32_t)(min_complete - n);
+        uint32_t submitted = g_aio.in_flight - g_aio.unsubmitted;
+        if (want > submitted) want = submitted;
+        if (aio_ring_enter(want) < 0) break;
+        n += platform_aio_poll(out + n, max - n);
+    }
+    return n;
+}
+
+void platform_aio_shutdown(void) {
+    if (!g_aio.active) {
+        aio_sync_shutdown();
+        return;
+    }
+    // The kernel may still write into user buffers; drain before unmapping.
+    platform_aio_completion_t drain[16];
+    while (g_aio.in_flight > 0) {
+        if (platform_aio_wait(drain, 16, 1) == 0) break;
+    }
+    aio_ring_unmap();
+}
+
+// Threads and futex
+
+// futex operations
+#define FUTEX_WAIT         0
+#define FUTEX_WAIT_PRIVATE 128  // FUTEX_WAIT | FUTEX_PRIVATE_FLAG
+#define FUTEX_WAKE_PRIVATE 129  // FUTEX_WAKE | FUTEX_PRIVATE_FLAG
+
+void platform_futex_wait(volatile uint32_t *addr, uint32_t expected) {
+    // Returns on wake, EAGAIN (value changed), or EINTR; all are fine since
+    // callers re-check their condition.
+    syscall(SYS_FUTEX, (long)addr, FUTEX_WAIT_PRIVATE, (long)expected, 0, 0, 0);
+}
+
+void platform_futex_wake_one(volatile uint32_t *addr) {
+    syscall(SYS_FUTEX, (long)addr, FUTEX_WAKE_PRIVATE, 1, 0, 0, 0);
+}
+
+void platform_futex_wake_all(volatile uint32_t *addr) {
+    syscall(SYS_FUTEX, (long)addr, FUTEX_WAKE_PRIVATE, 0x7fffffff, 0, 0, 0);
+}
+
+void platform_thread_yield(void) {
+    syscall(SYS_SCHED_YIELD, 0, 0, 0, 0, 0, 0);
+}
+
+uint32_t platform_cpu_count(void) {
+    uint64_t mask[16];  // Room for 1024 CPUs
+    long ret = syscall(SYS_SCHED_GETAFFINITY, 0, (long)sizeof(mask), (long)mask, 0, 0, 0);
+    if (ret <= 0) return 1;
+    uint32_t count = 0;
+    for (long i = 0; i < ret / 8; i++) {
+        for (uint64_t m = mask[i]; m; m &= m - 1) count++;  // No libgcc popcount
+    }
+    return count > 0 ? count : 1;
+}
+
+#ifdef PLATFORM_SKIP_ENTRY
+// Linked against libc: use pthreads so that new threads get their own libc
+// thread-local state (errno, stack protector, ...).
+typedef unsigned long pthread_t;
+extern int pthread_create(pthread_t *thread, const void *attr, void *(*start_routine)(void *), void *arg);
+extern int pthread_join(pthread_t thread, void **retval);
+
+typedef struct {
+    pthread_t id;
+    platform_thread_fn fn;
+    void *arg;
+    int result;
+} LinuxThread;
+
+static void *linux_thread_entry(void *param) {
+    LinuxThread *t = param;
+    t->result = t->fn(t->arg);
+    return NULL;
+}
+
+bool platform_thread_create(platform_thread_t *thread, platform_thread_fn fn, void *arg) {
+    LinuxThread *t = buddy_alloc(sizeof(LinuxThread), NULL);
+    if (!t) return false;
+    t->fn = fn;
+    t->arg = arg;
+    t->result = 0;
+    if (pthread_create(&t->id, NULL, linux_thread_entry, t) != 0) {
+        buddy_free(t);
+        return false;
+    }
+    *thread = (platform_thread_t)(uintptr_t)t;
+    return true;
+}
+
+int platform_thread_join(platform_thread_t thread) {
+    LinuxThread *t = (LinuxThread *)(uintptr_t)thread;
+    pthread_join(t->id, NULL);
+    int result = t->result;
+    buddy_free(t);
+    return result;
+}
+#else
+// Without libc, threads are created with a raw clone(). Each thread gets an
+// mmap'd stack with a guard page at the bottom; its LinuxThread record lives
+// at the top of the same mapping. The kernel clears `tid` and wakes futex
+// waiters on it when the thread exits (CLONE_CHILD_CLEARTID), which is what
+// platform_thread_join waits for before unmapping the stack.
+//
+// Each thread gets its own LinuxTls block (CLONE_SETTLS), also stored in its
+// LinuxThread record.
+
+#define CLONE_VM             0x00000100
+#define CLONE_FS             0x00000200
+#define CLONE_FILES          0x00000400
+#define CLONE_SIGHAND        0x00000800
+#define CLONE_THREAD         0x00010000
+#define CLONE_SYSVSEM        0x00040000
+#define CLONE_SETTLS         0x00080000
+#define CLONE_PARENT_SETTID  0x00100000
+#define CLONE_CHILD_CLEARTID 0x00200000
+
+#define THREAD_STACK_SIZE (1024 * 1024)
+#define THREAD_GUARD_SIZE 4096
+
+typedef struct {
+    LinuxTls tls;
+    volatile uint32_t tid;  // Set by the kernel, cleared when the thread exits
+    int result;
+    platform_thread_fn fn;
+    void *arg;
+    void *map_base;
+    size_t map_size;
+} LinuxThread;
+
+// Called on the new thread's stack by linux_clone_thread.
+__attribute__((used))
+static int linux_thread_entry(LinuxThread *t) {
+    t->result = t->fn(t->arg);
+    return 0;
+}
+
+// long linux_clone_thread(unsigned long flags, void *stack, uint32_t *ptid, uint32_t *ctid, void *tls)
+// Issues clone(flags, stack, ptid, ctid, tls). In the parent it returns the new
+// thread's tid (or -errno). The child starts on `stack`, whose top word holds
+// the LinuxThread pointer, calls linux_thread_entry and exits the thread
+// without touching the stack afterwards.
+long linux_clone_thread(unsigned long flags, void *stack, volatile uint32_t *ptid, volatile uint32_t *ctid, void *tls);
+__asm__(
+    ".text\n"
+    "linux_clone_thread:\n"
+    "    mov %rcx, %r10\n"             // ctid is the 4th syscall argument, tls is already in r8
+    "    mov $56, %eax\n"              // SYS_CLONE
+    "    syscall\n"
+    "    test %rax, %rax\n"
+    "    jnz 1f\n"                     // Parent (or error): return
+    "    xor %ebp, %ebp\n"             // Child: clear frame pointer as per ABI
+    "    pop %rdi\n"                   // LinuxThread*, leaves RSP 16-aligned
+    "    call linux_thread_entry\n"
+    "    mov %eax, %edi\n"
+    "    mov $60, %eax\n"              // SYS_EXIT (this thread only)
+    "    syscall\n"
+    "    hlt\n"
+    "1:  ret\n"
+);
+
+bool platform_thread_create(platform_thread_t *thread, platform_thread_fn fn, void *arg) {
+    size_t map_size = THREAD_STACK_SIZE;
+    long ret = syscall(SYS_MMAP, (long)NULL, (long)map_size, (long)(PROT_READ | PROT_WRITE),
+            (long)(MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+    if (ret < 0 && ret > -4096) return false;
+    uint8_t *base = (uint8_t *)ret;
+    syscall(SYS_MPROTECT, (long)base, THREAD_GUARD_SIZE, 0, 0, 0, 0);  // PROT_NONE
+
+    // LinuxThread at the top of the mapping, the stack grows down below it
+    uintptr_t top = ((uintptr_t)(base + map_size) - sizeof(LinuxThread)) & ~(uintptr_t)15;
+    LinuxThread *t = (LinuxThread *)top;
+    t->tls = (LinuxTls){0};
+    t->tls.self = &t->tls;
+    t->tid = 0;
+    t->result = 0;
+    t->fn = fn;
+    t->arg = arg;
+    t->map_base = base;
+    t->map_size = map_size;
+
+    // The child pops the LinuxThread pointer, leaving RSP == top (16-aligned)
+    // at the call into linux_thread_entry.
+    void **sp = (void **)(top - 8);
+    sp[0] = t;
+
+    unsigned long flags = CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND | CLONE_THREAD |
+            CLONE_SYSVSEM | CLONE_SETTLS | CLONE_PARENT_SETTID | CLONE_CHILD_CLEARTID;
+    long tid = linux_clone_thread(flags, sp, &t->tid, &t->tid, &t->tls);
+    if (tid < 0) {
+        syscall(SYS_MUNMAP, (long)base, (long)map_size, 0, 0, 0, 0);
+        return false;
+    }
+    *thread = (platform_thread_t)(uintptr_t)t;
+    return true;
+}
+
+int platform_thread_join(platform_thread_t thread) {
+    LinuxThread *t = (LinuxThread *)(uintptr_t)thread;
+    uint32_t tid;
+    while ((tid = __atomic_load_n(&t->tid, __ATOMIC_ACQUIRE)) != 0) {
+        // The kernel's CLONE_CHILD_CLEARTID wakeup is a shared futex wake,
+        // which does not reach private waiters.
+        syscall(SYS_FUTEX, (long)&t->tid, FUTEX_WAIT, (long)tid, 0, 0, 0);
+    }
+    int result = t->result;
+    syscall(SYS_MUNMAP, (long)t->map_base, (long)t->map_size, 0, 0, 0, 0);
+    return result;
+}
+#endif
+
 #ifndef PLATFORM_SKIP_ENTRY
 // Forward declaration for application entry point (only when platform provides entry)
 int app_main();
@@ -406,7 +1217,7 @@ void _start() {
         "andq $-16, %rsp\n"          // Align stack to 16 bytes
         "call _start_c\n"            // Call the C portion
         "mov %eax, %edi\n"           // Move return value to exit code
-        "mov $60, %eax\n"            // SYS_EXIT
+        "mov $231, %eax\n"           // SYS_EXIT_GROUP
         "syscall\n"                  // Exit
         "hlt\n"                      // Should never reach here
     );
@@ -1,6 +1,8 @@
 #include <platform.h>
 #include <base_types.h>
 #include <buddy.h>
+#include "platform_aio_sync.h"
+#include "platform_cycles.h"
 
 // =============================================================================
 // == macOS Implementation
@@ -23,12 +25,51 @@ extern void _exit(int status);
 extern int * __error(); // Returns pointer to errno
 extern int open(const char *path, int flags, ...);
 extern int close(int fd);
+extern int rename(const char *old_path, const char *new_path);
 extern int dup(int fd);
 extern int dup2(int oldfd, int newfd);
 extern int fcntl(int fd, int cmd, ...);
 extern ssize_t readv(int fd, const struct iovec *iov, int iovcnt);
 extern off_t lseek(int fd, off_t offset, int whence);
 extern int munmap(void *addr, size_t len);
+extern int madvise(void *addr, size_t len, int advice);
+extern ssize_t pread(int fd, void *buf, size_t nbyte, off_t offset);
+extern ssize_t pwrite(int fd, const void *buf, size_t nbyte, off_t offset);
+extern int isatty(int fd);
+
+// struct stat with 64-bit inodes (the only layout on arm64; on x86_64 it is
+// the $INODE64 variant of fstat).
+struct darwin_timespec {
+    long long tv_sec;
+    long tv_nsec;
+};
+
+struct darwin_stat {
+    int32_t st_dev;
+    uint16_t st_mode;
+    uint16_t st_nlink;
+    uint64_t st_ino;
+    uint32_t st_uid;
+    uint32_t st_gid;
+    int32_t st_rdev;
+    struct darwin_timespec st_atimespec;
+    struct darwin_timespec st_mtimespec;
+    struct darwin_timespec st_ctimespec;
+    struct darwin_timespec st_birthtimespec;
+    off_t st_size;
+    int64_t st_blocks;
+    int32_t st_blksize;
+    uint32_t st_flags;
+    uint32_t st_gen;
+    int32_t st_lspare;
+    int64_t st_qspare[2];
+};
+
+#if defined(__x86_64__)
+extern int fstat(int fd, struct darwin_stat *buf) __asm__("_fstat$INODE64");
+#else
+extern int fstat(int fd, struct darwin_stat *buf);
+#endif
 
 // Protection and mapping flags (macOS-specific values)
 #define PROT_NONE  0x00
@@ -39,6 +80,20 @@ extern int munmap(void *addr, size_t len);
 #define MAP_ANONYMOUS 0x1000  // Different from Linux
 #define MAP_FAILED ((void*)-1)
 
+// st_mode file type bits
+#define S_IFMT   0170000
+#define S_IFSOCK 0140000
+#define S_IFLNK  0120000
+#define S_IFREG  0100000
+#define S_IFBLK  0060000
+#define S_IFDIR  0040000
+#define S_IFCHR  0020000
+
+// madvise advice values
+#define MADV_RANDOM 1
+#define MADV_SEQUENTIAL 2
+#define MADV_WILLNEED 3
+
 // fcntl commands
 #define F_DUPFD 0
 
@@ -55,10 +110,16 @@ typedef struct {
     void* addr;
     size_t size;
     bool in_use;
+    uint32_t next_free;  // Next slot in the free list (index+1, 0 = end)
 } MmapHandle;
 
-#define MMAP_HANDLE_CAP 10
-static MmapHandle g_mmap_handles[MMAP_HANDLE_CAP] = {0};
+// Growable table of mappings; handles are slot index+1. Freed slots are kept
+// in a free list so acquiring and releasing a handle is O(1).
+#define MMAP_HANDLE_INITIAL_CAP 16
+static MmapHandle* g_mmap_handles = NULL;
+static uint32_t g_mmap_handle_cap = 0;
+static uint32_t g_mmap_handle_count = 0;  // Slots ever handed out
+static uint32_t g_mmap_free_head = 0;     // Free list head (index+1, 0 = empty)
 
 void ensure_heap_initialized() {
     if (linux_heap_base == NULL) {
@@ -140,10 +201,27 @@ float fast_sqrtf(float x) {
     return __builtin_sqrtf(x);
 }
 
+// Thread-local storage slot (a pthread key, created by platform_init)
+typedef unsigned long pthread_key_t;
+extern int pthread_key_create(pthread_key_t *key, void (*destructor)(void *));
+extern void* pthread_getspecific(pthread_key_t key);
+extern int pthread_setspecific(pthread_key_t key, const void *value);
+
+static pthread_key_t g_tls_key;
+
+void platform_tls_set(void *value) {
+    pthread_setspecific(g_tls_key, value);
+}
+
+void* platform_tls_get(void) {
+    return pthread_getspecific(g_tls_key);
+}
+
 // Public initialization function for manual use (e.g., SDL apps using external stdlib)
 void platform_init(int argc, char** argv) {
     stored_argc = argc;
     stored_argv = argv;
+    pthread_key_create(&g_tls_key, NULL);
     ensure_heap_initialized();
     buddy_init();
 }
@@ -213,6 +291,11 @@ int wasi_fd_close(wasi_fd_t fd) {
     return (result < 0) ? *__error() : 0;
 }
 
+int wasi_path_rename(const char* old_path, size_t old_path_len, const char* new_path, size_t new_path_len) {
+    int result = rename(old_path, new_path);
+    return (result < 0) ? *__error() : 0;
+}
+
 int wasi_fd_read(wasi_fd_t fd, const iovec_t* iovs, size_t iovs_len, size_t* nread) {
     ssize_t result = readv(fd, (const struct iovec*)iovs, (int)iovs_len);
     if (result < 0) {
@@ -243,6 +326,76 @@ int wasi_fd_tell(wasi_fd_t fd, uint64_t* offset) {
     return 0;  // Success
 }
 
+// pread/pwrite take a single buffer, so vectored requests are issued one
+// iovec at a time, stopping early on a short transfer like preadv would.
+int wasi_fd_pread(wasi_fd_t fd, const iovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nread) {
+    size_t total = 0;
+    for (size_t i = 0; i < iovs_len; i++) {
+        ssize_t result = pread(fd, iovs[i].iov_base, iovs[i].iov_len, (off_t)(offset + total));
+        if (result < 0) {
+            if (total > 0) break;
+            *nread = 0;
+            return *__error();  // Return errno
+        }
+        total += (size_t)result;
+        if ((size_t)result < iovs[i].iov_len) break;
+    }
+    *nread = total;
+    return 0;  // Success
+}
+
+int wasi_fd_pwrite(wasi_fd_t fd, const ciovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nwritten) {
+    size_t total = 0;
+    for (size_t i = 0; i < iovs_len; i++) {
+        ssize_t result = pwrite(fd, iovs[i].buf, iovs[i].buf_len, (off_t)(offset + total));
+        if (result < 0) {
+            if (total > 0) break;
+            *nwritten = 0;
+            return *__error();  // Return errno
+        }
+        total += (size_t)result;
+        if ((size_t)result < iovs[i].buf_len) break;
+    }
+    *nwritten = total;
+    return 0;  // Success
+}
+
+static uint8_t filetype_from_mode(uint32_t mode) {
+    switch (mode & S_IFMT) {
+        case S_IFREG:  return WASI_FILETYPE_REGULAR_FILE;
+        case S_IFDIR:  return WASI_FILETYPE_DIRECTORY;
+        case S_IFCHR:  return WASI_FILETYPE_CHARACTER_DEVICE;
+        case S_IFBLK:  return WASI_FILETYPE_BLOCK_DEVICE;
+        case S_IFLNK:  return WASI_FILETYPE_SYMBOLIC_LINK;
+        case S_IFSOCK: return WASI_FILETYPE_SOCKET_STREAM;
+        default:       return WASI_FILETYPE_UNKNOWN;
+    }
+}
+
+static uint64_t timespec_to_ns(struct darwin_timespec ts) {
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int wasi_fd_filestat_get(wasi_fd_t fd, filestat_t* stat) {
+    struct darwin_stat st;
+    if (fstat(fd, &st) < 0) {
+        return *__error();  // Return errno
+    }
+    stat->dev = (uint64_t)(uint32_t)st.st_dev;
+    stat->ino = st.st_ino;
+    stat->filetype = filetype_from_mode(st.st_mode);
+    stat->nlink = st.st_nlink;
+    stat->size = (uint64_t)st.st_size;
+    stat->atim = timespec_to_ns(st.st_atimespec);
+    stat->mtim = timespec_to_ns(st.st_mtimespec);
+    stat->ctim = timespec_to_ns(st.st_ctimespec);
+    return 0;  // Success
+}
+
+bool platform_fd_is_terminal(wasi_fd_t fd) {
+    return isatty(fd) == 1;
+}
+
 // Command line arguments implementation
 int wasi_args_sizes_get(size_t* argc, size_t* argv_buf_size) {
     *argc = (size_t)stored_argc;
@@ -271,7 +424,35 @@ int wasi_args_get(char** argv, char* argv_buf) {
     return 0;
 }
 
-bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **out_data, size_t *out_size) {
+// Returns a free slot index in the mmap handle table, growing the table from
+// buddy memory if needed. Returns -1 if the table cannot grow.
+static int64_t mmap_handle_acquire(void) {
+    if (g_mmap_free_head != 0) {
+        uint32_t idx = g_mmap_free_head - 1;
+        g_mmap_free_head = g_mmap_handles[idx].next_free;
+        return idx;
+    }
+    if (g_mmap_handle_count == g_mmap_handle_cap) {
+        uint32_t new_cap = g_mmap_handle_cap ? g_mmap_handle_cap * 2 : MMAP_HANDLE_INITIAL_CAP;
+        MmapHandle* new_handles = buddy_alloc(new_cap * sizeof(MmapHandle), NULL);
+        if (!new_handles) return -1;
+        for (uint32_t i = 0; i < g_mmap_handle_count; i++) {
+            new_handles[i] = g_mmap_handles[i];
+        }
+        if (g_mmap_handles) buddy_free(g_mmap_handles);
+        g_mmap_handles = new_handles;
+        g_mmap_handle_cap = new_cap;
+    }
+    return g_mmap_handle_count++;
+}
+
+static MmapHandle* mmap_handle_get(uint64_t handle) {
+    if (handle == 0 || handle > g_mmap_handle_count) return NULL;
+    MmapHandle* h = &g_mmap_handles[handle - 1];
+    return h->in_use ? h : NULL;
+}
+
+bool platform_read_file_mmap(const char *filename, uint32_t flags, uint64_t *out_handle, void **out_data, size_t *out_size) {
     if (!filename || !out_handle || !out_data || !out_size) return false;
     *out_handle = 0;
     *out_data = NULL;
@@ -282,17 +463,12 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
         return false;
     }
 
-    off_t end = lseek(fd, 0, WASI_SEEK_END);
-    if (end < 0) {
-        close(fd);
-        return false;
-    }
-
-    size_t file_size = (size_t)end;
-    if (lseek(fd, 0, WASI_SEEK_SET) < 0) {
+    filestat_t stat;
+    if (wasi_fd_filestat_get(fd, &stat) != 0) {
         close(fd);
         return false;
     }
+    size_t file_size = (size_t)stat.size;
 
     if (file_size == 0) {
         close(fd);
@@ -300,20 +476,20 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
         return true;
     }
 
-    void *addr = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    int prot = (flags & PLATFORM_MMAP_READONLY) ? PROT_READ : (PROT_READ | PROT_WRITE);
+    void *addr = mmap(NULL, file_size, prot, MAP_PRIVATE, fd, 0);
     close(fd);
     if (addr == MAP_FAILED) {
         return false;
     }
 
-    int slot = -1;
-    for (int i = 0; i < MMAP_HANDLE_CAP; i++) {
-        if (!g_mmap_handles[i].in_use) {
-            slot = i;
-            break;
-        }
+    // macOS has no MAP_POPULATE; ask for the pages to be read in instead
+    if (flags & PLATFORM_MMAP_POPULATE) {
+        madvise(addr, file_size, MADV_WILLNEED);
     }
-    if (slot == -1) {
+
+    int64_t slot = mmap_handle_acquire();
+    if (slot < 0) {
         munmap(addr, file_size);
         return false;
     }
@@ -321,6 +497,7 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
     g_mmap_handles[slot].addr = addr;
     g_mmap_handles[slot].size = file_size;
     g_mmap_handles[slot].in_use = true;
+    g_mmap_handles[slot].next_free = 0;
 
     *out_handle = (uint64_t)(slot + 1);
     *out_data = addr;
@@ -329,17 +506,166 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
 }
 
 void platform_file_unmap(uint64_t handle) {
-    if (handle == 0) return;
-    uint64_t idx = handle - 1;
-    if (idx >= MMAP_HANDLE_CAP) return;
-    MmapHandle *h = &g_mmap_handles[idx];
-    if (!h->in_use) return;
+    MmapHandle *h = mmap_handle_get(handle);
+    if (!h) return;
     if (h->addr && h->size > 0) {
         munmap(h->addr, h->size);
     }
     h->addr = NULL;
     h->size = 0;
     h->in_use = false;
+    h->next_free = g_mmap_free_head;
+    g_mmap_free_head = (uint32_t)handle;
+}
+
+bool platform_file_advise(uint64_t handle, uint32_t advice) {
+    MmapHandle *h = mmap_handle_get(handle);
+    if (!h) return false;
+    bool ok = true;
+    if (advice & PLATFORM_ADVISE_SEQUENTIAL) {
+        ok &= madvise(h->addr, h->size, MADV_SEQUENTIAL) == 0;
+    }
+    if (advice & PLATFORM_ADVISE_RANDOM) {
+        ok &= madvise(h->addr, h->size, MADV_RANDOM) == 0;
+    }
+    if (advice & PLATFORM_ADVISE_WILLNEED) {
+        ok &= madvise(h->addr, h->size, MADV_WILLNEED) == 0;
+    }
+    return ok;
+}
+
+// Asynchronous file I/O: synchronous fallback (see platform_aio_sync.h)
+bool platform_aio_init(uint32_t queue_depth) {
+    return aio_sync_init(queue_depth);
+}
+
+void platform_aio_shutdown(void) {
+    aio_sync_shutdown();
+}
+
+bool platform_aio_read(wasi_fd_t fd, void *buf, size_t len, uint64_t offset, uint64_t user_data) {
+    return aio_sync_rw(fd, buf, len, offset, user_data, false);
+}
+
+bool platform_aio_write(wasi_fd_t fd, const void *buf, size_t len, uint64_t offset, uint64_t user_data) {
+    return aio_sync_rw(fd, (void *)buf, len, offset, user_data, true);
+}
+
+uint32_t platform_aio_submit(void) {
+    return 0;
+}
+
+size_t platform_aio_poll(platform_aio_completion_t *out, size_t max) {
+    return aio_sync_poll(out, max);
+}
+
+size_t platform_aio_wait(platform_aio_completion_t *out, size_t max, size_t min_complete) {
+    // Every queued request has already completed
+    (void)min_complete;
+    return aio_sync_poll(out, max);
+}
+
+// Threads and futex
+
+typedef struct pthread_opaque *pthread_t;
+extern int pthread_create(pthread_t *thread, const void *attr, void *(*start_routine)(void *), void *arg);
+extern int pthread_join(pthread_t thread, void **retval);
+extern int sched_yield(void);
+extern int sysctlbyname(const char *name, void *oldp, size_t *oldlenp, void *newp, size_t newlen);
+
+// Private but stable libSystem futex interface (used by libc++ and the
+// Swift runtime for the same purpose).
+extern int __ulock_wait(uint32_t operation, void *addr, uint64_t value, uint32_t timeout_us);
+extern int __ulock_wake(uint32_t operation, void *addr, uint64_t wake_value);
+#define UL_COMPARE_AND_WAIT 1
+#define ULF_WAKE_ALL 0x00000100
+#define ULF_NO_ERRNO 0x01000000
+
+void platform_futex_wait(volatile uint32_t *addr, uint32_t expected) {
+    __ulock_wait(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, (void *)addr, expected, 0);
+}
+
+void platform_futex_wake_one(volatile uint32_t *addr) {
+    __ulock_wake(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, (void *)addr, 0);
+}
+
+void platform_futex_wake_all(volatile uint32_t *addr) {
+    __ulock_wake(UL_COMPARE_AND_WAIT | ULF_WAKE_ALL | ULF_NO_ERRNO, (void *)addr, 0);
+}
+
+void platform_thread_yield(void) {
+    sched_yield();
+}
+
+uint32_t platform_cpu_count(void) {
+    int count = 0;
+    size_t len = sizeof(count);
+    if (sysctlbyname("hw.activecpu", &count, &len, NULL, 0) != 0 || count < 1) return 1;
+    return (uint32_t)count;
+}
+
+typedef struct {
+    pthread_t id;
+    platform_thread_fn fn;
+    void *arg;
+    int result;
+} MacThread;
+
+static void *mac_thread_entry(void *param) {
+    MacThread *t = param;
+    t->result = t->fn(t->arg);
+    return NULL;
+}
+
+bool platform_thread_create(platform_thread_t *thread, platform_thread_fn fn, void *arg) {
+    MacThread *t = buddy_alloc(sizeof(MacThread), NULL);
+    if (!t) return false;
+    t->fn = fn;
+    t->arg = arg;
+    t->result = 0;
+    if (pthread_create(&t->id, NULL, mac_thread_entry, t) != 0) {
+        buddy_free(t);
+        return false;
+    }
+    *thread = (platform_thread_t)(uintptr_t)t;
+    return true;
+}
+
+int platform_thread_join(platform_thread_t thread) {
+    MacThread *t = (MacThread *)(uintptr_t)thread;
+    pthread_join(t->id, NULL);
+    int result = t->result;
+    buddy_free(t);
+    return result;
+}
+
+// Time
+
+typedef struct {
+    uint32_t numer;
+    uint32_t denom;
+} mach_timebase_info_data_t;
+
+extern uint64_t mach_absolute_time(void);
+extern int mach_timebase_info(mach_timebase_info_data_t *info);
+
+static mach_timebase_info_data_t g_timebase = {0};
+
+uint64_t platform_now_ns(void) {
+    // Ticks are nanoseconds on Intel, 1/24 MHz (numer/denom = 125/3) on Apple
+    // silicon. Split the conversion so that the multiplication cannot overflow.
+    if (g_timebase.denom == 0) mach_timebase_info(&g_timebase);
+    uint64_t ticks = mach_absolute_time();
+    return ticks / g_timebase.denom * g_timebase.numer +
+           ticks % g_timebase.denom * g_timebase.numer / g_timebase.denom;
+}
+
+uint64_t platform_cycles(void) {
+    return cycles_read();
+}
+
+uint64_t platform_cycle_frequency(void) {
+    return cycles_frequency();
 }
 
 #ifndef PLATFORM_SKIP_ENTRY
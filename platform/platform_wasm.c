@@ -1,6 +1,8 @@
 #include <platform.h>
 #include <base_types.h>
 #include <buddy.h>
+#include "platform_aio_sync.h"
+#include "platform_cycles.h"
 
 #define WASI(name) __attribute__((__import_module__("wasi_snapshot_preview1"), __import_name__(#name))) name
 
@@ -8,11 +10,16 @@ uint32_t WASI(fd_write)(int fd, const ciovec_t* iovs, size_t iovs_len, size_t* n
 void WASI(proc_exit)(int status);
 int WASI(path_open)(int dirfd, int dirflags, const char* path, size_t path_len, int oflags, uint64_t fs_rights_base, uint64_t fs_rights_inheriting, int fdflags, int* fd);
 int WASI(fd_close)(int fd);
+int WASI(path_rename)(int old_dirfd, const char* old_path, size_t old_path_len, int new_dirfd, const char* new_path, size_t new_path_len);
 int WASI(fd_read)(int fd, const iovec_t* iovs, size_t iovs_len, size_t* nread);
 int WASI(fd_seek)(int fd, int64_t offset, int whence, uint64_t* newoffset);
 int WASI(fd_tell)(int fd, uint64_t* offset);
+int WASI(fd_pread)(int fd, const iovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nread);
+int WASI(fd_pwrite)(int fd, const ciovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nwritten);
+int WASI(fd_filestat_get)(int fd, filestat_t* buf);
 int WASI(args_sizes_get)(size_t* argc, size_t* argv_buf_size);
 int WASI(args_get)(char** argv, char* argv_buf);
+int WASI(clock_time_get)(uint32_t clock_id, uint64_t precision, uint64_t* time);
 
 #undef WASI
 
@@ -95,6 +102,10 @@ int wasi_fd_close(wasi_fd_t fd) {
     return fd_close(fd);
 }
 
+int wasi_path_rename(const char* old_path, size_t old_path_len, const char* new_path, size_t new_path_len) {
+    return path_rename(3, old_path, old_path_len, 3, new_path, new_path_len);  // Both in the preopen
+}
+
 int wasi_fd_read(wasi_fd_t fd, const iovec_t* iovs, size_t iovs_len, size_t* nread) {
     return fd_read(fd, iovs, iovs_len, nread);
 }
@@ -107,6 +118,26 @@ int wasi_fd_tell(wasi_fd_t fd, uint64_t* offset) {
     return fd_tell(fd, offset);
 }
 
+int wasi_fd_pread(wasi_fd_t fd, const iovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nread) {
+    return fd_pread(fd, iovs, iovs_len, offset, nread);
+}
+
+int wasi_fd_pwrite(wasi_fd_t fd, const ciovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nwritten) {
+    return fd_pwrite(fd, iovs, iovs_len, offset, nwritten);
+}
+
+// filestat_t mirrors __wasi_filestat_t, so the host writes it directly.
+_Static_assert(sizeof(filestat_t) == 64, "filestat_t must match __wasi_filestat_t");
+
+int wasi_fd_filestat_get(wasi_fd_t fd, filestat_t* stat) {
+    return fd_filestat_get(fd, stat);
+}
+
+bool platform_fd_is_terminal(wasi_fd_t fd) {
+    filestat_t stat;
+    return fd_filestat_get(fd, &stat) == 0 && stat.filetype == WASI_FILETYPE_CHARACTER_DEVICE;
+}
+
 // Command line arguments implementation
 int wasi_args_sizes_get(size_t* argc, size_t* argv_buf_size) {
     return args_sizes_get(argc, argv_buf_size);
@@ -128,8 +159,9 @@ float fast_sqrtf(float x) {
     return __builtin_sqrtf(x);
 }
 
-bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **out_data, size_t *out_size) {
+bool platform_read_file_mmap(const char *filename, uint32_t flags, uint64_t *out_handle, void **out_data, size_t *out_size) {
     (void)filename;
+    (void)flags;
     if (out_handle) *out_handle = 0;
     if (out_data) *out_data = NULL;
     if (out_size) *out_size = 0;
@@ -140,6 +172,110 @@ void platform_file_unmap(uint64_t handle) {
     (void)handle;
 }
 
+bool platform_file_advise(uint64_t handle, uint32_t advice) {
+    (void)handle;
+    (void)advice;
+    return false;
+}
+
+// Asynchronous file I/O: synchronous fallback (see platform_aio_sync.h)
+bool platform_aio_init(uint32_t queue_depth) {
+    return aio_sync_init(queue_depth);
+}
+
+void platform_aio_shutdown(void) {
+    aio_sync_shutdown();
+}
+
+bool platform_aio_read(wasi_fd_t fd, void *buf, size_t len, uint64_t offset, uint64_t user_data) {
+    return aio_sync_rw(fd, buf, len, offset, user_data, false);
+}
+
+bool platform_aio_write(wasi_fd_t fd, const void *buf, size_t len, uint64_t offset, uint64_t user_data) {
+    return aio_sync_rw(fd, (void *)buf, len, offset, user_data, true);
+}
+
+uint32_t platform_aio_submit(void) {
+    return 0;
+}
+
+size_t platform_aio_poll(platform_aio_completion_t *out, size_t max) {
+    return aio_sync_poll(out, max);
+}
+
+size_t platform_aio_wait(platform_aio_completion_t *out, size_t max, size_t min_complete) {
+    // Every queued request has already completed
+    (void)min_complete;
+    return aio_sync_poll(out, max);
+}
+
+// Threads and futex
+//
+// The module is built without shared memory, so there are no other threads
+// (wasi-threads needs -matomics, a shared imported memory and runtime
+// support). A futex wait can only be satisfied by this thread, so it returns
+// immediately as a spurious wakeup.
+
+void platform_futex_wait(volatile uint32_t *addr, uint32_t expected) {
+    (void)addr;
+    (void)expected;
+}
+
+void platform_futex_wake_one(volatile uint32_t *addr) {
+    (void)addr;
+}
+
+void platform_futex_wake_all(volatile uint32_t *addr) {
+    (void)addr;
+}
+
+void platform_thread_yield(void) {
+}
+
+uint32_t platform_cpu_count(void) {
+    return 1;
+}
+
+static void* g_tls_slot = NULL;
+
+void platform_tls_set(void *value) {
+    g_tls_slot = value;
+}
+
+void* platform_tls_get(void) {
+    return g_tls_slot;
+}
+
+bool platform_thread_create(platform_thread_t *thread, platform_thread_fn fn, void *arg) {
+    (void)fn;
+    (void)arg;
+    *thread = 0;
+    return false;
+}
+
+int platform_thread_join(platform_thread_t thread) {
+    (void)thread;
+    return 0;
+}
+
+// Time
+
+#define WASI_CLOCK_MONOTONIC 1
+
+uint64_t platform_now_ns(void) {
+    uint64_t time = 0;
+    clock_time_get(WASI_CLOCK_MONOTONIC, 1, &time);
+    return time;
+}
+
+uint64_t platform_cycles(void) {
+    return cycles_read();
+}
+
+uint64_t platform_cycle_frequency(void) {
+    return cycles_frequency();
+}
+
 // Public initialization function for manual use (e.g., SDL apps using external stdlib)
 void platform_init(int argc, char** argv) {
     buddy_init();
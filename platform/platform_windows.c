@@ -1,6 +1,8 @@
 #include <platform.h>
 #include <base_types.h>
 #include <buddy.h>
+#include "platform_aio_sync.h"
+#include "platform_cycles.h"
 
 // =============================================================================
 // == Windows Implementation (MSVC)
@@ -29,6 +31,7 @@ typedef union {
 #define STD_ERROR_HANDLE ((DWORD)-12)
 #define MEM_COMMIT 0x1000
 #define MEM_RESERVE 0x2000
+#define PAGE_READONLY 0x02
 #define PAGE_READWRITE 0x04
 #define INVALID_HANDLE_VALUE ((HANDLE)(long long)-1)
 #define GENERIC_READ 0x80000000
@@ -47,6 +50,13 @@ typedef union {
 #define FILE_FLAG_SEQUENTIAL_SCAN 0x08000000
 #define FILE_MAP_COPY 0x00000001
 #define FILE_MAP_WRITE 0x00000002
+#define FILE_MAP_READ 0x00000004
+#define FILE_ATTRIBUTE_DIRECTORY 0x00000010
+#define FILE_TYPE_DISK 0x0001
+#define FILE_TYPE_CHAR 0x0002
+#define FILE_TYPE_PIPE 0x0003
+#define ERROR_HANDLE_EOF 38
+#define INFINITE 0xFFFFFFFF
 #ifndef SIZE_MAX
 #define SIZE_MAX ((size_t)-1)
 #endif
@@ -58,6 +68,7 @@ __declspec(dllimport) LPVOID __stdcall VirtualAlloc(LPVOID lpAddress, SIZE_T dwS
 __declspec(dllimport) void __stdcall ExitProcess(unsigned int uExitCode);
 __declspec(dllimport) HANDLE __stdcall CreateFileA(const char* lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, void* lpSecurityAttributes, DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile);
 __declspec(dllimport) int __stdcall CloseHandle(HANDLE hObject);
+__declspec(dllimport) int __stdcall MoveFileExA(const char* lpExistingFileName, const char* lpNewFileName, DWORD dwFlags);
 __declspec(dllimport) int __stdcall ReadFile(HANDLE hFile, LPVOID lpBuffer, DWORD nNumberOfBytesToRead, LPDWORD lpNumberOfBytesRead, void* lpOverlapped);
 __declspec(dllimport) int __stdcall SetFilePointerEx(HANDLE hFile, LARGE_INTEGER liDistanceToMove, LARGE_INTEGER* lpNewFilePointer, DWORD dwMoveMethod);
 __declspec(dllimport) wchar_t* __stdcall GetCommandLineW(void);
@@ -67,6 +78,71 @@ __declspec(dllimport) HANDLE __stdcall CreateFileMappingA(HANDLE hFile, void* lp
 __declspec(dllimport) LPVOID __stdcall MapViewOfFile(HANDLE hFileMappingObject, DWORD dwDesiredAccess, DWORD dwFileOffsetHigh, DWORD dwFileOffsetLow, size_t dwNumberOfBytesToMap);
 __declspec(dllimport) int __stdcall UnmapViewOfFile(LPCVOID lpBaseAddress);
 __declspec(dllimport) int __stdcall GetFileSizeEx(HANDLE hFile, LARGE_INTEGER* lpFileSize);
+__declspec(dllimport) HANDLE __stdcall GetCurrentProcess(void);
+__declspec(dllimport) DWORD __stdcall GetLastError(void);
+
+typedef struct {
+    DWORD dwLowDateTime;
+    DWORD dwHighDateTime;
+} FILETIME;
+
+typedef struct {
+    DWORD    dwFileAttributes;
+    FILETIME ftCreationTime;
+    FILETIME ftLastAccessTime;
+    FILETIME ftLastWriteTime;
+    DWORD    dwVolumeSerialNumber;
+    DWORD    nFileSizeHigh;
+    DWORD    nFileSizeLow;
+    DWORD    nNumberOfLinks;
+    DWORD    nFileIndexHigh;
+    DWORD    nFileIndexLow;
+} BY_HANDLE_FILE_INFORMATION;
+__declspec(dllimport) int __stdcall GetFileInformationByHandle(HANDLE hFile, BY_HANDLE_FILE_INFORMATION* lpFileInformation);
+__declspec(dllimport) DWORD __stdcall GetFileType(HANDLE hFile);
+__declspec(dllimport) int __stdcall GetConsoleMode(HANDLE hConsoleHandle, LPDWORD lpMode);
+
+typedef unsigned short WORD;
+typedef struct {
+    WORD      wProcessorArchitecture;
+    WORD      wReserved;
+    DWORD     dwPageSize;
+    LPVOID    lpMinimumApplicationAddress;
+    LPVOID    lpMaximumApplicationAddress;
+    SIZE_T    dwActiveProcessorMask;
+    DWORD     dwNumberOfProcessors;
+    DWORD     dwProcessorType;
+    DWORD     dwAllocationGranularity;
+    WORD      wProcessorLevel;
+    WORD      wProcessorRevision;
+} SYSTEM_INFO;
+__declspec(dllimport) void __stdcall GetSystemInfo(SYSTEM_INFO* lpSystemInfo);
+__declspec(dllimport) int __stdcall QueryPerformanceCounter(LARGE_INTEGER* lpPerformanceCount);
+__declspec(dllimport) int __stdcall QueryPerformanceFrequency(LARGE_INTEGER* lpFrequency);
+__declspec(dllimport) HANDLE __stdcall CreateThread(void* lpThreadAttributes, SIZE_T dwStackSize, DWORD (__stdcall *lpStartAddress)(LPVOID), LPVOID lpParameter, DWORD dwCreationFlags, LPDWORD lpThreadId);
+__declspec(dllimport) DWORD __stdcall WaitForSingleObject(HANDLE hHandle, DWORD dwMilliseconds);
+__declspec(dllimport) int __stdcall SwitchToThread(void);
+__declspec(dllimport) DWORD __stdcall TlsAlloc(void);
+__declspec(dllimport) LPVOID __stdcall TlsGetValue(DWORD dwTlsIndex);
+__declspec(dllimport) int __stdcall TlsSetValue(DWORD dwTlsIndex, LPVOID lpTlsValue);
+// From synchronization.lib (API-MS-Win-Core-Synch-l1-2-0)
+__declspec(dllimport) int __stdcall WaitOnAddress(volatile void* Address, void* CompareAddress, SIZE_T AddressSize, DWORD dwMilliseconds);
+__declspec(dllimport) void __stdcall WakeByAddressSingle(void* Address);
+__declspec(dllimport) void __stdcall WakeByAddressAll(void* Address);
+
+typedef struct {
+    SIZE_T Internal;
+    SIZE_T InternalHigh;
+    DWORD  Offset;
+    DWORD  OffsetHigh;
+    HANDLE hEvent;
+} OVERLAPPED;
+
+typedef struct {
+    void   *VirtualAddress;
+    SIZE_T  NumberOfBytes;
+} WIN32_MEMORY_RANGE_ENTRY;
+__declspec(dllimport) int __stdcall PrefetchVirtualMemory(HANDLE hProcess, SIZE_T NumberOfEntries, WIN32_MEMORY_RANGE_ENTRY* VirtualAddresses, DWORD Flags);
 
 // Our emulated heap state for Windows
 static uint8_t* windows_heap_base = NULL;
@@ -84,10 +160,16 @@ typedef struct {
     HANDLE  hMapping;
     size_t  size;
     bool    in_use;
+    uint32_t next_free;  // Next slot in the free list (index+1, 0 = end)
 } MmapHandle;
 
-#define MMAP_HANDLE_CAP 10
-static MmapHandle g_mmap_handles[MMAP_HANDLE_CAP] = {0};
+// Growable table of mappings; handles are slot index+1. Freed slots are kept
+// in a free list so acquiring and releasing a handle is O(1).
+#define MMAP_HANDLE_INITIAL_CAP 16
+static MmapHandle* g_mmap_handles = NULL;
+static uint32_t g_mmap_handle_cap = 0;
+static uint32_t g_mmap_handle_count = 0;  // Slots ever handed out
+static uint32_t g_mmap_free_head = 0;     // Free list head (index+1, 0 = empty)
 
 // Emulation of `fd_write` using Windows WriteFile API
 uint32_t wasi_fd_write(int fd, const ciovec_t* iovs, size_t iovs_len, size_t* nwritten) {
@@ -237,8 +319,20 @@ float fast_sqrtf(float x) {
     return x * y;  // Convert inverse sqrt to sqrt
 }
 
+// Thread-local storage slot (a TLS index, allocated by platform_init)
+static DWORD g_tls_index;
+
+void platform_tls_set(void *value) {
+    TlsSetValue(g_tls_index, value);
+}
+
+void* platform_tls_get(void) {
+    return TlsGetValue(g_tls_index);
+}
+
 // Public initialization function for manual use (e.g., SDL apps using external stdlib)
 void platform_init(int argc, char** argv) {
+    g_tls_index = TlsAlloc();
     init_args();
     ensure_heap_initialized();
     buddy_init();
@@ -298,6 +392,12 @@ int wasi_fd_close(wasi_fd_t fd) {
     return CloseHandle(handle) ? 0 : 1;  // Return 0 on success, non-zero on error
 }
 
+#define MOVEFILE_REPLACE_EXISTING 0x1
+
+int wasi_path_rename(const char* old_path, size_t old_path_len, const char* new_path, size_t new_path_len) {
+    return MoveFileExA(old_path, new_path, MOVEFILE_REPLACE_EXISTING) ? 0 : 1;  // Return 0 on success, non-zero on error
+}
+
 int wasi_fd_read(wasi_fd_t fd, const iovec_t* iovs, size_t iovs_len, size_t* nread) {
     HANDLE handle;
 
@@ -369,6 +469,108 @@ int wasi_fd_tell(wasi_fd_t fd, uint64_t* offset) {
     return 0;  // Success
 }
 
+// Maps a wasi fd to its HANDLE, resolving the standard streams.
+static HANDLE handle_from_fd(wasi_fd_t fd) {
+    if (fd == WASI_STDIN_FD) return GetStdHandle(STD_INPUT_HANDLE);
+    if (fd == WASI_STDOUT_FD) return GetStdHandle(STD_OUTPUT_HANDLE);
+    if (fd == WASI_STDERR_FD) return GetStdHandle(STD_ERROR_HANDLE);
+    return (HANDLE)(long long)fd;
+}
+
+// ReadFile/WriteFile on a synchronous handle with an OVERLAPPED offset act as
+// pread/pwrite, except that the file pointer is left after the transfer.
+int wasi_fd_pread(wasi_fd_t fd, const iovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nread) {
+    HANDLE handle = handle_from_fd(fd);
+    if (handle == INVALID_HANDLE_VALUE) {
+        *nread = 0;
+        return 1;  // Error
+    }
+
+    size_t total_read = 0;
+    for (size_t i = 0; i < iovs_len; i++) {
+        uint64_t pos = offset + total_read;
+        OVERLAPPED ov = {0};
+        ov.Offset = (DWORD)pos;
+        ov.OffsetHigh = (DWORD)(pos >> 32);
+        DWORD bytes_read = 0;
+        if (!ReadFile(handle, iovs[i].iov_base, (DWORD)iovs[i].iov_len, &bytes_read, &ov)) {
+            if (GetLastError() == ERROR_HANDLE_EOF) break;  // Reading at or past EOF
+            *nread = total_read;
+            return 1;  // Error
+        }
+        total_read += bytes_read;
+        if (bytes_read < iovs[i].iov_len) break;  // Short read, stop here
+    }
+
+    *nread = total_read;
+    return 0;  // Success
+}
+
+int wasi_fd_pwrite(wasi_fd_t fd, const ciovec_t* iovs, size_t iovs_len, uint64_t offset, size_t* nwritten) {
+    HANDLE handle = handle_from_fd(fd);
+    if (handle == INVALID_HANDLE_VALUE) {
+        *nwritten = 0;
+        return 1;  // Error
+    }
+
+    size_t total_written = 0;
+    for (size_t i = 0; i < iovs_len; i++) {
+        uint64_t pos = offset + total_written;
+        OVERLAPPED ov = {0};
+        ov.Offset = (DWORD)pos;
+        ov.OffsetHigh = (DWORD)(pos >> 32);
+        DWORD bytes_written = 0;
+        if (!WriteFile(handle, iovs[i].buf, (DWORD)iovs[i].buf_len, &bytes_written, &ov)) {
+            *nwritten = total_written;
+            return 1;  // Error
+        }
+        total_written += bytes_written;
+        if (bytes_written < iovs[i].buf_len) break;
+    }
+
+    *nwritten = total_written;
+    return 0;  // Success
+}
+
+// FILETIME counts 100ns intervals since 1601-01-01.
+static uint64_t filetime_to_unix_ns(FILETIME ft) {
+    uint64_t ticks = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    const uint64_t epoch_delta = 116444736000000000ULL;  // 1601 -> 1970 in 100ns
+    return ticks < epoch_delta ? 0 : (ticks - epoch_delta) * 100;
+}
+
+int wasi_fd_filestat_get(wasi_fd_t fd, filestat_t* stat) {
+    HANDLE handle = handle_from_fd(fd);
+    if (handle == INVALID_HANDLE_VALUE) return 1;  // Error
+
+    *stat = (filestat_t){0};
+    DWORD type = GetFileType(handle);
+    if (type != FILE_TYPE_DISK) {
+        // Consoles and pipes have no file information
+        stat->filetype = (type == FILE_TYPE_CHAR) ? WASI_FILETYPE_CHARACTER_DEVICE : WASI_FILETYPE_UNKNOWN;
+        return 0;  // Success
+    }
+
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(handle, &info)) return 1;  // Error
+    stat->dev = info.dwVolumeSerialNumber;
+    stat->ino = ((uint64_t)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+    stat->filetype = (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? WASI_FILETYPE_DIRECTORY : WASI_FILETYPE_REGULAR_FILE;
+    stat->nlink = info.nNumberOfLinks;
+    stat->size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    stat->atim = filetime_to_unix_ns(info.ftLastAccessTime);
+    stat->mtim = filetime_to_unix_ns(info.ftLastWriteTime);
+    stat->ctim = stat->mtim;  // No status change time on Windows
+    return 0;  // Success
+}
+
+// NUL is a character device too, but only consoles have a console mode
+bool platform_fd_is_terminal(wasi_fd_t fd) {
+    HANDLE handle = handle_from_fd(fd);
+    DWORD mode;
+    return handle != INVALID_HANDLE_VALUE && GetConsoleMode(handle, &mode) != 0;
+}
+
 // Helper: Convert UTF-16 wide char to UTF-8
 // Returns number of bytes written (1-3 for BMP), or 0 on error
 // Note: This handles Basic Multilingual Plane only (wchar_t is 16-bit on Windows)
@@ -487,15 +689,51 @@ int wasi_args_get(char** argv, char* argv_buf) {
     return 0;
 }
 
-bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **out_data, size_t *out_size) {
+// Returns a free slot index in the mmap handle table, growing the table from
+// buddy memory if needed. Returns -1 if the table cannot grow.
+static int64_t mmap_handle_acquire(void) {
+    if (g_mmap_free_head != 0) {
+        uint32_t idx = g_mmap_free_head - 1;
+        g_mmap_free_head = g_mmap_handles[idx].next_free;
+        return idx;
+    }
+    if (g_mmap_handle_count == g_mmap_handle_cap) {
+        uint32_t new_cap = g_mmap_handle_cap ? g_mmap_handle_cap * 2 : MMAP_HANDLE_INITIAL_CAP;
+        MmapHandle* new_handles = buddy_alloc(new_cap * sizeof(MmapHandle), NULL);
+        if (!new_handles) return -1;
+        for (uint32_t i = 0; i < g_mmap_handle_count; i++) {
+            new_handles[i] = g_mmap_handles[i];
+        }
+        if (g_mmap_handles) buddy_free(g_mmap_handles);
+        g_mmap_handles = new_handles;
+        g_mmap_handle_cap = new_cap;
+    }
+    return g_mmap_handle_count++;
+}
+
+static MmapHandle* mmap_handle_get(uint64_t handle) {
+    if (handle == 0 || handle > g_mmap_handle_count) return NULL;
+    MmapHandle* h = &g_mmap_handles[handle - 1];
+    return h->in_use ? h : NULL;
+}
+
+static bool prefetch_view(void *view, size_t size) {
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = view;
+    range.NumberOfBytes = size;
+    return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != 0;
+}
+
+bool platform_read_file_mmap(const char *filename, uint32_t flags, uint64_t *out_handle, void **out_data, size_t *out_size) {
     if (!filename || !out_handle || !out_data || !out_size) return false;
     *out_handle = 0;
     *out_data = NULL;
     *out_size = 0;
 
+    bool readonly = (flags & PLATFORM_MMAP_READONLY) != 0;
     HANDLE hFile = CreateFileA(
         filename,
-        GENERIC_READ | GENERIC_WRITE,
+        readonly ? GENERIC_READ : (GENERIC_READ | GENERIC_WRITE),
         FILE_SHARE_READ,
         NULL,
         OPEN_EXISTING,
@@ -523,7 +761,7 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
     HANDLE hMapping = CreateFileMappingA(
         hFile,
         NULL,
-        PAGE_READWRITE,
+        readonly ? PAGE_READONLY : PAGE_READWRITE,
         0, 0,
         NULL
     );
@@ -534,7 +772,7 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
 
     void *view = MapViewOfFile(
         hMapping,
-        FILE_MAP_COPY | FILE_MAP_WRITE,
+        readonly ? FILE_MAP_READ : (FILE_MAP_COPY | FILE_MAP_WRITE),
         0, 0, 0
     );
     if (!view) {
@@ -543,14 +781,12 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
         return false;
     }
 
-    int slot = -1;
-    for (int i = 0; i < MMAP_HANDLE_CAP; i++) {
-        if (!g_mmap_handles[i].in_use) {
-            slot = i;
-            break;
-        }
+    if (flags & PLATFORM_MMAP_POPULATE) {
+        prefetch_view(view, file_size);
     }
-    if (slot == -1) {
+
+    int64_t slot = mmap_handle_acquire();
+    if (slot < 0) {
         UnmapViewOfFile(view);
         CloseHandle(hMapping);
         CloseHandle(hFile);
@@ -562,6 +798,7 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
     g_mmap_handles[slot].hMapping = hMapping;
     g_mmap_handles[slot].size = file_size;
     g_mmap_handles[slot].in_use = true;
+    g_mmap_handles[slot].next_free = 0;
 
     *out_handle = (uint64_t)(slot + 1);
     *out_data = view;
@@ -570,13 +807,8 @@ bool platform_read_file_mmap(const char *filename, uint64_t *out_handle, void **
 }
 
 void platform_file_unmap(uint64_t handle) {
-    if (handle == 0) return;
-
-    uint64_t idx = handle - 1;
-    if (idx >= MMAP_HANDLE_CAP) return;
-
-    MmapHandle *internal = &g_mmap_handles[idx];
-    if (!internal->in_use) return;
+    MmapHandle *internal = mmap_handle_get(handle);
+    if (!internal) return;
 
     if (internal->view) {
         UnmapViewOfFile(internal->view);
@@ -592,6 +824,134 @@ void platform_file_unmap(uint64_t handle) {
     internal->hMapping = NULL;
     internal->size = 0;
     internal->in_use = false;
+    internal->next_free = g_mmap_free_head;
+    g_mmap_free_head = (uint32_t)handle;
+}
+
+bool platform_file_advise(uint64_t handle, uint32_t advice) {
+    MmapHandle *internal = mmap_handle_get(handle);
+    if (!internal) return false;
+    // Sequential read ahead is requested when the file is opened
+    // (FILE_FLAG_SEQUENTIAL_SCAN) and Windows has no per-view equivalent of
+    // MADV_RANDOM, so only WILLNEED does any work here.
+    if (advice & PLATFORM_ADVISE_WILLNEED) {
+        return prefetch_view(internal->view, internal->size);
+    }
+    return true;
+}
+
+// Asynchronous file I/O: synchronous fallback (see platform_aio_sync.h)
+bool platform_aio_init(uint32_t queue_depth) {
+    return aio_sync_init(queue_depth);
+}
+
+void platform_aio_shutdown(void) {
+    aio_sync_shutdown();
+}
+
+bool platform_aio_read(wasi_fd_t fd, void *buf, size_t len, uint64_t offset, uint64_t user_data) {
+    return aio_sync_rw(fd, buf, len, offset, user_data, false);
+}
+
+bool platform_aio_write(wasi_fd_t fd, const void *buf, size_t len, uint64_t offset, uint64_t user_data) {
+    return aio_sync_rw(fd, (void *)buf, len, offset, user_data, true);
+}
+
+uint32_t platform_aio_submit(void) {
+    return 0;
+}
+
+size_t platform_aio_poll(platform_aio_completion_t *out, size_t max) {
+    return aio_sync_poll(out, max);
+}
+
+size_t platform_aio_wait(platform_aio_completion_t *out, size_t max, size_t min_complete) {
+    // Every queued request has already completed
+    (void)min_complete;
+    return aio_sync_poll(out, max);
+}
+
+// Threads and futex
+
+void platform_futex_wait(volatile uint32_t *addr, uint32_t expected) {
+    WaitOnAddress(addr, &expected, sizeof(expected), INFINITE);
+}
+
+void platform_futex_wake_one(volatile uint32_t *addr) {
+    WakeByAddressSingle((void *)addr);
+}
+
+void platform_futex_wake_all(volatile uint32_t *addr) {
+    WakeByAddressAll((void *)addr);
+}
+
+void platform_thread_yield(void) {
+    SwitchToThread();
+}
+
+uint32_t platform_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+}
+
+typedef struct {
+    HANDLE handle;
+    platform_thread_fn fn;
+    void *arg;
+    int result;
+} WindowsThread;
+
+static DWORD __stdcall windows_thread_entry(LPVOID param) {
+    WindowsThread *t = param;
+    t->result = t->fn(t->arg);
+    return 0;
+}
+
+bool platform_thread_create(platform_thread_t *thread, platform_thread_fn fn, void *arg) {
+    WindowsThread *t = buddy_alloc(sizeof(WindowsThread), NULL);
+    if (!t) return false;
+    t->fn = fn;
+    t->arg = arg;
+    t->result = 0;
+    t->handle = CreateThread(NULL, 0, windows_thread_entry, t, 0, NULL);
+    if (!t->handle) {
+        buddy_free(t);
+        return false;
+    }
+    *thread = (platform_thread_t)(uintptr_t)t;
+    return true;
+}
+
+int platform_thread_join(platform_thread_t thread) {
+    WindowsThread *t = (WindowsThread *)(uintptr_t)thread;
+    WaitForSingleObject(t->handle, INFINITE);
+    CloseHandle(t->handle);
+    int result = t->result;
+    buddy_free(t);
+    return result;
+}
+
+// Time
+
+static LARGE_INTEGER g_qpc_frequency = {0};
+
+uint64_t platform_now_ns(void) {
+    if (g_qpc_frequency.QuadPart == 0) QueryPerformanceFrequency(&g_qpc_frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    // Split the conversion so that the multiplication cannot overflow
+    uint64_t ticks = (uint64_t)counter.QuadPart;
+    uint64_t frequency = (uint64_t)g_qpc_frequency.QuadPart;
+    return ticks / frequency * 1000000000ull + ticks % frequency * 1000000000ull / frequency;
+}
+
+uint64_t platform_cycles(void) {
+    return cycles_read();
+}
+
+uint64_t platform_cycle_frequency(void) {
+    return cycles_frequency();
 }
 
 #ifndef PLATFORM_SKIP_ENTRY
@@ -18,7 +18,10 @@
 #include <base/mem.h>
 #include <base/base_string.h>
 #include <base/base_math.h>
+#include <base/hash.h>
 #include <base/scratch.h>
+#include <base/jobs.h>
+#include <base/profile.h>
 #include <platform/platform.h>
 
 #define CGLTF_IMPLEMENTATION
@@ -37,10 +40,9 @@
 #define CEILING_LIGHT_MODEL_SCALE 0.5f
 #define CEILING_LIGHT_SURFACE_TYPE 7.0f
 
-// Buffer limits
-#define MAX_SCENE_VERTICES 40000
-#define MAX_GENERATED_VERTICES 40000
-#define MAX_GENERATED_INDICES 48000
+// Buffer limits. Generated geometry grows in the builder's arena, so only
+// loaded models and the mesh table have fixed sizes.
+#define MAX_SCENE_MESHES 64
 #define OBJ_MAX_VERTICES 20000
 #define OBJ_MAX_INDICES 20000
 #define OBJ_MAX_TEMP_VERTICES 8000
@@ -56,7 +58,7 @@ typedef struct {
     float *normals;
     float *surface_types;
     float *triangle_ids;
-    uint16_t *indices;
+    uint32_t *indices;
     uint32_t position_count;
     uint32_t uv_count;
     uint32_t normal_count;
@@ -71,7 +73,12 @@ typedef struct {
     float *normals;
     float *surface_types;
     float *triangle_ids;
-    uint16_t *indices;
+    uint32_t *indices;
+
+    // Room in the arrays above, grown in `arena` by mesh_gen_reserve
+    Arena *arena;
+    uint32_t vertex_capacity;
+    uint32_t index_capacity;
 
     uint32_t position_idx;
     uint32_t uv_idx;
@@ -80,7 +87,7 @@ typedef struct {
     uint32_t triangle_idx;
     uint32_t index_idx;
 
-    uint16_t index_offset;
+    uint32_t index_offset;
     uint32_t triangle_counter;
 
     float inv_wall_height;
@@ -96,12 +103,16 @@ struct SceneBuilder {
 
     // Final vertex data (GPU-ready format)
     SceneVertex *vertices;
-    uint16_t *indices;
+    uint32_t *indices;           // Into all vertices, made relative to each mesh when serialized
     SceneLight *lights;
+    SceneMesh *meshes;           // index_offset is the mesh's first index until serialized
 
     uint32_t vertex_count;
     uint32_t index_count;
     uint32_t light_count;
+    uint32_t mesh_count;
+    uint32_t vertex_format;      // SCENE_VERTEX_* to serialize
+    uint64_t source_key;         // SceneConfig.source_key
 
     // Texture path tracking
     const char **texture_paths;  // Array of texture path pointers
@@ -125,7 +136,7 @@ static float g_obj_positions[OBJ_MAX_VERTICES * 3];
 static float g_obj_uvs[OBJ_MAX_VERTICES * 2];
 static float g_obj_normals[OBJ_MAX_VERTICES * 3];
 static float g_obj_surface_types[OBJ_MAX_VERTICES];
-static uint16_t g_obj_indices[OBJ_MAX_INDICES];
+static uint32_t g_obj_indices[OBJ_MAX_INDICES];
 static MeshData g_obj_mesh_data;
 static MeshData g_ceiling_light_mesh_data;
 static int g_ceiling_light_mesh_status = 0;
@@ -140,14 +151,15 @@ typedef struct {
     uint32_t normal;
 } ObjVertexRef;
 
-// Mesh generation storage
-static float g_positions_storage[MAX_GENERATED_VERTICES * 3];
-static float g_uvs_storage[MAX_GENERATED_VERTICES * 2];
-static float g_normals_storage[MAX_GENERATED_VERTICES * 3];
-static float g_surface_storage[MAX_GENERATED_VERTICES];
-static float g_triangle_storage[MAX_GENERATED_VERTICES];
-static uint16_t g_index_storage[MAX_GENERATED_INDICES];
+// Generated mesh, and where each of its meshes (SceneMesh) ends
+typedef struct {
+    uint32_t vertex_end;
+    uint32_t index_end;
+} MeshEnd;
+
 static MeshData g_mesh_data_storage;
+static MeshEnd g_mesh_ends[MAX_SCENE_MESHES];
+static uint32_t g_mesh_end_count;
 
 // ============================================================================
 // Helper functions
@@ -313,15 +325,82 @@ static inline void push_triangle_id(MeshGenContext *ctx, float id) {
     ctx->triangle_ids[ctx->triangle_idx++] = id;
 }
 
-static inline void push_index(MeshGenContext *ctx, uint16_t idx) {
+static inline void push_index(MeshGenContext *ctx, uint32_t idx) {
     ctx->indices[ctx->index_idx++] = idx;
 }
 
+static void *mesh_gen_grow(Arena *arena, void *data, size_t used, size_t size) {
+    void *grown = arena_alloc(arena, size);
+    if (grown && used > 0) {
+        base_memcpy(grown, data, used);
+    }
+    return grown;
+}
+
+// Makes room for `vertices` more vertices and `indices` more indices after
+// the cursors. The push_* helpers do not check bounds, so everything that
+// emits geometry reserves it first. Arrays at least double when they grow.
+static bool mesh_gen_reserve(MeshGenContext *ctx, uint32_t vertices, uint32_t indices) {
+    uint64_t vertex_need = (uint64_t)ctx->surface_idx + vertices;
+    uint64_t index_need = (uint64_t)ctx->index_idx + indices;
+    if (vertex_need > UINT32_MAX || index_need > UINT32_MAX) {
+        SDL_Log("Scene geometry exceeds %u vertices or indices", UINT32_MAX);
+        return false;
+    }
+
+    if (vertex_need > ctx->vertex_capacity) {
+        uint64_t capacity = (uint64_t)ctx->vertex_capacity * 2;
+        if (capacity < vertex_need) capacity = vertex_need;
+        if (capacity > UINT32_MAX) capacity = UINT32_MAX;
+        size_t count = ctx->surface_idx;
+        ctx->positions = mesh_gen_grow(ctx->arena, ctx->positions, count * 3 * sizeof(float), (size_t)capacity * 3 * sizeof(float));
+        ctx->uvs = mesh_gen_grow(ctx->arena, ctx->uvs, count * 2 * sizeof(float), (size_t)capacity * 2 * sizeof(float));
+        ctx->normals = mesh_gen_grow(ctx->arena, ctx->normals, count * 3 * sizeof(float), (size_t)capacity * 3 * sizeof(float));
+        ctx->surface_types = mesh_gen_grow(ctx->arena, ctx->surface_types, count * sizeof(float), (size_t)capacity * sizeof(float));
+        ctx->triangle_ids = mesh_gen_grow(ctx->arena, ctx->triangle_ids, count * sizeof(float), (size_t)capacity * sizeof(float));
+        if (!ctx->positions || !ctx->uvs || !ctx->normals || !ctx->surface_types || !ctx->triangle_ids) {
+            SDL_Log("Failed to grow mesh vertex storage to %llu vertices", (unsigned long long)capacity);
+            return false;
+        }
+        ctx->vertex_capacity = (uint32_t)capacity;
+    }
+
+    if (index_need > ctx->index_capacity) {
+        uint64_t capacity = (uint64_t)ctx->index_capacity * 2;
+        if (capacity < index_need) capacity = index_need;
+        if (capacity > UINT32_MAX) capacity = UINT32_MAX;
+        ctx->indices = mesh_gen_grow(ctx->arena, ctx->indices, (size_t)ctx->index_idx * sizeof(uint32_t),
+                                     (size_t)capacity * sizeof(uint32_t));
+        if (!ctx->indices) {
+            SDL_Log("Failed to grow mesh index storage to %llu indices", (unsigned long long)capacity);
+            return false;
+        }
+        ctx->index_capacity = (uint32_t)capacity;
+    }
+    return true;
+}
+
+// Ends the current scene mesh (SceneMesh) at the context's cursors. Empty
+// meshes are skipped, and past MAX_SCENE_MESHES the last mesh grows instead.
+static void mesh_gen_end_mesh(const MeshGenContext *ctx) {
+    uint32_t index_start = g_mesh_end_count > 0 ? g_mesh_ends[g_mesh_end_count - 1].index_end : 0;
+    if (ctx->index_idx == index_start) {
+        return;
+    }
+    if (g_mesh_end_count == MAX_SCENE_MESHES) {
+        g_mesh_end_count--;
+    }
+    g_mesh_ends[g_mesh_end_count++] = (MeshEnd){
+        .vertex_end = ctx->surface_idx,
+        .index_end = ctx->index_idx,
+    };
+}
+
 static void push_north_segment_range(MeshGenContext *ctx, float x0, float x1, float z,
                                      float y0, float y1, float base_u, float surface_type) {
     float height = y1 - y0;
     float u_span = x1 - x0;
-    uint16_t base = ctx->index_offset;
+    uint32_t base = ctx->index_offset;
 
     push_position(ctx, x0, y0, z);
     push_uv(ctx, base_u, 0.0f);
@@ -362,7 +441,7 @@ static void push_south_segment_range(MeshGenContext *ctx, float x0, float x1, fl
                                      float y0, float y1, float base_u, float surface_type) {
     float height = y1 - y0;
     float u_span = x1 - x0;
-    uint16_t base = ctx->index_offset;
+    uint32_t base = ctx->index_offset;
 
     push_position(ctx, x0, y0, z);
     push_uv(ctx, base_u, 0.0f);
@@ -403,7 +482,7 @@ static void push_west_segment_range(MeshGenContext *ctx, float x, float z0, floa
                                     float y0, float y1, float base_v, float surface_type) {
     float height = y1 - y0;
     float v_span = z1 - z0;
-    uint16_t base = ctx->index_offset;
+    uint32_t base = ctx->index_offset;
 
     push_position(ctx, x, y0, z0);
     push_uv(ctx, 0.0f, base_v);
@@ -444,7 +523,7 @@ static void push_east_segment_range(MeshGenContext *ctx, float x, float z0, floa
                                     float y0, float y1, float base_v, float surface_type) {
     float height = y1 - y0;
     float v_span = z1 - z0;
-    uint16_t base = ctx->index_offset;
+    uint32_t base = ctx->index_offset;
 
     push_position(ctx, x, y0, z0);
     push_uv(ctx, 0.0f, base_v);
@@ -487,7 +566,7 @@ static void push_horizontal_fill(MeshGenContext *ctx, float x0, float x1, float
     float v_span = z1 - z0;
     float ny = (surface_type == 0.0f) ? 1.0f : -1.0f;
 
-    uint16_t base = ctx->index_offset;
+    uint32_t base = ctx->index_offset;
 
     push_position(ctx, x0, y, z0);
     push_uv(ctx, 0.0f, 0.0f);
@@ -540,14 +619,17 @@ static void push_east_segment(MeshGenContext *ctx, float x, float z, float y0, f
     push_east_segment_range(ctx, x + 1.0f, z, z + 1.0f, y0, y1, 0, 1.0f);
 }
 
-static void add_mesh_instance(MeshGenContext *ctx, const MeshData *mesh,
+static bool add_mesh_instance(MeshGenContext *ctx, const MeshData *mesh,
                               float scale, float tx, float ty, float tz,
                               float surface_type) {
     if (!mesh) {
-        return;
+        return true;
+    }
+    if (!mesh_gen_reserve(ctx, mesh->vertex_count, mesh->index_count)) {
+        return false;
     }
 
-    uint16_t base_vertex = (uint16_t)ctx->surface_idx;
+    uint32_t base_vertex = ctx->surface_idx;
     for (uint32_t i = 0; i < mesh->vertex_count; i++) {
         const float *pos = &mesh->positions[i * 3];
         push_position(ctx,
@@ -568,6 +650,7 @@ static void add_mesh_instance(MeshGenContext *ctx, const MeshData *mesh,
     for (uint32_t i = 0; i < mesh->index_count; i++) {
         push_index(ctx, base_vertex + mesh->indices[i]);
     }
+    return true;
 }
 
 // ============================================================================
@@ -575,6 +658,7 @@ static void add_mesh_instance(MeshGenContext *ctx, const MeshData *mesh,
 // ============================================================================
 
 static MeshData* load_obj_file(const char *path) {
+    PROFILE_ZONE("load_obj_file");
     Scratch scratch = scratch_begin();
     MeshData *result = NULL;
     static int obj_load_counter = 0;
@@ -719,7 +803,7 @@ static MeshData* load_obj_file(const char *path) {
                         g_obj_normals[vertex_count * 3 + 2] = g_temp_obj_normals[ref->normal * 3 + 2];
 
                         g_obj_surface_types[vertex_count] = 4.0f;
-                        g_obj_indices[index_count++] = (uint16_t)vertex_count;
+                        g_obj_indices[index_count++] = vertex_count;
                         vertex_count++;
                     }
                 }
@@ -794,7 +878,7 @@ static const cgltf_accessor* find_attribute_accessor(const cgltf_primitive *prim
     return NULL;
 }
 
-static void compute_normals_from_triangles(float *positions, uint16_t *indices,
+static void compute_normals_from_triangles(float *positions, uint32_t *indices,
                                            cgltf_size vertex_count, cgltf_size index_count,
                                            float *normals) {
     if (!positions || !indices || !normals) {
@@ -803,9 +887,9 @@ static void compute_normals_from_triangles(float *positions, uint16_t *indices,
 
     base_memset(normals, 0, vertex_count * 3 * sizeof(float));
     for (cgltf_size i = 0; i + 2 < index_count; i += 3) {
-        uint16_t i0 = indices[i + 0];
-        uint16_t i1 = indices[i + 1];
-        uint16_t i2 = indices[i + 2];
+        uint32_t i0 = indices[i + 0];
+        uint32_t i1 = indices[i + 1];
+        uint32_t i2 = indices[i + 2];
         if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count) {
             continue;
         }
@@ -887,7 +971,7 @@ static MeshData* load_ceiling_light_mesh(const char *path, Arena *arena) {
     float *positions = NULL;
     float *normals = NULL;
     float *uvs = NULL;
-    uint16_t *indices = NULL;
+    uint32_t *indices = NULL;
 
     cgltf_result result = cgltf_parse_file(&options, path, &data);
     if (result != cgltf_result_success) {
@@ -964,7 +1048,7 @@ static MeshData* load_ceiling_light_mesh(const char *path, Arena *arena) {
     positions = (float *)arena_alloc(arena, sizeof(float) * total_vertex_count * 3);
     normals = (float *)arena_alloc(arena, sizeof(float) * total_vertex_count * 3);
     uvs = (float *)arena_alloc(arena, sizeof(float) * total_vertex_count * 2);
-    indices = (uint16_t *)arena_alloc(arena, sizeof(uint16_t) * total_index_count);
+    indices = (uint32_t *)arena_alloc(arena, sizeof(uint32_t) * total_index_count);
     if (!positions || !normals || !uvs || !indices) {
         SDL_Log("Out of memory loading ceiling light mesh");
         goto fail;
@@ -1059,20 +1143,12 @@ static MeshData* load_ceiling_light_mesh(const char *path, Arena *arena) {
                         SDL_Log("Ceiling light primitive node %u meshPrim %u index %u out of range", (unsigned)node_index, (unsigned)prim_index, (unsigned)idx);
                         goto fail;
                     }
-                    if (vertex_offset + idx >= UINT16_MAX) {
-                        SDL_Log("Ceiling light combined index exceeds supported range");
-                        goto fail;
-                    }
-                    indices[index_offset + i] = (uint16_t)(vertex_offset + idx);
+                    indices[index_offset + i] = (uint32_t)(vertex_offset + idx);
                 }
                 index_offset += index_accessor->count;
             } else {
                 for (cgltf_size i = 0; i < prim_vertex_count; i++) {
-                    if (vertex_offset + i >= UINT16_MAX) {
-                        SDL_Log("Ceiling light implicit index exceeds supported range");
-                        goto fail;
-                    }
-                    indices[index_offset + i] = (uint16_t)(vertex_offset + i);
+                    indices[index_offset + i] = (uint32_t)(vertex_offset + i);
                 }
                 index_offset += prim_vertex_count;
             }
@@ -1121,14 +1197,159 @@ fail:
 // Scene generation (adapted from generate_mesh in game.c)
 // ============================================================================
 
-static MeshData* generate_procedural_mesh(const SceneConfig *config) {
+// Emits the walls of map row `z`. The amount of geometry only depends on the
+// map, so a row can be generated into scratch buffers to size it and then
+// again at its final offsets (see generate_procedural_mesh).
+static void generate_wall_row(MeshGenContext *ctx, const SceneConfig *config, int z) {
+    int width = config->map_width;
+    int height = config->map_height;
+    int *map = config->map_data;
+
+    for (int x = 0; x < width; x++) {
+        int cell = map[z * width + x];
+        if (!is_solid_cell(cell)) {
+            continue;
+        }
+
+        int is_window_ns = (cell == 2);
+        int is_window_ew = (cell == 3);
+
+        float x_inner0 = (float)x + ctx->window_margin;
+        float x_inner1 = (float)(x + 1) - ctx->window_margin;
+        float z_inner0 = (float)z + ctx->window_margin;
+        float z_inner1 = (float)(z + 1) - ctx->window_margin;
+
+        if (z == 0 || !is_solid_cell(map[(z - 1) * width + x])) {
+            if (is_window_ns) {
+                push_north_segment_range(ctx, (float)x, (float)(x + 1), (float)z, 0.0f, ctx->window_bottom, 0, 1.0f);
+                push_north_segment_range(ctx, (float)x, (float)(x + 1), (float)z, ctx->window_top, WALL_HEIGHT, 0, 1.0f);
+                push_north_segment_range(ctx, (float)x, x_inner0, (float)z, ctx->window_bottom, ctx->window_top, 0, 3.0f);
+                push_north_segment_range(ctx, x_inner1, (float)(x + 1), (float)z, ctx->window_bottom, ctx->window_top, 0, 3.0f);
+            } else {
+                push_north_segment(ctx, (float)x, (float)z, 0.0f, WALL_HEIGHT);
+            }
+        }
+
+        if (z == height - 1 || !is_solid_cell(map[(z + 1) * width + x])) {
+            if (is_window_ns) {
+                float south_z = (float)z + 1.0f;
+                push_south_segment_range(ctx, (float)x, (float)(x + 1), south_z, 0.0f, ctx->window_bottom, 0, 1.0f);
+                push_south_segment_range(ctx, (float)x, (float)(x + 1), south_z, ctx->window_top, WALL_HEIGHT, 0, 1.0f);
+                push_south_segment_range(ctx, (float)x, x_inner0, south_z, ctx->window_bottom, ctx->window_top, 0, 3.0f);
+                push_south_segment_range(ctx, x_inner1, (float)(x + 1), south_z, ctx->window_bottom, ctx->window_top, 0, 3.0f);
+            } else {
+                push_south_segment(ctx, (float)x, (float)z, 0.0f, WALL_HEIGHT);
+            }
+        }
+
+        if (x == 0 || !is_solid_cell(map[z * width + (x - 1)])) {
+            if (is_window_ew) {
+                push_west_segment_range(ctx, (float)x, (float)z, (float)(z + 1), 0.0f, ctx->window_bottom, 0, 1.0f);
+                push_west_segment_range(ctx, (float)x, (float)z, (float)(z + 1), ctx->window_top, WALL_HEIGHT, 0, 1.0f);
+                push_west_segment_range(ctx, (float)x, (float)z, z_inner0, ctx->window_bottom, ctx->window_top, 0, 3.0f);
+                push_west_segment_range(ctx, (float)x, z_inner1, (float)(z + 1), ctx->window_bottom, ctx->window_top, 0, 3.0f);
+            } else {
+                push_west_segment(ctx, (float)x, (float)z, 0.0f, WALL_HEIGHT);
+            }
+        }
+
+        if (x == width - 1 || !is_solid_cell(map[z * width + (x + 1)])) {
+            if (is_window_ew) {
+                push_east_segment_range(ctx, (float)(x + 1), (float)z, (float)(z + 1), 0.0f, ctx->window_bottom, 0, 1.0f);
+                push_east_segment_range(ctx, (float)(x + 1), (float)z, (float)(z + 1), ctx->window_top, WALL_HEIGHT, 0, 1.0f);
+                push_east_segment_range(ctx, (float)(x + 1), (float)z, z_inner0, ctx->window_bottom, ctx->window_top, 0, 3.0f);
+                push_east_segment_range(ctx, (float)(x + 1), z_inner1, (float)(z + 1), ctx->window_bottom, ctx->window_top, 0, 3.0f);
+            } else {
+                push_east_segment(ctx, (float)x, (float)z, 0.0f, WALL_HEIGHT);
+            }
+        }
+
+        if (is_window_ns) {
+            push_west_segment_range(ctx, x_inner0, (float)z, (float)(z + 1), ctx->window_bottom, ctx->window_top, 1, 3.0f);
+            push_east_segment_range(ctx, x_inner1, (float)z, (float)(z + 1), ctx->window_bottom, ctx->window_top, 1, 3.0f);
+            push_horizontal_fill(ctx, x_inner0, x_inner1, (float)z, (float)(z + 1), ctx->window_bottom, 0.0f);
+            push_horizontal_fill(ctx, x_inner0, x_inner1, (float)z, (float)(z + 1), ctx->window_top, 2.0f);
+        } else if (is_window_ew) {
+            push_north_segment_range(ctx, (float)x, (float)(x + 1), z_inner0, ctx->window_bottom, ctx->window_top, 1, 3.0f);
+            push_south_segment_range(ctx, (float)x, (float)(x + 1), z_inner1, ctx->window_bottom, ctx->window_top, 1, 3.0f);
+            push_horizontal_fill(ctx, (float)x, (float)(x + 1), z_inner0, z_inner1, ctx->window_bottom, 0.0f);
+            push_horizontal_fill(ctx, (float)x, (float)(x + 1), z_inner0, z_inner1, ctx->window_top, 2.0f);
+        }
+    }
+}
+
+// Positions the context's output cursors at a given vertex, index and
+// triangle, as if that much geometry had been emitted before.
+static void mesh_gen_context_seek(MeshGenContext *ctx, uint32_t vertex, uint32_t index,
+                                  uint32_t triangle) {
+    ctx->position_idx = vertex * 3;
+    ctx->uv_idx = vertex * 2;
+    ctx->normal_idx = vertex * 3;
+    ctx->surface_idx = vertex;
+    ctx->triangle_idx = vertex;
+    ctx->index_idx = index;
+    ctx->index_offset = vertex;
+    ctx->triangle_counter = triangle;
+}
+
+// Upper bound of the quads generate_wall_row emits per map cell: up to four
+// per side plus four for a window's interior.
+#define WALL_CELL_MAX_QUADS 20
+
+typedef struct {
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t triangle_count;
+} WallRowCounts;
+
+typedef struct {
+    const MeshGenContext *base;  // Output arrays and wall parameters
+    const SceneConfig *config;
+    WallRowCounts *counts;       // Geometry emitted by each row
+    WallRowCounts *starts;       // Where each row's geometry begins
+} WallRowJob;
+
+static void count_wall_rows(void *arg, uint64_t begin, uint64_t end) {
+    WallRowJob *job = arg;
+    Scratch scratch = scratch_begin();
+    uint32_t max_vertices = (uint32_t)job->config->map_width * WALL_CELL_MAX_QUADS * 4;
+    uint32_t max_indices = (uint32_t)job->config->map_width * WALL_CELL_MAX_QUADS * 6;
+
+    MeshGenContext ctx = *job->base;
+    ctx.positions = arena_alloc_array(scratch.arena, float, max_vertices * 3);
+    ctx.uvs = arena_alloc_array(scratch.arena, float, max_vertices * 2);
+    ctx.normals = arena_alloc_array(scratch.arena, float, max_vertices * 3);
+    ctx.surface_types = arena_alloc_array(scratch.arena, float, max_vertices);
+    ctx.triangle_ids = arena_alloc_array(scratch.arena, float, max_vertices);
+    ctx.indices = arena_alloc_array(scratch.arena, uint32_t, max_indices);
+
+    for (uint64_t z = begin; z < end; z++) {
+        mesh_gen_context_seek(&ctx, 0, 0, 0);
+        generate_wall_row(&ctx, job->config, (int)z);
+        job->counts[z] = (WallRowCounts){
+            .vertex_count = ctx.surface_idx,
+            .index_count = ctx.index_idx,
+            .triangle_count = ctx.triangle_counter,
+        };
+    }
+    scratch_end(scratch);
+}
+
+static void generate_wall_rows(void *arg, uint64_t begin, uint64_t end) {
+    WallRowJob *job = arg;
+    MeshGenContext ctx = *job->base;
+    for (uint64_t z = begin; z < end; z++) {
+        WallRowCounts start = job->starts[z];
+        mesh_gen_context_seek(&ctx, start.vertex_count, start.index_count, start.triangle_count);
+        generate_wall_row(&ctx, job->config, (int)z);
+    }
+}
+
+// Generates the map geometry and the models placed in it into `arena`, and
+// records where each scene mesh ends in g_mesh_ends.
+static MeshData* generate_procedural_mesh(const SceneConfig *config, Arena *arena) {
     MeshGenContext ctx = {0};
-    ctx.positions = g_positions_storage;
-    ctx.uvs = g_uvs_storage;
-    ctx.normals = g_normals_storage;
-    ctx.surface_types = g_surface_storage;
-    ctx.triangle_ids = g_triangle_storage;
-    ctx.indices = g_index_storage;
+    ctx.arena = arena;
     ctx.inv_wall_height = 1.0f / WALL_HEIGHT;
     ctx.window_bottom = WALL_HEIGHT * 0.3f;
     ctx.window_top = WALL_HEIGHT - ctx.window_bottom;
@@ -1137,8 +1358,12 @@ static MeshData* generate_procedural_mesh(const SceneConfig *config) {
     int width = config->map_width;
     int height = config->map_height;
     int *map = config->map_data;
+    g_mesh_end_count = 0;
 
-    // Floor
+    // Floor and ceiling
+    if (!mesh_gen_reserve(&ctx, 8, 12)) {
+        return NULL;
+    }
     push_position(&ctx, 0.0f, 0.0f, 0.0f);
     push_uv(&ctx, 0.0f, 0.0f);
     push_normal(&ctx, 0.0f, 1.0f, 0.0f);
@@ -1172,9 +1397,10 @@ static MeshData* generate_procedural_mesh(const SceneConfig *config) {
 
     ctx.index_offset = 4;
     ctx.triangle_counter = 2;
+    mesh_gen_end_mesh(&ctx);
 
     // Ceiling
-    uint16_t base = ctx.index_offset;
+    uint32_t base = ctx.index_offset;
     push_position(&ctx, 0.0f, WALL_HEIGHT, 0.0f);
     push_uv(&ctx, 0.0f, 0.0f);
     push_normal(&ctx, 0.0f, -1.0f, 0.0f);
@@ -1208,81 +1434,40 @@ static MeshData* generate_procedural_mesh(const SceneConfig *config) {
 
     ctx.index_offset += 4;
     ctx.triangle_counter += 2;
+    mesh_gen_end_mesh(&ctx);
 
-    // Walls
-    for (int z = 0; z < height; z++) {
-        for (int x = 0; x < width; x++) {
-            int cell = map[z * width + x];
-            if (!is_solid_cell(cell)) {
-                continue;
-            }
-
-            int is_window_ns = (cell == 2);
-            int is_window_ew = (cell == 3);
-
-            float x_inner0 = (float)x + ctx.window_margin;
-            float x_inner1 = (float)(x + 1) - ctx.window_margin;
-            float z_inner0 = (float)z + ctx.window_margin;
-            float z_inner1 = (float)(z + 1) - ctx.window_margin;
-
-            if (z == 0 || !is_solid_cell(map[(z - 1) * width + x])) {
-                if (is_window_ns) {
-                    push_north_segment_range(&ctx, (float)x, (float)(x + 1), (float)z, 0.0f, ctx.window_bottom, 0, 1.0f);
-                    push_north_segment_range(&ctx, (float)x, (float)(x + 1), (float)z, ctx.window_top, WALL_HEIGHT, 0, 1.0f);
-                    push_north_segment_range(&ctx, (float)x, x_inner0, (float)z, ctx.window_bottom, ctx.window_top, 0, 3.0f);
-                    push_north_segment_range(&ctx, x_inner1, (float)(x + 1), (float)z, ctx.window_bottom, ctx.window_top, 0, 3.0f);
-                } else {
-                    push_north_segment(&ctx, (float)x, (float)z, 0.0f, WALL_HEIGHT);
-                }
-            }
-
-            if (z == height - 1 || !is_solid_cell(map[(z + 1) * width + x])) {
-                if (is_window_ns) {
-                    float south_z = (float)z + 1.0f;
-                    push_south_segment_range(&ctx, (float)x, (float)(x + 1), south_z, 0.0f, ctx.window_bottom, 0, 1.0f);
-                    push_south_segment_range(&ctx, (float)x, (float)(x + 1), south_z, ctx.window_top, WALL_HEIGHT, 0, 1.0f);
-                    push_south_segment_range(&ctx, (float)x, x_inner0, south_z, ctx.window_bottom, ctx.window_top, 0, 3.0f);
-                    push_south_segment_range(&ctx, x_inner1, (float)(x + 1), south_z, ctx.window_bottom, ctx.window_top, 0, 3.0f);
-                } else {
-                    push_south_segment(&ctx, (float)x, (float)z, 0.0f, WALL_HEIGHT);
-                }
-            }
-
-            if (x == 0 || !is_solid_cell(map[z * width + (x - 1)])) {
-                if (is_window_ew) {
-                    push_west_segment_range(&ctx, (float)x, (float)z, (float)(z + 1), 0.0f, ctx.window_bottom, 0, 1.0f);
-                    push_west_segment_range(&ctx, (float)x, (float)z, (float)(z + 1), ctx.window_top, WALL_HEIGHT, 0, 1.0f);
-                    push_west_segment_range(&ctx, (float)x, (float)z, z_inner0, ctx.window_bottom, ctx.window_top, 0, 3.0f);
-                    push_west_segment_range(&ctx, (float)x, z_inner1, (float)(z + 1), ctx.window_bottom, ctx.window_top, 0, 3.0f);
-                } else {
-                    push_west_segment(&ctx, (float)x, (float)z, 0.0f, WALL_HEIGHT);
-                }
-            }
+    // Walls, one map row per job. Rows are generated once to size them and
+    // once more at their final offsets, which keeps the output identical to a
+    // sequential pass.
+    Scratch scratch = scratch_begin();
+    WallRowJob wall_rows = {
+        .base = &ctx,
+        .config = config,
+        .counts = arena_alloc_array(scratch.arena, WallRowCounts, height),
+        .starts = arena_alloc_array(scratch.arena, WallRowCounts, height),
+    };
+    job_parallel_for((uint64_t)height, 1, count_wall_rows, &wall_rows);
 
-            if (x == width - 1 || !is_solid_cell(map[z * width + (x + 1)])) {
-                if (is_window_ew) {
-                    push_east_segment_range(&ctx, (float)(x + 1), (float)z, (float)(z + 1), 0.0f, ctx.window_bottom, 0, 1.0f);
-                    push_east_segment_range(&ctx, (float)(x + 1), (float)z, (float)(z + 1), ctx.window_top, WALL_HEIGHT, 0, 1.0f);
-                    push_east_segment_range(&ctx, (float)(x + 1), (float)z, z_inner0, ctx.window_bottom, ctx.window_top, 0, 3.0f);
-                    push_east_segment_range(&ctx, (float)(x + 1), z_inner1, (float)(z + 1), ctx.window_bottom, ctx.window_top, 0, 3.0f);
-                } else {
-                    push_east_segment(&ctx, (float)x, (float)z, 0.0f, WALL_HEIGHT);
-                }
-            }
+    WallRowCounts cursor = {
+        .vertex_count = ctx.surface_idx,
+        .index_count = ctx.index_idx,
+        .triangle_count = ctx.triangle_counter,
+    };
+    for (int z = 0; z < height; z++) {
+        wall_rows.starts[z] = cursor;
+        cursor.vertex_count += wall_rows.counts[z].vertex_count;
+        cursor.index_count += wall_rows.counts[z].index_count;
+        cursor.triangle_count += wall_rows.counts[z].triangle_count;
+    }
 
-            if (is_window_ns) {
-                push_west_segment_range(&ctx, x_inner0, (float)z, (float)(z + 1), ctx.window_bottom, ctx.window_top, 1, 3.0f);
-                push_east_segment_range(&ctx, x_inner1, (float)z, (float)(z + 1), ctx.window_bottom, ctx.window_top, 1, 3.0f);
-                push_horizontal_fill(&ctx, x_inner0, x_inner1, (float)z, (float)(z + 1), ctx.window_bottom, 0.0f);
-                push_horizontal_fill(&ctx, x_inner0, x_inner1, (float)z, (float)(z + 1), ctx.window_top, 2.0f);
-            } else if (is_window_ew) {
-                push_north_segment_range(&ctx, (float)x, (float)(x + 1), z_inner0, ctx.window_bottom, ctx.window_top, 1, 3.0f);
-                push_south_segment_range(&ctx, (float)x, (float)(x + 1), z_inner1, ctx.window_bottom, ctx.window_top, 1, 3.0f);
-                push_horizontal_fill(&ctx, (float)x, (float)(x + 1), z_inner0, z_inner1, ctx.window_bottom, 0.0f);
-                push_horizontal_fill(&ctx, (float)x, (float)(x + 1), z_inner0, z_inner1, ctx.window_top, 2.0f);
-            }
-        }
+    if (!mesh_gen_reserve(&ctx, cursor.vertex_count - ctx.surface_idx, cursor.index_count - ctx.index_idx)) {
+        scratch_end(scratch);
+        return NULL;
     }
+    job_parallel_for((uint64_t)height, 1, generate_wall_rows, &wall_rows);
+    mesh_gen_context_seek(&ctx, cursor.vertex_count, cursor.index_count, cursor.triangle_count);
+    scratch_end(scratch);
+    mesh_gen_end_mesh(&ctx);
 
     // Load sphere mesh and add it to window cells
     SDL_Log("Before sphere: position_idx=%u, surface_idx=%u, index_idx=%u",
@@ -1305,9 +1490,11 @@ static MeshData* generate_procedural_mesh(const SceneConfig *config) {
                     float scale = 0.3f;
 
                     SDL_Log("Sphere %d at cell(%d,%d): base_vertex=%u, surface_idx before=%u",
-                            sphere_count, x, z, (uint16_t)ctx.surface_idx, ctx.surface_idx);
+                            sphere_count, x, z, ctx.surface_idx, ctx.surface_idx);
 
-                    add_mesh_instance(&ctx, sphere_mesh, scale, cx, cy, cz, 4.0f);
+                    if (!add_mesh_instance(&ctx, sphere_mesh, scale, cx, cy, cz, 4.0f)) {
+                        return NULL;
+                    }
 
                     SDL_Log("Sphere %d: surface_idx after=%u, index_idx after=%u",
                             sphere_count, ctx.surface_idx, ctx.index_idx);
@@ -1316,6 +1503,7 @@ static MeshData* generate_procedural_mesh(const SceneConfig *config) {
             }
         }
         SDL_Log("Added %d spheres total", sphere_count);
+        mesh_gen_end_mesh(&ctx);
     }
 
     SDL_Log("After spheres: position_idx=%u, surface_idx=%u, index_idx=%u",
@@ -1328,7 +1516,10 @@ static MeshData* generate_procedural_mesh(const SceneConfig *config) {
         const float book_scale = 2.0f;
         const float floor_y = 0.0f;
         float book_y = floor_y - min_y * book_scale + 0.01f;
-        add_mesh_instance(&ctx, book_mesh, book_scale, config->spawn_x, book_y, config->spawn_z, 5.0f);
+        if (!add_mesh_instance(&ctx, book_mesh, book_scale, config->spawn_x, book_y, config->spawn_z, 5.0f)) {
+            return NULL;
+        }
+        mesh_gen_end_mesh(&ctx);
     }
 
     MeshData *chair_mesh = load_obj_file(config->chair_obj_path);
@@ -1340,15 +1531,18 @@ static MeshData* generate_procedural_mesh(const SceneConfig *config) {
         float chair_y = floor_y - min_y * chair_scale + 0.01f;
         float chair_x = config->spawn_x + 0.9f;
         float chair_z = config->spawn_z - 0.2f;
-        add_mesh_instance(&ctx, chair_mesh, chair_scale, chair_x, chair_y, chair_z, 6.0f);
+        if (!add_mesh_instance(&ctx, chair_mesh, chair_scale, chair_x, chair_y, chair_z, 6.0f)) {
+            return NULL;
+        }
+        mesh_gen_end_mesh(&ctx);
     }
 
-    g_mesh_data_storage.positions = g_positions_storage;
-    g_mesh_data_storage.uvs = g_uvs_storage;
-    g_mesh_data_storage.normals = g_normals_storage;
-    g_mesh_data_storage.surface_types = g_surface_storage;
-    g_mesh_data_storage.triangle_ids = g_triangle_storage;
-    g_mesh_data_storage.indices = g_index_storage;
+    g_mesh_data_storage.positions = ctx.positions;
+    g_mesh_data_storage.uvs = ctx.uvs;
+    g_mesh_data_storage.normals = ctx.normals;
+    g_mesh_data_storage.surface_types = ctx.surface_types;
+    g_mesh_data_storage.triangle_ids = ctx.triangle_ids;
+    g_mesh_data_storage.indices = ctx.indices;
     g_mesh_data_storage.position_count = ctx.position_idx;
     g_mesh_data_storage.uv_count = ctx.uv_idx;
     g_mesh_data_storage.normal_count = ctx.normal_idx;
@@ -1389,6 +1583,7 @@ SceneBuilder* scene_builder_create(Arena *arena) {
 }
 
 bool scene_builder_generate(SceneBuilder *builder, const SceneConfig *config) {
+    PROFILE_ZONE("scene_builder_generate");
     if (!builder || !config || !config->map_data) {
         SDL_Log("Invalid arguments to scene_builder_generate");
         return false;
@@ -1397,7 +1592,7 @@ bool scene_builder_generate(SceneBuilder *builder, const SceneConfig *config) {
     SDL_Log("Generating scene geometry...");
 
     // Generate procedural mesh
-    MeshData *mesh = generate_procedural_mesh(config);
+    MeshData *mesh = generate_procedural_mesh(config, builder->arena);
     if (!mesh) {
         SDL_Log("Failed to generate procedural mesh");
         return false;
@@ -1441,8 +1636,12 @@ bool scene_builder_generate(SceneBuilder *builder, const SceneConfig *config) {
     if (config->ceiling_light_gltf_path && light_count > 0) {
         MeshData *ceiling_mesh = load_ceiling_light_mesh(config->ceiling_light_gltf_path, builder->arena);
         if (ceiling_mesh) {
-            // Add ceiling light instances to the mesh
+            // Add ceiling light instances to the mesh, whose arrays hold at
+            // least its vertices and indices
             MeshGenContext ctx = {0};
+            ctx.arena = builder->arena;
+            ctx.vertex_capacity = mesh->vertex_count;
+            ctx.index_capacity = mesh->index_count;
             ctx.positions = mesh->positions;
             ctx.uvs = mesh->uvs;
             ctx.normals = mesh->normals;
@@ -1455,18 +1654,27 @@ bool scene_builder_generate(SceneBuilder *builder, const SceneConfig *config) {
             ctx.surface_idx = mesh->vertex_count;
             ctx.triangle_idx = mesh->vertex_count;
             ctx.index_idx = mesh->index_count;
-            ctx.index_offset = (uint16_t)mesh->vertex_count;
+            ctx.index_offset = mesh->vertex_count;
 
             const float light_scale = CEILING_LIGHT_MODEL_SCALE;
             for (uint32_t i = 0; i < light_count; i++) {
-                add_mesh_instance(&ctx, ceiling_mesh, light_scale,
-                                  light_positions[i][0],
-                                  light_positions[i][1],
-                                  light_positions[i][2],
-                                  CEILING_LIGHT_SURFACE_TYPE);
+                if (!add_mesh_instance(&ctx, ceiling_mesh, light_scale,
+                                       light_positions[i][0],
+                                       light_positions[i][1],
+                                       light_positions[i][2],
+                                       CEILING_LIGHT_SURFACE_TYPE)) {
+                    return false;
+                }
             }
+            mesh_gen_end_mesh(&ctx);
 
             // Update mesh data
+            mesh->positions = ctx.positions;
+            mesh->uvs = ctx.uvs;
+            mesh->normals = ctx.normals;
+            mesh->surface_types = ctx.surface_types;
+            mesh->triangle_ids = ctx.triangle_ids;
+            mesh->indices = ctx.indices;
             mesh->position_count = ctx.position_idx;
             mesh->uv_count = ctx.uv_idx;
             mesh->normal_count = ctx.normal_idx;
@@ -1479,11 +1687,16 @@ bool scene_builder_generate(SceneBuilder *builder, const SceneConfig *config) {
     builder->vertex_count = mesh->vertex_count;
     builder->index_count = mesh->index_count;
     builder->light_count = light_count;
+    builder->mesh_count = g_mesh_end_count;
+    builder->vertex_format = config->vertex_format;
+    builder->source_key = config->source_key;
 
     builder->vertices = (SceneVertex *)arena_alloc(builder->arena,
                                                     sizeof(SceneVertex) * builder->vertex_count);
-    builder->indices = (uint16_t *)arena_alloc(builder->arena,
-                                               sizeof(uint16_t) * builder->index_count);
+    builder->indices = (uint32_t *)arena_alloc(builder->arena,
+                                               sizeof(uint32_t) * builder->index_count);
+    builder->meshes = (SceneMesh *)arena_alloc(builder->arena,
+                                               sizeof(SceneMesh) * builder->mesh_count);
     // Only allocate lights if there are any
     if (builder->light_count > 0) {
         builder->lights = (SceneLight *)arena_alloc(builder->arena,
@@ -1492,7 +1705,8 @@ bool scene_builder_generate(SceneBuilder *builder, const SceneConfig *config) {
         builder->lights = NULL;
     }
 
-    if (!builder->vertices || !builder->indices || (builder->light_count > 0 && !builder->lights)) {
+    if (!builder->vertices || !builder->indices || !builder->meshes ||
+        (builder->light_count > 0 && !builder->lights)) {
         SDL_Log("Failed to allocate scene buffers");
         return false;
     }
@@ -1512,7 +1726,41 @@ bool scene_builder_generate(SceneBuilder *builder, const SceneConfig *config) {
     }
 
     // Copy indices
-    base_memcpy(builder->indices, mesh->indices, sizeof(uint16_t) * builder->index_count);
+    base_memcpy(builder->indices, mesh->indices, sizeof(uint32_t) * builder->index_count);
+
+    // Describe the meshes: their ranges, common surface type and bounds
+    uint32_t vertex_start = 0;
+    uint32_t index_start = 0;
+    for (uint32_t m = 0; m < builder->mesh_count; m++) {
+        SceneMesh *scene_mesh = &builder->meshes[m];
+        base_memset(scene_mesh, 0, sizeof(SceneMesh));
+        scene_mesh->first_vertex = vertex_start;
+        scene_mesh->vertex_count = g_mesh_ends[m].vertex_end - vertex_start;
+        scene_mesh->index_offset = index_start;
+        scene_mesh->index_count = g_mesh_ends[m].index_end - index_start;
+        scene_mesh->index_size = scene_mesh->vertex_count <= 65536 ? SCENE_INDEX_16 : SCENE_INDEX_32;
+
+        for (uint32_t i = vertex_start; i < g_mesh_ends[m].vertex_end; i++) {
+            const SceneVertex *v = &builder->vertices[i];
+            uint32_t material = (uint32_t)v->surface_type;
+            if (i == vertex_start) {
+                scene_mesh->material = material;
+            } else if (scene_mesh->material != material) {
+                scene_mesh->material = SCENE_MATERIAL_MIXED;
+            }
+            for (int axis = 0; axis < 3; axis++) {
+                if (i == vertex_start || v->position[axis] < scene_mesh->bounds_min[axis]) {
+                    scene_mesh->bounds_min[axis] = v->position[axis];
+                }
+                if (i == vertex_start || v->position[axis] > scene_mesh->bounds_max[axis]) {
+                    scene_mesh->bounds_max[axis] = v->position[axis];
+                }
+            }
+        }
+
+        vertex_start = g_mesh_ends[m].vertex_end;
+        index_start = g_mesh_ends[m].index_end;
+    }
 
     // Copy lights
     for (uint32_t i = 0; i < builder->light_count; i++) {
@@ -1563,23 +1811,117 @@ bool scene_builder_generate(SceneBuilder *builder, const SceneConfig *config) {
         }
     }
 
-    SDL_Log("Scene generation complete: %u vertices, %u indices, %u lights, %u textures",
-            builder->vertex_count, builder->index_count, builder->light_count, builder->texture_count);
+    SDL_Log("Scene generation complete: %u vertices, %u indices, %u meshes, %u lights, %u textures",
+            builder->vertex_count, builder->index_count, builder->mesh_count, builder->light_count,
+            builder->texture_count);
 
     return true;
 }
 
+// ============================================================================
+// Vertex packing (ScenePackedVertex)
+// ============================================================================
+
+// Rounds to the nearest half float, ties to even
+static uint16_t float_to_half(float value) {
+    union { float f; uint32_t u; } bits = {value};
+    uint32_t x = bits.u;
+    uint16_t sign = (uint16_t)((x >> 16) & 0x8000);
+    uint32_t mantissa = x & 0x7FFFFF;
+    int exponent = (int)((x >> 23) & 0xFF) - 127 + 15;
+
+    if ((x & 0x7FFFFFFF) >= 0x7F800000) {
+        return sign | 0x7C00 | (mantissa ? 0x200 : 0);  // Infinity or NaN
+    }
+    if (exponent >= 31) {
+        return sign | 0x7C00;  // Overflows to infinity
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return sign;  // Underflows to zero
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = (uint32_t)(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) {
+            half++;
+        }
+        return sign | (uint16_t)half;
+    }
+
+    // A carry out of the mantissa correctly bumps the exponent
+    uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+        half++;
+    }
+    return sign | (uint16_t)half;
+}
+
+static int16_t float_to_snorm16(float value) {
+    if (value > 1.0f) value = 1.0f;
+    if (value < -1.0f) value = -1.0f;
+    float scaled = value * 32767.0f;
+    return (int16_t)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+}
+
+// Projects the normal onto an octahedron and unfolds it into a square
+static void encode_octahedral(const float normal[3], int16_t out[2]) {
+    float sum = base_fabsf(normal[0]) + base_fabsf(normal[1]) + base_fabsf(normal[2]);
+    float x = sum > 0.0f ? normal[0] / sum : 0.0f;
+    float y = sum > 0.0f ? normal[1] / sum : 0.0f;
+    if (normal[2] < 0.0f) {
+        float folded_x = (1.0f - base_fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float folded_y = (1.0f - base_fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = folded_x;
+        y = folded_y;
+    }
+    out[0] = float_to_snorm16(x);
+    out[1] = float_to_snorm16(y);
+}
+
+static uint16_t quantize_unorm16(float value, float min, float max) {
+    if (max <= min) {
+        return 0;
+    }
+    float scaled = (value - min) / (max - min) * 65535.0f + 0.5f;
+    if (scaled <= 0.0f) return 0;
+    if (scaled >= 65535.0f) return 65535;
+    return (uint16_t)scaled;
+}
+
+static void pack_vertex(const SceneVertex *v, const SceneMesh *mesh, ScenePackedVertex *out) {
+    for (int axis = 0; axis < 3; axis++) {
+        out->position[axis] = quantize_unorm16(v->position[axis], mesh->bounds_min[axis], mesh->bounds_max[axis]);
+    }
+    out->material = (uint8_t)v->surface_type;
+    out->pad = 0;
+    encode_octahedral(v->normal, out->normal);
+    out->uv[0] = float_to_half(v->uv[0]);
+    out->uv[1] = float_to_half(v->uv[1]);
+}
+
 uint64_t scene_builder_serialize(SceneBuilder *builder, uint8_t **out_blob) {
     if (!builder || !out_blob) {
         SDL_Log("Invalid arguments to scene_builder_serialize");
         return 0;
     }
 
-    // Phase 1: Calculate sizes
-    uint64_t vertex_size = sizeof(SceneVertex) * builder->vertex_count;
-    uint64_t index_size = sizeof(uint16_t) * builder->index_count;
+    // Phase 1: Calculate sizes. Each mesh's indices start 4-byte aligned and
+    // the index section ends 8-byte aligned, for the sections after it.
+    bool packed = builder->vertex_format == SCENE_VERTEX_PACKED;
+    uint64_t vertex_size = (packed ? sizeof(ScenePackedVertex) : sizeof(SceneVertex)) * builder->vertex_count;
+    uint64_t index_size = 0;
+    for (uint32_t m = 0; m < builder->mesh_count; m++) {
+        const SceneMesh *mesh = &builder->meshes[m];
+        index_size += ((uint64_t)mesh->index_size * mesh->index_count + 3) & ~(uint64_t)3;
+    }
+    index_size = (index_size + 7) & ~(uint64_t)7;
     uint64_t light_size = sizeof(SceneLight) * builder->light_count;
     uint64_t texture_size = sizeof(SceneTexture) * builder->texture_count;
+    uint64_t mesh_size = sizeof(SceneMesh) * builder->mesh_count;
 
     // Calculate string arena size (null-terminated paths)
     uint64_t string_size = 0;
@@ -1590,7 +1932,7 @@ uint64_t scene_builder_serialize(SceneBuilder *builder, uint8_t **out_blob) {
     }
 
     uint64_t total_size = sizeof(SceneHeader) + vertex_size + index_size +
-                          light_size + texture_size + string_size;
+                          light_size + texture_size + mesh_size + string_size;
 
     if (total_size > (uint64_t)SIZE_MAX) {
         SDL_Log("Serialized scene too large for platform address space (%llu bytes)", (unsigned long long)total_size);
@@ -1604,6 +1946,7 @@ uint64_t scene_builder_serialize(SceneBuilder *builder, uint8_t **out_blob) {
         SDL_Log("Failed to allocate serialization blob");
         return 0;
     }
+    base_memset(blob, 0, total_size_size_t);
 
     // Phase 2: Write data with offsets
     SceneHeader *header = (SceneHeader *)blob;
@@ -1614,36 +1957,71 @@ uint64_t scene_builder_serialize(SceneBuilder *builder, uint8_t **out_blob) {
     uint64_t offset = sizeof(SceneHeader);
 
     // Write vertices
-    header->vertices = (SceneVertex *)(uintptr_t)offset;
+    header->vertices = offset;
     header->vertex_size = vertex_size;
     header->vertex_count = builder->vertex_count;
-    base_memcpy(blob + offset, builder->vertices, (size_t)vertex_size);
+    header->vertex_format = packed ? SCENE_VERTEX_PACKED : SCENE_VERTEX_FLOAT;
+    if (packed) {
+        // Positions are quantized within the bounds of their mesh
+        ScenePackedVertex *vertices = (ScenePackedVertex *)(blob + offset);
+        for (uint32_t m = 0; m < builder->mesh_count; m++) {
+            const SceneMesh *mesh = &builder->meshes[m];
+            for (uint32_t i = mesh->first_vertex; i < mesh->first_vertex + mesh->vertex_count; i++) {
+                pack_vertex(&builder->vertices[i], mesh, &vertices[i]);
+            }
+        }
+    } else {
+        base_memcpy(blob + offset, builder->vertices, (size_t)vertex_size);
+    }
     offset += vertex_size;
 
-    // Write indices
-    header->indices = (uint16_t *)(uintptr_t)offset;
+    // Write indices, relative to each mesh's first vertex
+    header->indices = offset;
     header->index_size = index_size;
     header->index_count = builder->index_count;
-    base_memcpy(blob + offset, builder->indices, (size_t)index_size);
+    SceneMesh *meshes = (SceneMesh *)(blob + offset + index_size + light_size + texture_size);
+    uint64_t index_cursor = 0;
+    for (uint32_t m = 0; m < builder->mesh_count; m++) {
+        SceneMesh *mesh = &meshes[m];
+        *mesh = builder->meshes[m];
+        const uint32_t *src = builder->indices + mesh->index_offset;
+        uint8_t *dst = blob + offset + index_cursor;
+        for (uint32_t i = 0; i < mesh->index_count; i++) {
+            uint32_t index = src[i] - mesh->first_vertex;
+            if (mesh->index_size == SCENE_INDEX_16) {
+                ((uint16_t *)dst)[i] = (uint16_t)index;
+            } else {
+                ((uint32_t *)dst)[i] = index;
+            }
+        }
+        mesh->index_offset = index_cursor;
+        index_cursor += ((uint64_t)mesh->index_size * mesh->index_count + 3) & ~(uint64_t)3;
+    }
     offset += index_size;
 
     // Write lights
-    header->lights = (SceneLight *)(uintptr_t)offset;
+    header->lights = offset;
     header->light_size = light_size;
     header->light_count = builder->light_count;
     base_memcpy(blob + offset, builder->lights, (size_t)light_size);
     offset += light_size;
 
     // Write textures
-    header->textures = (SceneTexture *)(uintptr_t)offset;
+    header->textures = offset;
     header->texture_size = texture_size;
     header->texture_count = builder->texture_count;
 
     SceneTexture *textures = (SceneTexture *)(blob + offset);
     offset += texture_size;
 
+    // Write meshes (filled in with the indices)
+    header->meshes = offset;
+    header->mesh_size = mesh_size;
+    header->mesh_count = builder->mesh_count;
+    offset += mesh_size;
+
     // Write string arena
-    header->strings = (char *)(uintptr_t)offset;
+    header->strings = offset;
     header->string_size = string_size;
 
     uint64_t string_offset_cursor = 0;
@@ -1661,6 +2039,19 @@ uint64_t scene_builder_serialize(SceneBuilder *builder, uint8_t **out_blob) {
         }
     }
 
+    // Checksums of the sections, then of the header with them
+    const uint64_t section_offsets[SCENE_SECTION_COUNT] = {
+        header->vertices, header->indices, header->lights, header->textures, header->meshes, header->strings,
+    };
+    const uint64_t section_sizes[SCENE_SECTION_COUNT] = {
+        vertex_size, index_size, light_size, texture_size, mesh_size, string_size,
+    };
+    for (int i = 0; i < SCENE_SECTION_COUNT; i++) {
+        header->checksums[i] = hash64(blob + section_offsets[i], (size_t)section_sizes[i], 0);
+    }
+    header->source_key = builder->source_key;
+    header->header_checksum = hash64(header, offsetof(SceneHeader, header_checksum), 0);
+
     *out_blob = blob;
     SDL_Log("Serialized scene: %llu bytes", (unsigned long long)total_size);
     return total_size;
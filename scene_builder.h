@@ -13,6 +13,11 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Version of the scenes the builder produces from a given configuration and
+// assets. Bump it whenever that output changes, so that scenes cached by the
+// game are rebuilt.
+#define SCENE_BUILDER_VERSION 1
+
 // Configuration for scene generation
 typedef struct {
     int *map_data;           // Grid map (0=empty, 1=wall, 2=window_ns, 3=window_ew, 9=light)
@@ -36,6 +41,14 @@ typedef struct {
     const char *chair_texture_path;
     const char *window_texture_path;
     const char *ceiling_light_texture_path;
+
+    // Layout of the serialized vertices: SCENE_VERTEX_FLOAT (the default) or
+    // SCENE_VERTEX_PACKED, which needs the packed scene vertex shader
+    uint32_t vertex_format;
+
+    // Stored in the header (SceneHeader.source_key) to identify the inputs
+    // a cached scene file was built from
+    uint64_t source_key;
 } SceneConfig;
 
 // Opaque scene builder context
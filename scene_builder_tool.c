@@ -14,6 +14,7 @@
 #include <platform/platform.h>
 #include <base/arena.h>
 #include <base/base_io.h>
+#include <base/jobs.h>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -55,6 +56,7 @@ static int default_map[MAP_HEIGHT * MAP_WIDTH] = {
 int main(int argc, char *argv[]) {
     // Initialize platform
     platform_init(argc, argv);
+    jobs_init(0);
 
     printf("Scene Builder Tool v1.0\n");
     printf("=======================\n\n");
@@ -130,6 +132,7 @@ int main(int argc, char *argv[]) {
 
     // Cleanup
     scene_builder_free(builder);
+    jobs_shutdown();
 
     return 0;
 }
@@ -2,7 +2,9 @@
  * Scene Serialization Format
  *
  * Defines the binary format for serialized 3D scenes using offset-based
- * arena approach for zero-copy deserialization via mmap.
+ * arena approach for zero-copy deserialization via mmap. Sections are
+ * referenced by byte offsets from the start of the blob, which is never
+ * written after serialization, so it can be mapped read-only.
  */
 
 #ifndef SCENE_FORMAT_H
@@ -11,7 +13,28 @@
 #include <stdint.h>
 
 #define SCENE_MAGIC 0x53434E45  // "SCNE"
-#define SCENE_VERSION 1
+#define SCENE_VERSION 3       // Version 2 has no checksums; version 1 has one mesh with 16-bit
+                              // indices, see SceneHeaderV1
+
+// Size in bytes of one index of a SceneMesh
+#define SCENE_INDEX_16 2
+#define SCENE_INDEX_32 4
+
+// SceneMesh.material of a mesh whose vertices have different surface types
+#define SCENE_MATERIAL_MIXED 0xFFFFFFFFu
+
+// SceneHeader.vertex_format: the layout of the vertices
+#define SCENE_VERTEX_FLOAT 0   // SceneVertex
+#define SCENE_VERTEX_PACKED 1  // ScenePackedVertex, decoded by the vertex shader
+
+// Sections of a scene, indexing SceneHeader.checksums
+#define SCENE_SECTION_VERTICES 0
+#define SCENE_SECTION_INDICES 1
+#define SCENE_SECTION_LIGHTS 2
+#define SCENE_SECTION_TEXTURES 3
+#define SCENE_SECTION_MESHES 4
+#define SCENE_SECTION_STRINGS 5
+#define SCENE_SECTION_COUNT 6
 
 // GPU-ready vertex format (matches game.c MapVertex)
 typedef struct {
@@ -21,6 +44,17 @@ typedef struct {
     float normal[3];       // Normal vector
 } SceneVertex;
 
+// Packed vertex format, 16 bytes instead of 36. Read by the vertex shader as
+// four 32-bit words (little-endian): x | y << 16, z | material << 16,
+// normal[0] | normal[1] << 16 and uv[0] | uv[1] << 16.
+typedef struct {
+    uint16_t position[3];  // Unorm position within the bounds of its SceneMesh
+    uint8_t material;      // Surface type (0-7)
+    uint8_t pad;
+    int16_t normal[2];     // Snorm octahedral-encoded normal
+    uint16_t uv[2];        // Half-float texture coordinates
+} ScenePackedVertex;
+
 // Light data (GPU-compatible layout with padding)
 typedef struct {
     float position[3];
@@ -29,13 +63,28 @@ typedef struct {
     float pad1;
 } SceneLight;
 
-// Texture reference (path_offset becomes pointer after fixup)
+// Texture reference
 typedef struct {
     uint64_t path_offset;      // Offset to string in string arena
     uint32_t surface_type_id;  // 0-7 material ID
     uint32_t pad;              // Alignment
 } SceneTexture;
 
+// A range of the vertices with its own indices, drawn with one draw call.
+// Indices count from first_vertex, so a mesh of up to 65536 vertices has
+// 16-bit indices however large the scene is.
+typedef struct {
+    uint32_t first_vertex;     // Vertex range
+    uint32_t vertex_count;
+    uint64_t index_offset;     // Byte offset of its indices in the index data, a multiple of 4
+    uint32_t index_count;
+    uint32_t index_size;       // SCENE_INDEX_16 or SCENE_INDEX_32
+    uint32_t material;         // Surface type (0-7) of all its vertices, or SCENE_MATERIAL_MIXED
+    uint32_t pad;
+    float bounds_min[3];       // Bounding box of its vertices
+    float bounds_max[3];
+} SceneMesh;
+
 // Scene file header
 typedef struct {
     uint32_t magic;            // SCENE_MAGIC (0x53434E45)
@@ -43,40 +92,90 @@ typedef struct {
     uint64_t total_size;       // Total size of serialized blob
 
     // Vertex data
-    SceneVertex *vertices;     // Pointer to SceneVertex array (offset before fixup)
+    uint64_t vertices;         // Offset of the vertices, see vertex_format
     uint64_t vertex_size;      // Size in bytes
     uint32_t vertex_count;     // Number of vertices
-    uint32_t pad0;
+    uint32_t vertex_format;    // SCENE_VERTEX_FLOAT or SCENE_VERTEX_PACKED
 
-    // Index data
-    uint16_t *indices;         // Pointer to uint16_t indices (offset before fixup)
+    // Index data of all meshes
+    uint64_t indices;          // Offset of the indices
     uint64_t index_size;       // Size in bytes
-    uint32_t index_count;      // Number of indices
+    uint32_t index_count;      // Number of indices of all meshes
     uint32_t pad1;
 
     // Light data
-    SceneLight *lights;        // Pointer to SceneLight array (offset before fixup)
+    uint64_t lights;           // Offset of the SceneLight array
     uint64_t light_size;       // Size in bytes
     uint32_t light_count;      // Number of lights
     uint32_t pad2;
 
     // Texture data
-    SceneTexture *textures;    // Pointer to SceneTexture array (offset before fixup)
+    uint64_t textures;         // Offset of the SceneTexture array
     uint64_t texture_size;     // Size in bytes
     uint32_t texture_count;    // Number of textures
     uint32_t pad3;
 
     // String arena (for texture paths, etc.)
-    char *strings;             // Pointer to string arena (offset before fixup)
+    uint64_t strings;          // Offset of the string arena
     uint64_t string_size;      // Size of string arena
+
+    // Mesh table
+    uint64_t meshes;           // Offset of the SceneMesh array
+    uint64_t mesh_size;        // Size in bytes
+    uint32_t mesh_count;       // Number of meshes
+    uint32_t pad4;
+
+    // Version 3: hash64 (base/hash.h, seed 0) of the bytes of each section,
+    // by SCENE_SECTION_*, and of the header up to header_checksum
+    uint64_t source_key;       // SceneConfig.source_key of the inputs it was built from
+    uint64_t checksums[SCENE_SECTION_COUNT];
+    uint64_t header_checksum;
 } SceneHeader;
 
 // Blob layout:
 // [SceneHeader]
-// [SceneVertex array]     ← vertices (offset until pointer fixup)
-// [uint16_t indices]      ← indices (offset until pointer fixup)
-// [SceneLight array]      ← lights (offset until pointer fixup)
-// [SceneTexture array]    ← textures (offset until pointer fixup)
-// [String arena]          ← strings (offset until pointer fixup, null-terminated strings)
+// [Vertices]              ← vertices, SceneVertex or ScenePackedVertex
+// [Indices]               ← indices, per mesh uint16_t or uint32_t, each
+//                           mesh's 4-byte aligned, padded to 8 bytes
+// [SceneLight array]      ← lights
+// [SceneTexture array]    ← textures
+// [SceneMesh array]       ← meshes
+// [String arena]          ← strings (null-terminated strings)
+
+// Header of version 1 scenes, which have no mesh table: their uint16_t
+// indices index all vertices and are drawn at once.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t total_size;
+    uint64_t vertices;
+    uint64_t vertex_size;
+    uint32_t vertex_count;
+    uint32_t pad0;
+    uint64_t indices;
+    uint64_t index_size;
+    uint32_t index_count;
+    uint32_t pad1;
+    uint64_t lights;
+    uint64_t light_size;
+    uint32_t light_count;
+    uint32_t pad2;
+    uint64_t textures;
+    uint64_t texture_size;
+    uint32_t texture_count;
+    uint32_t pad3;
+    uint64_t strings;
+    uint64_t string_size;
+} SceneHeaderV1;
+
+// Index `i` of `mesh` in `indices` (see scene_indices), as an index into
+// all the vertices
+static inline uint32_t scene_mesh_index(const void *indices, const SceneMesh *mesh, uint32_t i) {
+    const uint8_t *data = (const uint8_t *)indices + mesh->index_offset;
+    if (mesh->index_size == SCENE_INDEX_16) {
+        return mesh->first_vertex + ((const uint16_t *)data)[i];
+    }
+    return mesh->first_vertex + ((const uint32_t *)data)[i];
+}
 
 #endif // SCENE_FORMAT_H
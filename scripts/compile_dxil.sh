@@ -9,6 +9,7 @@ DXC="C:/Program Files (x86)/Windows Kits/10/bin/10.0.26100.0/x64/dxc.exe"
 
 # Compile vertex shaders
 "$DXC" -T vs_6_0 -E main_ -Fo shaders/DXIL/mousecircle_scene_vertex.dxil shaders/HLSL/mousecircle_scene_vertex.hlsl
+"$DXC" -T vs_6_0 -E main_ -Fo shaders/DXIL/mousecircle_scene_packed_vertex.dxil shaders/HLSL/mousecircle_scene_packed_vertex.hlsl
 "$DXC" -T vs_6_0 -E main_ -Fo shaders/DXIL/mousecircle_overlay_vertex.dxil shaders/HLSL/mousecircle_overlay_vertex.hlsl
 
 # Compile fragment shaders (pixel shaders in D3D terminology)
@@ -167,6 +167,7 @@ typedef enum {
     SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
     SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
     SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
+    SDL_GPU_VERTEXELEMENTFORMAT_UINT4,
 } SDL_GPUVertexElementFormat;
 
 typedef enum {
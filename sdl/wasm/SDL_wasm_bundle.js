@@ -1,84 +1,306 @@
 // Bundle Loader for JSFS Binary Format
-// Parses bundled files and creates a mapping for instant filesystem access
+// Looks files up straight in the bundle bytes, without parsing it first
+
+const HEADER_SIZE = 40;
+const ENTRY_SIZE = 32;
+const CODEC_NONE = 0;
+const CODEC_LZ = 1;
+const LZ_FRAME_HEADER_SIZE = 16;
+const LZ_MIN_MATCH = 4;
 
 /**
- * Parse a JSFS bundle and return a Map of path -> Uint8Array
+ * FNV-1a hash of UTF-8 bytes, the same as bundle_path_hash in bundle_format.h
  *
- * Bundle Format:
- * - Header (9 bytes):
- *   - Magic bytes: 'JSFS' (4 bytes)
- *   - Version: 1 (1 byte)
- *   - Number of files: uint32 big-endian (4 bytes)
- * - Metadata (per file):
- *   - Path length: uint16 big-endian (2 bytes)
- *   - Path: UTF-8 string
- *   - File size: uint64 big-endian (8 bytes)
- *   - Content offset: uint64 big-endian (8 bytes)
- * - Contents: Concatenated file contents
+ * @param {Uint8Array} bytes
+ * @returns {number} - Unsigned 32-bit hash
+ */
+function pathHash(bytes) {
+    let hash = 2166136261;
+    for (let i = 0; i < bytes.length; i++) {
+        hash ^= bytes[i];
+        hash = Math.imul(hash, 16777619);
+    }
+    return hash >>> 0;
+}
+
+function readU64(view, offset) {
+    const low = view.getUint32(offset, true);
+    const high = view.getUint32(offset + 4, true);
+    return (high * 0x100000000) + low;
+}
+
+function lzLength(src, ip, length) {
+    let byte;
+    do {
+        if (ip >= src.length) {
+            throw new Error('Truncated LZ block');
+        }
+        byte = src[ip++];
+        length += byte;
+    } while (byte === 255);
+    return [ip, length];
+}
+
+/**
+ * Decode an LZ4 block into `dst`, the same as lz_decompress in base/lz.c
  *
- * @param {ArrayBuffer} arrayBuffer - The bundle binary data
- * @returns {Map<string, Uint8Array>} - Map from file path to file contents
+ * @param {Uint8Array} src
+ * @param {Uint8Array} dst
+ * @returns {number} - Decoded size
  */
-export function loadBundle(arrayBuffer) {
-    const view = new DataView(arrayBuffer);
-    const bytes = new Uint8Array(arrayBuffer);
-    const decoder = new TextDecoder('utf-8');
+function lzDecompress(src, dst) {
+    let ip = 0;
+    let op = 0;
+    for (;;) {
+        if (ip >= src.length) {
+            throw new Error('Truncated LZ block');
+        }
+        const token = src[ip++];
+        let literalCount = token >> 4;
+        if (literalCount === 15) {
+            [ip, literalCount] = lzLength(src, ip, literalCount);
+        }
+        if (ip + literalCount > src.length || op + literalCount > dst.length) {
+            throw new Error('Malformed LZ block');
+        }
+        for (let i = 0; i < literalCount; i++) {
+            dst[op + i] = src[ip + i];
+        }
+        ip += literalCount;
+        op += literalCount;
+        // Only the last sequence has no match
+        if (ip === src.length) {
+            return op;
+        }
 
-    let offset = 0;
+        if (ip + 2 > src.length) {
+            throw new Error('Truncated LZ block');
+        }
+        const offset = src[ip] | (src[ip + 1] << 8);
+        ip += 2;
+        let length = token & 15;
+        if (length === 15) {
+            [ip, length] = lzLength(src, ip, length);
+        }
+        length += LZ_MIN_MATCH;
+        if (offset === 0 || offset > op || op + length > dst.length) {
+            throw new Error('Malformed LZ block');
+        }
+        // Forward byte copy, so overlapping matches repeat the pattern
+        for (let i = 0; i < length; i++) {
+            dst[op + i] = dst[op - offset + i];
+        }
+        op += length;
+    }
+}
 
-    // Parse header
-    const magic = decoder.decode(bytes.subarray(offset, offset + 4));
-    offset += 4;
+/**
+ * Decode an LZ frame (see base/lz.h): a block table followed by blocks that
+ * are LZ4 blocks, or stored as is if as long as their decoded size
+ *
+ * @param {Uint8Array} frame
+ * @returns {Uint8Array} - The decoded data
+ */
+export function lzFrameDecompress(frame) {
+    if (frame.length < LZ_FRAME_HEADER_SIZE) {
+        throw new Error('Truncated LZ frame');
+    }
+    const view = new DataView(frame.buffer, frame.byteOffset, frame.byteLength);
+    const size = readU64(view, 0);
+    const blockSize = view.getUint32(8, true);
+    const blockCount = view.getUint32(12, true);
+    const dataOffset = LZ_FRAME_HEADER_SIZE + blockCount * 8;
+    if (blockSize === 0 || blockCount !== Math.ceil(size / blockSize) || dataOffset > frame.length) {
+        throw new Error('Malformed LZ frame');
+    }
 
-    if (magic !== 'JSFS') {
-        throw new Error(`Invalid bundle magic: expected 'JSFS', got '${magic}'`);
+    const out = new Uint8Array(size);
+    let begin = 0;
+    for (let i = 0; i < blockCount; i++) {
+        const end = readU64(view, LZ_FRAME_HEADER_SIZE + i * 8);
+        const decodedSize = Math.min(blockSize, size - i * blockSize);
+        if (end <= begin || end - begin > decodedSize || dataOffset + end > frame.length) {
+            throw new Error('Malformed LZ frame');
+        }
+        const block = frame.subarray(dataOffset + begin, dataOffset + end);
+        const dst = out.subarray(i * blockSize, i * blockSize + decodedSize);
+        if (block.length === decodedSize) {
+            dst.set(block);
+        } else if (lzDecompress(block, dst) !== decodedSize) {
+            throw new Error('Malformed LZ frame');
+        }
+        begin = end;
     }
+    return out;
+}
 
-    const version = view.getUint8(offset);
-    offset += 1;
+/**
+ * A version 2 or 3 bundle (see bundle_format.h). Only the header is read
+ * when the bundle is opened; get() hashes the path and probes the index in
+ * the bundle bytes. Files stored as is are views into the bundle, not
+ * copies; compressed ones are decoded by every get(), so only the files that
+ * are used are decoded.
+ *
+ * Has the part of the Map interface that reads no contents: get, has, size
+ * and keys. There is no entries() or forEach, which would decode every
+ * compressed file; walk keys() and get() the paths that are needed.
+ */
+export class JsfsBundle {
+    /**
+     * @param {ArrayBuffer} arrayBuffer - The bundle binary data
+     */
+    constructor(arrayBuffer) {
+        this.bytes = new Uint8Array(arrayBuffer);
+        this.view = new DataView(arrayBuffer);
+        if (arrayBuffer.byteLength < HEADER_SIZE) {
+            throw new Error(`Bundle too small: ${arrayBuffer.byteLength} bytes`);
+        }
+        this.fileCount = this.view.getUint32(8, true);
+        this.slotCount = this.view.getUint32(12, true);
+        this.indexOffset = this.view.getUint32(16, true);
+        this.entriesOffset = this.view.getUint32(20, true);
+        const totalSize = readU64(this.view, 32);
+        if (totalSize !== arrayBuffer.byteLength) {
+            throw new Error(`Bundle size mismatch: header says ${totalSize}, got ${arrayBuffer.byteLength}`);
+        }
+        if (this.slotCount === 0 || (this.slotCount & (this.slotCount - 1)) !== 0
+                || this.slotCount < 2 * this.fileCount) {
+            throw new Error(`Invalid bundle index size: ${this.slotCount}`);
+        }
+        this.encoder = new TextEncoder();
+        this.decoder = new TextDecoder('utf-8');
+    }
 
-    if (version !== 1) {
-        throw new Error(`Unsupported bundle version: ${version}`);
+    get size() {
+        return this.fileCount;
     }
 
-    const fileCount = view.getUint32(offset, false); // big-endian
-    offset += 4;
+    /**
+     * Index of the entry of `path`, or -1
+     */
+    findEntry(path) {
+        const pathBytes = this.encoder.encode(path);
+        const hash = pathHash(pathBytes);
+        const mask = this.slotCount - 1;
+        for (let i = hash & mask; ; i = (i + 1) & mask) {
+            const slot = this.view.getUint32(this.indexOffset + i * 4, true);
+            if (slot === 0) {
+                return -1;
+            }
+            const entry = this.entriesOffset + (slot - 1) * ENTRY_SIZE;
+            if (this.view.getUint32(entry, true) !== hash
+                    || this.view.getUint32(entry + 8, true) !== pathBytes.length) {
+                continue;
+            }
+            const pathOffset = this.view.getUint32(entry + 4, true);
+            let j = 0;
+            while (j < pathBytes.length && this.bytes[pathOffset + j] === pathBytes[j]) {
+                j++;
+            }
+            if (j === pathBytes.length) {
+                return slot - 1;
+            }
+        }
+    }
 
-    console.log(`[BundleLoader] Loading bundle: version=${version}, files=${fileCount}`);
+    entryPath(index) {
+        const entry = this.entriesOffset + index * ENTRY_SIZE;
+        const pathOffset = this.view.getUint32(entry + 4, true);
+        const pathSize = this.view.getUint32(entry + 8, true);
+        return this.decoder.decode(this.bytes.subarray(pathOffset, pathOffset + pathSize));
+    }
 
-    // Parse metadata
-    const files = new Map();
+    entryContent(index) {
+        const entry = this.entriesOffset + index * ENTRY_SIZE;
+        const codec = this.view.getUint32(entry + 12, true);
+        const offset = readU64(this.view, entry + 16);
+        const size = readU64(this.view, entry + 24);
+        const stored = this.bytes.subarray(offset, offset + size);
+        if (codec === CODEC_NONE) {
+            return stored;
+        }
+        if (codec === CODEC_LZ) {
+            return lzFrameDecompress(stored);
+        }
+        throw new Error(`Unsupported codec ${codec} for ${this.entryPath(index)}`);
+    }
+
+    /**
+     * @param {string} path
+     * @returns {Uint8Array|undefined} - The file contents
+     */
+    get(path) {
+        const index = this.findEntry(path);
+        return index < 0 ? undefined : this.entryContent(index);
+    }
+
+    has(path) {
+        return this.findEntry(path) >= 0;
+    }
+
+    *keys() {
+        for (let i = 0; i < this.fileCount; i++) {
+            yield this.entryPath(i);
+        }
+    }
+}
+
+/**
+ * Parse a version 1 bundle into a Map of path -> Uint8Array
+ *
+ * Version 1 Format (big-endian):
+ * - Header (9 bytes): magic 'JSFS', version 1 (uint8), number of files (uint32)
+ * - Metadata (per file): path length (uint16), path (UTF-8),
+ *   file size (uint64), content offset (uint64)
+ * - Contents: Concatenated file contents
+ */
+function loadBundleV1(arrayBuffer) {
+    const view = new DataView(arrayBuffer);
+    const bytes = new Uint8Array(arrayBuffer);
+    const decoder = new TextDecoder('utf-8');
+
+    let offset = 5;
+    const fileCount = view.getUint32(offset, false);
+    offset += 4;
 
+    const files = new Map();
     for (let i = 0; i < fileCount; i++) {
-        // Read path length
-        const pathLen = view.getUint16(offset, false); // big-endian
+        const pathLen = view.getUint16(offset, false);
         offset += 2;
-
-        // Read path
-        const pathBytes = bytes.subarray(offset, offset + pathLen);
-        const path = decoder.decode(pathBytes);
+        const path = decoder.decode(bytes.subarray(offset, offset + pathLen));
         offset += pathLen;
-
-        // Read file size (uint64 - we'll use Number, should be safe for reasonable file sizes)
-        const sizeHigh = view.getUint32(offset, false);
-        const sizeLow = view.getUint32(offset + 4, false);
-        const size = (sizeHigh * 0x100000000) + sizeLow;
+        const size = (view.getUint32(offset, false) * 0x100000000) + view.getUint32(offset + 4, false);
         offset += 8;
-
-        // Read content offset (uint64)
-        const offsetHigh = view.getUint32(offset, false);
-        const offsetLow = view.getUint32(offset + 4, false);
-        const contentOffset = (offsetHigh * 0x100000000) + offsetLow;
+        const contentOffset = (view.getUint32(offset, false) * 0x100000000) + view.getUint32(offset + 4, false);
         offset += 8;
+        files.set(path, bytes.slice(contentOffset, contentOffset + size));
+    }
+    return files;
+}
 
-        // Extract file content
-        const content = bytes.slice(contentOffset, contentOffset + size);
-        files.set(path, content);
-
-        console.log(`[BundleLoader]   ${path}: ${size} bytes at offset ${contentOffset}`);
+/**
+ * Open a JSFS bundle
+ *
+ * @param {ArrayBuffer} arrayBuffer - The bundle binary data
+ * @returns {JsfsBundle|Map<string, Uint8Array>} - Path -> file contents
+ */
+export function loadBundle(arrayBuffer) {
+    const bytes = new Uint8Array(arrayBuffer);
+    const magic = new TextDecoder('utf-8').decode(bytes.subarray(0, 4));
+    if (magic !== 'JSFS') {
+        throw new Error(`Invalid bundle magic: expected 'JSFS', got '${magic}'`);
     }
 
-    console.log(`[BundleLoader] Successfully loaded ${files.size} files from bundle`);
+    const version = bytes[4];
+    let files;
+    if (version === 2 || version === 3) {
+        files = new JsfsBundle(arrayBuffer);
+    } else if (version === 1) {
+        files = loadBundleV1(arrayBuffer);
+    } else {
+        throw new Error(`Unsupported bundle version: ${version}`);
+    }
+    console.log(`[BundleLoader] Opened bundle: version=${version}, files=${files.size}`);
     return files;
 }
 
@@ -86,7 +308,7 @@ export function loadBundle(arrayBuffer) {
  * Fetch and load a bundle from a URL
  *
  * @param {string} url - The URL to fetch the bundle from
- * @returns {Promise<Map<string, Uint8Array>>} - Map from file path to file contents
+ * @returns {Promise<JsfsBundle|Map<string, Uint8Array>>} - Path -> file contents
  */
 export async function fetchBundle(url) {
     console.log(`[BundleLoader] Fetching bundle from ${url}`);
@@ -225,13 +225,15 @@ export function createWasmSDLHost(device, canvas) {
                 }
 
                 const tasks = [];
-                for (const [path, rawBytes] of bundleMap.entries()) {
+                // Only the images are read from the bundle, not the other files
+                for (const path of bundleMap.keys()) {
                     if (!isImagePath(path)) {
                         continue;
                     }
                     if (imageAssets.has(path)) {
                         continue;
                     }
+                    const rawBytes = bundleMap.get(path);
                     const bytes = rawBytes instanceof Uint8Array ? rawBytes : new Uint8Array(rawBytes);
                     tasks.push((async () => {
                         try {
@@ -1057,6 +1059,7 @@ export function createWasmSDLHost(device, canvas) {
                         1: 'float32x2',  // SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2
                         2: 'float32x3',  // SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3
                         3: 'float32x4',  // SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4
+                        4: 'uint32x4',   // SDL_GPU_VERTEXELEMENTFORMAT_UINT4
                     };
 
                     const vertexBuffers = [];
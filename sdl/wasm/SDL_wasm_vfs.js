@@ -3,6 +3,7 @@
 
 export function createFetchingVirtualFileSystem() {
     const fileCache = new Map();  // path -> Uint8Array
+    let bundle = null;            // path -> Uint8Array, looked up on open
     const openFiles = new Map();  // fd -> {data, offset}
     let memory = null;
     let nextFd = 4;
@@ -32,7 +33,7 @@ export function createFetchingVirtualFileSystem() {
             const path = readPath(pathPtr, pathLen);
             console.log(`[VFS] Opening: ${path}`);
 
-            const data = fileCache.get(path);
+            const data = fileCache.get(path) ?? bundle?.get(path);
             if (!data) {
                 console.error(`[VFS] File not cached: ${path}`);
                 return 44; // ENOENT - No such file or directory
@@ -126,13 +127,11 @@ export function createFetchingVirtualFileSystem() {
         return 0; // No arguments
     }
 
-    // Preload files from a bundle map
-    function preloadFromBundle(bundleMap) {
-        for (const [path, content] of bundleMap.entries()) {
-            fileCache.set(path, content);
-            console.log(`[VFS] Preloaded from bundle: ${path} (${content.length} bytes)`);
-        }
-        console.log(`[VFS] Preloaded ${bundleMap.size} files from bundle`);
+    // Serve files from a bundle map. Nothing is read from it until a file is
+    // opened, so only the files the game opens are looked up and decoded.
+    function mountBundle(bundleMap) {
+        bundle = bundleMap;
+        console.log(`[VFS] Mounted bundle with ${bundleMap.size} files`);
     }
 
     return {
@@ -143,7 +142,7 @@ export function createFetchingVirtualFileSystem() {
         fd_tell: fd_seek,  // fd_tell is same as fd_seek in practice
         args_sizes_get,
         args_get,
-        preloadFromBundle,
+        mountBundle,
         setMemory(mem) {
             memory = mem;
             console.log('[VFS] Memory set');
@@ -0,0 +1,55 @@
+const MAX_STATIC_LIGHTS: u32 = 16u;
+
+struct SceneUniforms {
+    mvp: mat4x4f,
+    cameraPos: vec4f,
+    fogColor: vec4f,
+    staticLights: array<vec4f, MAX_STATIC_LIGHTS>,
+    staticLightColors: array<vec4f, MAX_STATIC_LIGHTS>,
+    staticLightParams: vec4f,
+    flashlightPos: vec4f,
+    flashlightDir: vec4f,
+    flashlightParams: vec4f,
+    screenParams: vec4f,
+};
+
+// ScenePackedVertex (scene_format.h) as four words, and the bounds of its
+// mesh, one instance per mesh
+struct VertexInput {
+    @location(0) words: vec4u,
+    @location(1) boundsMin: vec4f,
+    @location(2) boundsExtent: vec4f,
+};
+
+struct VertexOutput {
+    @builtin(position) position: vec4f,
+    @location(0) surfaceType: f32,
+    @location(1) uv: vec2f,
+    @location(2) normal: vec3f,
+    @location(3) worldPos: vec3f,
+};
+
+// SDL3 SPIRV requirement: vertex uniform buffers must be in set 1
+@group(1) @binding(0) var<uniform> uniforms: SceneUniforms;
+
+fn decodeOctahedral(e: vec2f) -> vec3f {
+    var n = vec3f(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    let t = max(-n.z, 0.0);
+    n.x += select(t, -t, n.x >= 0.0);
+    n.y += select(t, -t, n.y >= 0.0);
+    return normalize(n);
+}
+
+@vertex
+fn main_(input: VertexInput) -> VertexOutput {
+    var output: VertexOutput;
+    let xy = unpack2x16unorm(input.words.x);
+    let z = f32(input.words.y & 0xFFFFu) / 65535.0;
+    let position = input.boundsMin.xyz + vec3f(xy, z) * input.boundsExtent.xyz;
+    output.position = uniforms.mvp * vec4f(position, 1.0);
+    output.surfaceType = f32((input.words.y >> 16u) & 0xFFu);
+    output.uv = unpack2x16float(input.words.w);
+    output.normal = decodeOctahedral(unpack2x16snorm(input.words.z));
+    output.worldPos = position;
+    return output;
+}
@@ -4,6 +4,7 @@
 #include <base/mem.h>
 #include <base/exit.h>
 #include <base/numconv.h>
+#include <base/sort.h>
 #include <platform.h>
 #include <buddy.h>
 #include <stdlib.h>
@@ -168,6 +169,11 @@ double atof(const char* str) {
     return sign * result;
 }
 
+// Introsort (base/sort.h), not stable, like most qsort implementations
+void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *)) {
+    sort(base, nmemb, size, compar);
+}
+
 int snprintf(char *str, size_t size, const char *format, ...) {
     va_list args;
     va_start(args, format);
@@ -14,3 +14,4 @@ int snprintf(char *str, size_t size, const char *format, ...);
 int atoi(const char *str);
 long long atoll(const char *str);
 double atof(const char *str);
+void qsort(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *));
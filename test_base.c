@@ -10,6 +10,15 @@
 #include <base/base_string.h>
 #include <base/mem.h>
 #include <base/assert.h>
+#include <base/atomics.h>
+#include <base/sync.h>
+#include <base/jobs.h>
+#include <base/profile.h>
+#include <base/sort.h>
+#include <base/lz.h>
+#include <base/hash.h>
+#include <base/bundle.h>
+#include <bundle_format.h>
 #include <test_base.h>
 
 // Define hashtable and vector types for tests
@@ -164,9 +173,18 @@ void test_buddy(void) {
     }
     print("Allocated p3\n");
 
+    // Counters: p2 is an 8 KiB request plus header, so a 16 KiB block
+    BuddyStats stats = buddy_get_stats();
+    assert(stats.allocated_bytes >= 16384 + 4096);
+    assert(stats.peak_allocated_bytes >= stats.allocated_bytes);
+    assert(stats.committed_bytes >= stats.peak_allocated_bytes);
+
     // Free remaining
     buddy_free(p2);
     buddy_free(p3);
+    BuddyStats after = buddy_get_stats();
+    assert(after.allocated_bytes == stats.allocated_bytes - 16384 - 4096);
+    assert(after.peak_allocated_bytes == stats.peak_allocated_bytes);
     print("Buddy allocator tests passed\n");
 }
 
@@ -616,12 +634,460 @@ void test_io(void) {
     println(str_lit("Initial text in README.md:\n{}"), str_substr(text, 0, 100));
     println(str_lit("---"));
 
+    uint64_t handle;
+    string view;
+    ok = read_file_view(arena, str_lit("does not exist"), &view, &handle);
+    assert(!ok);
+    assert(handle == 0);
+    ok = read_file_view(arena, str_lit("README.md"), &view, &handle);
+    assert(ok);
+    assert(view.size == text.size);
+    assert(view.str[view.size-1] == '\0');
+    assert(base_memcmp(view.str, text.str, text.size) == 0);
+    println(str_lit("Viewed README.md: {} bytes (mapped: {})"), view.size,
+            handle != 0 ? str_lit("yes") : str_lit("no"));
+    read_file_view_release(handle);
+
     println(str_lit("Hello from io."));
 
     arena_free(arena);
     println(str_lit("I/O tests passed"));
 }
 
+void test_file_mmap(void) {
+    println(str_lit("## Testing file mapping..."));
+    uint64_t handles[40];
+    void *data;
+    size_t size;
+    if (!platform_read_file_mmap("README.md", PLATFORM_MMAP_READONLY, &handles[0], &data, &size)) {
+        // WASM has no mmap
+        assert(handles[0] == 0);
+        assert(!platform_file_advise(handles[0], PLATFORM_ADVISE_WILLNEED));
+        println(str_lit("File mapping not available, skipped"));
+        return;
+    }
+    assert(size > 100);
+    assert(base_memcmp(data, "# Standalone", 12) == 0);
+    assert(platform_file_advise(handles[0], PLATFORM_ADVISE_SEQUENTIAL | PLATFORM_ADVISE_WILLNEED));
+
+    // More concurrent mappings than the old fixed-size table allowed
+    for (int i = 1; i < 40; i++) {
+        bool ok = platform_read_file_mmap("README.md", PLATFORM_MMAP_READONLY | PLATFORM_MMAP_POPULATE,
+                &handles[i], &data, &size);
+        assert(ok);
+        assert(handles[i] != 0);
+        assert(handles[i] != handles[i-1]);
+    }
+    for (int i = 0; i < 40; i++) {
+        platform_file_unmap(handles[i]);
+    }
+    assert(!platform_file_advise(handles[0], PLATFORM_ADVISE_RANDOM));
+
+    // Copy-on-write mappings are writable
+    assert(platform_read_file_mmap("README.md", 0, &handles[0], &data, &size));
+    ((char *)data)[0] = '!';
+    platform_file_unmap(handles[0]);
+    println(str_lit("File mapping tests passed"));
+}
+
+void test_aio(void) {
+    println(str_lit("## Testing asynchronous file I/O..."));
+    const char* test_file = "test_aio.txt";
+    wasi_fd_t fd = wasi_path_open(test_file, base_strlen(test_file), WASI_RIGHTS_RDWR,
+            WASI_O_CREAT | WASI_O_TRUNC);
+    assert(fd >= 0);
+    assert(platform_aio_init(4));
+    assert(!platform_aio_init(4));
+
+    // Write four 8-byte blocks in reverse order
+    const char *blocks = "block-0\nblock-1\nblock-2\nblock-3\n";
+    for (int i = 3; i >= 0; i--) {
+        assert(platform_aio_write(fd, blocks + 8*i, 8, 8*i, 100 + i));
+    }
+    // The queue is full until completions are reaped
+    assert(!platform_aio_write(fd, blocks, 8, 0, 0));
+    platform_aio_completion_t done[4];
+    size_t n = platform_aio_wait(done, 4, 4);
+    assert(n == 4);
+    uint32_t seen = 0;
+    for (size_t i = 0; i < n; i++) {
+        assert(done[i].user_data >= 100 && done[i].user_data < 104);
+        assert(done[i].result == 8);
+        seen |= 1u << (done[i].user_data - 100);
+    }
+    assert(seen == 0xF);
+
+    // Read them back out of order, plus one read past the end of the file
+    char buf[4][8];
+    assert(platform_aio_read(fd, buf[0], 8, 16, 2));
+    assert(platform_aio_read(fd, buf[1], 8, 0, 0));
+    assert(platform_aio_read(fd, buf[2], 8, 24, 3));
+    assert(platform_aio_read(fd, buf[3], 8, 32, 4));
+    platform_aio_submit();
+    n = 0;
+    while (n < 4) {
+        n += platform_aio_wait(done + n, 4 - n, 1);
+    }
+    for (size_t i = 0; i < n; i++) {
+        uint64_t id = done[i].user_data;
+        if (id == 4) {
+            assert(done[i].result == 0);
+            continue;
+        }
+        assert(done[i].result == 8);
+        char *dst = id == 2 ? buf[0] : (id == 0 ? buf[1] : buf[2]);
+        assert(base_memcmp(dst, blocks + 8*id, 8) == 0);
+    }
+    assert(platform_aio_poll(done, 4) == 0);
+
+    platform_aio_shutdown();
+    assert(wasi_fd_close(fd) == 0);
+    println(str_lit("Asynchronous file I/O tests passed"));
+}
+
+void test_file_positional(void) {
+    println(str_lit("## Testing positional file I/O..."));
+    const char* test_file = "test_pread.txt";
+    wasi_fd_t fd = wasi_path_open(test_file, base_strlen(test_file), WASI_RIGHTS_RDWR,
+            WASI_O_CREAT | WASI_O_TRUNC);
+    assert(fd >= 0);
+
+    ciovec_t iov = {.buf = "0123456789", .buf_len = 10};
+    size_t n;
+    assert(wasi_fd_write(fd, &iov, 1, &n) == 0 && n == 10);
+
+    // Overwrite in the middle; the file does not grow
+    ciovec_t patch[2] = {{.buf = "ab", .buf_len = 2}, {.buf = "cd", .buf_len = 2}};
+    assert(wasi_fd_pwrite(fd, patch, 2, 3, &n) == 0);
+    assert(n == 4);
+
+    filestat_t stat;
+    assert(wasi_fd_filestat_get(fd, &stat) == 0);
+    assert(stat.filetype == WASI_FILETYPE_REGULAR_FILE);
+    assert(stat.size == 10);
+    assert(stat.mtim > 0);
+
+    // Reads do not depend on the file position
+    uint64_t pos;
+    assert(wasi_fd_seek(fd, 0, WASI_SEEK_SET, &pos) == 0);
+    char head[3], tail[8];
+    iovec_t parts[2] = {{.iov_base = head, .iov_len = 3}, {.iov_base = tail, .iov_len = 8}};
+    assert(wasi_fd_pread(fd, parts, 2, 1, &n) == 0);
+    assert(n == 9);
+    assert(base_memcmp(head, "12a", 3) == 0);
+    assert(base_memcmp(tail, "bcd789", 6) == 0);
+
+    // Reading at the end of the file returns no data
+    assert(wasi_fd_pread(fd, parts, 1, 10, &n) == 0);
+    assert(n == 0);
+    assert(wasi_fd_close(fd) == 0);
+    println(str_lit("Positional file I/O tests passed"));
+}
+
+typedef struct {
+    Mutex mutex;
+    CondVar cond;
+    Semaphore items;
+    bool go;
+    uint64_t locked_count;
+    atomic_u64 atomic_count;
+    atomic_u32 consumed;
+} ThreadTestState;
+
+#define THREAD_TEST_THREADS 4
+#define THREAD_TEST_ITERS 10000
+
+typedef struct {
+    ThreadTestState *state;
+    int index;
+} ThreadTestArg;
+
+static int thread_test_worker(void *param) {
+    ThreadTestArg *arg = param;
+    ThreadTestState *st = arg->state;
+
+    // Wait for the start signal
+    mutex_lock(&st->mutex);
+    while (!st->go) {
+        condvar_wait(&st->cond, &st->mutex);
+    }
+    mutex_unlock(&st->mutex);
+
+    for (int i = 0; i < THREAD_TEST_ITERS; i++) {
+        mutex_lock(&st->mutex);
+        st->locked_count++;
+        mutex_unlock(&st->mutex);
+        atomic_fetch_add_u64(&st->atomic_count, 1);
+    }
+
+    // Each worker consumes two items
+    for (int i = 0; i < 2; i++) {
+        semaphore_wait(&st->items);
+        atomic_fetch_add_u32(&st->consumed, 1);
+    }
+    return arg->index + 100;
+}
+
+void test_threads(void) {
+    println(str_lit("## Testing threads..."));
+    assert(platform_cpu_count() >= 1);
+
+    atomic_u32 a = {0};
+    assert(atomic_fetch_add_u32(&a, 5) == 0);
+    assert(atomic_fetch_sub_u32(&a, 2) == 5);
+    uint32_t expected = 4;
+    assert(!atomic_compare_exchange_u32(&a, &expected, 7));
+    assert(expected == 3);
+    assert(atomic_compare_exchange_u32(&a, &expected, 7));
+    assert(atomic_exchange_u32(&a, 1) == 7);
+    assert(atomic_load_u32(&a, ATOMIC_ACQUIRE) == 1);
+
+    ThreadTestState st = {0};
+    assert(mutex_try_lock(&st.mutex));
+    assert(!mutex_try_lock(&st.mutex));
+    mutex_unlock(&st.mutex);
+    semaphore_init(&st.items, 1);
+    assert(semaphore_try_wait(&st.items));
+    assert(!semaphore_try_wait(&st.items));
+
+    platform_thread_t threads[THREAD_TEST_THREADS];
+    ThreadTestArg args[THREAD_TEST_THREADS];
+    args[0] = (ThreadTestArg){.state = &st, .index = 0};
+    if (!platform_thread_create(&threads[0], thread_test_worker, &args[0])) {
+        // WASM has no threads
+        println(str_lit("Threads not available, skipped"));
+        return;
+    }
+    for (int i = 1; i < THREAD_TEST_THREADS; i++) {
+        args[i] = (ThreadTestArg){.state = &st, .index = i};
+        assert(platform_thread_create(&threads[i], thread_test_worker, &args[i]));
+    }
+
+    mutex_lock(&st.mutex);
+    st.go = true;
+    condvar_broadcast(&st.cond);
+    mutex_unlock(&st.mutex);
+
+    for (int i = 0; i < THREAD_TEST_THREADS; i++) {
+        semaphore_post(&st.items, i == 0 ? 1 : 2);
+        platform_thread_yield();
+    }
+    semaphore_post(&st.items, 1);
+
+    for (int i = 0; i < THREAD_TEST_THREADS; i++) {
+        assert(platform_thread_join(threads[i]) == i + 100);
+    }
+    assert(st.locked_count == THREAD_TEST_THREADS * THREAD_TEST_ITERS);
+    assert(atomic_load_u64(&st.atomic_count, ATOMIC_RELAXED) == THREAD_TEST_THREADS * THREAD_TEST_ITERS);
+    assert(atomic_load_u32(&st.consumed, ATOMIC_RELAXED) == 2 * THREAD_TEST_THREADS);
+    assert(!semaphore_try_wait(&st.items));
+    println(str_lit("Thread tests passed"));
+}
+
+#define JOB_TEST_JOBS 1000
+#define JOB_TEST_FOR_COUNT 100000
+
+typedef struct {
+    atomic_u64 sum;
+    atomic_u32 ran;
+    atomic_u32 scratch_ok;
+} JobTestState;
+
+static void job_test_leaf(void *arg) {
+    JobTestState *st = arg;
+    atomic_fetch_add_u32(&st->ran, 1);
+}
+
+// Uses scratch memory inside a job and spawns nested jobs
+static void job_test_parent(void *arg) {
+    JobTestState *st = arg;
+    Scratch scratch = scratch_begin();
+    uint32_t *values = arena_alloc_array(scratch.arena, uint32_t, 256);
+    for (uint32_t i = 0; i < 256; i++) values[i] = i;
+
+    JobCounter counter = {0};
+    for (int i = 0; i < 10; i++) {
+        job_spawn(&counter, job_test_leaf, st);
+    }
+    job_wait(&counter);
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < 256; i++) total += values[i];
+    if (total == 255 * 256 / 2) atomic_fetch_add_u32(&st->scratch_ok, 1);
+    scratch_end(scratch);
+}
+
+static void job_test_range(void *arg, uint64_t begin, uint64_t end) {
+    JobTestState *st = arg;
+    assert(jobs_thread_index() < jobs_thread_count());
+    uint64_t sum = 0;
+    for (uint64_t i = begin; i < end; i++) sum += i;
+    atomic_fetch_add_u64(&st->sum, sum);
+}
+
+static void test_jobs_run(void) {
+    JobTestState st = {0};
+    JobCounter counter = {0};
+    for (int i = 0; i < JOB_TEST_JOBS; i++) {
+        job_spawn(&counter, job_test_leaf, &st);
+    }
+    job_wait(&counter);
+    assert(atomic_load_u32(&counter.pending, ATOMIC_RELAXED) == 0);
+    assert(atomic_load_u32(&st.ran, ATOMIC_RELAXED) == JOB_TEST_JOBS);
+
+    atomic_store_u32(&st.ran, 0, ATOMIC_RELAXED);
+    for (int i = 0; i < 20; i++) {
+        job_spawn(&counter, job_test_parent, &st);
+    }
+    job_wait(&counter);
+    assert(atomic_load_u32(&st.ran, ATOMIC_RELAXED) == 200);
+    assert(atomic_load_u32(&st.scratch_ok, ATOMIC_RELAXED) == 20);
+
+    job_parallel_for(JOB_TEST_FOR_COUNT, 0, job_test_range, &st);
+    assert(atomic_load_u64(&st.sum, ATOMIC_RELAXED) == (uint64_t)JOB_TEST_FOR_COUNT * (JOB_TEST_FOR_COUNT - 1) / 2);
+    atomic_store_u64(&st.sum, 0, ATOMIC_RELAXED);
+    job_parallel_for(1000, 7, job_test_range, &st);
+    assert(atomic_load_u64(&st.sum, ATOMIC_RELAXED) == 999 * 1000 / 2);
+}
+
+void test_jobs(void) {
+    println(str_lit("## Testing jobs..."));
+
+    // Without workers jobs run inline
+    assert(jobs_thread_count() == 1);
+    test_jobs_run();
+
+    uint32_t workers = jobs_init(3);
+    if (workers == 0) {
+        println(str_lit("Threads not available, jobs ran inline"));
+    } else {
+        assert(jobs_thread_count() == workers + 1);
+        assert(jobs_thread_index() == 0);
+        for (int i = 0; i < 10; i++) test_jobs_run();
+        jobs_shutdown();
+        assert(jobs_thread_count() == 1);
+    }
+    println(str_lit("Job tests passed"));
+}
+
+void test_time(void) {
+    println(str_lit("## Testing time..."));
+
+    // Spin for 1 ms: the clock moves forward and never back
+    uint64_t start_ns = platform_now_ns();
+    uint64_t start_cycles = platform_cycles();
+    uint64_t prev_ns = start_ns;
+    uint64_t now_ns;
+    do {
+        now_ns = platform_now_ns();
+        assert(now_ns >= prev_ns);
+        prev_ns = now_ns;
+    } while (now_ns - start_ns < 1000000);
+    uint64_t cycles = platform_cycles() - start_cycles;
+    assert(cycles > 0);
+
+    uint64_t frequency = platform_cycle_frequency();
+    assert(frequency > 0);
+    assert(platform_cycle_frequency() == frequency);
+
+    // The cycles counted during the spin roughly agree with the frequency
+    uint64_t measured = cycles * 1000000000ull / (now_ns - start_ns);
+    assert(measured > frequency / 2 && measured < frequency * 2);
+
+    println(str_lit("Time tests passed"));
+}
+
+static bool text_contains(string text, string needle) {
+    for (uint64_t i = 0; i + needle.size <= text.size; i++) {
+        if (str_eq(str_substr(text, i, needle.size), needle)) return true;
+    }
+    return false;
+}
+
+static uint32_t text_count(string text, string needle) {
+    uint32_t count = 0;
+    for (uint64_t i = 0; i + needle.size <= text.size; i++) {
+        if (str_eq(str_substr(text, i, needle.size), needle)) count++;
+    }
+    return count;
+}
+
+// Records a zone as job worker 7 does, on a thread of its own where threads
+// are available
+static int profile_worker_thread(void *arg) {
+    (void)arg;
+    ThreadContext ctx = {.worker_index = 7};
+    thread_context_begin(&ctx);
+    profile_begin("profile_test_worker");
+    profile_end();
+    profile_thread_end();
+    thread_context_end(&ctx);
+    return 0;
+}
+
+static void profile_range_job(void *arg, uint64_t begin, uint64_t end) {
+    (void)arg;
+    (void)begin;
+    (void)end;
+    profile_begin("profile_test_job");
+    profile_end();
+}
+
+void test_profile(void) {
+    println(str_lit("## Testing profile..."));
+    Arena *arena = arena_new(1024 * 1024);
+
+    profile_reset();
+    profile_begin("profile_test_outer");
+    for (int i = 0; i < 3; i++) {
+        profile_begin("profile_test_inner");
+        profile_end();
+    }
+    profile_end();
+    // Unbalanced ends are ignored
+    profile_end();
+
+    // Zones recorded on whichever threads run the jobs
+    jobs_init(2);
+    job_parallel_for(64, 1, profile_range_job, NULL);
+    jobs_shutdown();
+
+    assert(profile_write_chrome_trace(str_lit("test_profile.json")));
+    string text;
+    assert(read_file(arena, str_lit("test_profile.json"), &text));
+    assert(str_eq(str_substr(text, 0, 1), str_lit("{")));
+    assert(text_contains(text, str_lit("\"traceEvents\":[")));
+    assert(text_contains(text, str_lit("\"name\":\"main\"")));
+    assert(text_contains(text, str_lit("\"name\":\"profile_test_outer\",\"ph\":\"X\"")));
+    assert(text_contains(text, str_lit("\"name\":\"profile_test_inner\",\"ph\":\"X\"")));
+    assert(text_contains(text, str_lit("\"name\":\"profile_test_job\",\"ph\":\"X\"")));
+    // text.size counts the null terminator
+    assert(str_eq(str_substr(text, text.size - 4, 3), str_lit("]}\n")));
+
+    // After a reset the zones are gone
+    profile_reset();
+    assert(profile_write_chrome_trace(str_lit("test_profile.json")));
+    assert(read_file(arena, str_lit("test_profile.json"), &text));
+    assert(!text_contains(text, str_lit("profile_test_outer")));
+
+    // A restarted worker records into the ring of the previous one
+    for (int i = 0; i < 2; i++) {
+        platform_thread_t thread;
+        if (platform_thread_create(&thread, profile_worker_thread, NULL)) {
+            platform_thread_join(thread);
+        } else {
+            profile_worker_thread(NULL);
+        }
+    }
+    assert(profile_write_chrome_trace(str_lit("test_profile.json")));
+    assert(read_file(arena, str_lit("test_profile.json"), &text));
+    assert(text_count(text, str_lit("\"name\":\"profile_test_worker\"")) == 2);
+    assert(text_count(text, str_lit("\"name\":\"worker 7\"")) == 1);
+
+    arena_free(arena);
+    println(str_lit("Profile tests passed"));
+}
+
 void test_file_flags(void) {
     println(str_lit("## Testing file open flags..."));
 
@@ -809,6 +1275,400 @@ void test_vector_int_ptr(void) {
     println(str_lit("Vector (int*) tests passed"));
 }
 
+static int compare_int(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Element size that is not a multiple of 8
+typedef struct {
+    uint8_t key;
+    uint8_t tag[2];
+} Byte3;
+
+static int compare_byte3(const void *a, const void *b) {
+    return (int)((const Byte3 *)a)->key - (int)((const Byte3 *)b)->key;
+}
+
+#define INT_LESS(a, b) (*(a) < *(b))
+DEFINE_SORT_FOR_TYPE(int, INT_LESS, IntSort)
+
+static bool is_sorted_int(const int *v, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        if (v[i - 1] > v[i]) return false;
+    }
+    return true;
+}
+
+static int64_t sum_int(const int *v, size_t count) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < count; i++) sum += v[i];
+    return sum;
+}
+
+// Fills v with one of several patterns, some of them quicksort worst cases
+static void fill_sort_pattern(int *v, size_t count, int pattern, uint32_t *rng) {
+    for (size_t i = 0; i < count; i++) {
+        *rng = *rng * 1664525u + 1013904223u;
+        switch (pattern) {
+        case 0: v[i] = (int)(*rng >> 8); break;                 // Random
+        case 1: v[i] = 0; break;                                // All equal
+        case 2: v[i] = (int)(*rng >> 31); break;                // Two values
+        case 3: v[i] = (int)i; break;                           // Sorted
+        case 4: v[i] = (int)(count - i); break;                 // Reversed
+        default: v[i] = (int)(i % 2 ? i : count - i); break;    // Organ pipe
+        }
+    }
+}
+
+void test_sort(void) {
+    println(str_lit("## Testing sort..."));
+    Arena *arena = arena_new(1024 * 1024);
+    size_t sizes[] = {0, 1, 2, 3, 16, 17, 100, 1000, 20000};
+    uint32_t rng = 1;
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t count = sizes[s];
+        int *v = arena_alloc_array(arena, int, count + 1);
+        for (int pattern = 0; pattern < 6; pattern++) {
+            fill_sort_pattern(v, count, pattern, &rng);
+            int64_t sum = sum_int(v, count);
+            sort(v, count, sizeof(int), compare_int);
+            assert(is_sorted_int(v, count));
+            assert(sum_int(v, count) == sum);
+
+            // nth_element: v[nth] is in place, with nothing greater before it
+            // and nothing less after it
+            size_t nth = count / 3;
+            fill_sort_pattern(v, count, pattern, &rng);
+            sum = sum_int(v, count);
+            sort_select(v, count, sizeof(int), nth, compare_int);
+            for (size_t i = 0; i < count; i++) {
+                assert(i <= nth || v[i] >= v[nth]);
+                assert(i >= nth || v[i] <= v[nth]);
+            }
+            assert(sum_int(v, count) == sum);
+
+            // Top k: the first k are sorted and no greater than the rest
+            size_t k = count / 10 + 1;
+            fill_sort_pattern(v, count, pattern, &rng);
+            sort_partial(v, count, sizeof(int), k, compare_int);
+            size_t sorted = k < count ? k : count;
+            assert(is_sorted_int(v, sorted));
+            for (size_t i = sorted; i < count; i++) {
+                assert(v[i] >= v[sorted - 1]);
+            }
+
+            // The same with the type-specialized versions
+            fill_sort_pattern(v, count, pattern, &rng);
+            sum = sum_int(v, count);
+            IntSort_sort(v, count);
+            assert(is_sorted_int(v, count));
+            assert(sum_int(v, count) == sum);
+
+            fill_sort_pattern(v, count, pattern, &rng);
+            IntSort_select(v, count, nth);
+            for (size_t i = 0; i < count; i++) {
+                assert(i <= nth || v[i] >= v[nth]);
+                assert(i >= nth || v[i] <= v[nth]);
+            }
+
+            fill_sort_pattern(v, count, pattern, &rng);
+            IntSort_partial(v, count, k);
+            assert(is_sorted_int(v, sorted));
+            for (size_t i = sorted; i < count; i++) {
+                assert(v[i] >= v[sorted - 1]);
+            }
+        }
+    }
+
+    Byte3 bytes[100];
+    for (int i = 0; i < 100; i++) {
+        bytes[i] = (Byte3){.key = (uint8_t)(i * 37 % 101), .tag = {(uint8_t)i, (uint8_t)~i}};
+    }
+    sort(bytes, 100, sizeof(Byte3), compare_byte3);
+    for (int i = 0; i < 100; i++) {
+        assert(i == 0 || bytes[i - 1].key < bytes[i].key);
+        uint8_t inverted = (uint8_t)~bytes[i].tag[0];
+        assert(inverted == bytes[i].tag[1]);
+    }
+
+    arena_free(arena);
+    println(str_lit("Sort tests passed"));
+}
+
+// Fills `data` with words from a small vocabulary (compressible) or, if
+// `random`, with random bytes
+static void fill_lz_input(uint8_t *data, size_t size, bool random, uint32_t *rng) {
+    static const char *words[] = {"vertex ", "fragment ", "uniform ", "float4 ", "return ", "struct ", "{\n", "}\n"};
+    size_t i = 0;
+    while (i < size) {
+        *rng = *rng * 1664525u + 1013904223u;
+        if (random) {
+            data[i++] = (uint8_t)(*rng >> 24);
+            continue;
+        }
+        const char *word = words[*rng >> 29];
+        for (size_t j = 0; word[j] && i < size; j++) data[i++] = (uint8_t)word[j];
+    }
+}
+
+typedef struct {
+    const uint8_t *frame;
+    uint8_t *out;
+    atomic_u32 failures;
+} LzFrameJob;
+
+static void lz_frame_job(void *arg, uint64_t begin, uint64_t end) {
+    LzFrameJob *job = arg;
+    if (!lz_frame_decompress_blocks(job->frame, job->out, (uint32_t)begin, (uint32_t)end)) {
+        atomic_fetch_add_u32(&job->failures, 1);
+    }
+}
+
+void test_lz(void) {
+    println(str_lit("## Testing lz..."));
+    Arena *arena = arena_new(4 * 1024 * 1024);
+    size_t sizes[] = {0, 1, 12, 13, 100, 4096, 70000, 300000};
+    uint32_t rng = 7;
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t size = sizes[s];
+        for (int random = 0; random < 2; random++) {
+            uint8_t *data = arena_alloc_array(arena, uint8_t, size + 1);
+            uint8_t *packed = arena_alloc_array(arena, uint8_t, lz_compress_bound(size));
+            uint8_t *out = arena_alloc_array(arena, uint8_t, size + 1);
+            fill_lz_input(data, size, random, &rng);
+
+            size_t packed_size = lz_compress(data, size, packed, lz_compress_bound(size));
+            assert(packed_size != LZ_ERROR);
+            assert(lz_decompress(packed, packed_size, out, size) == size);
+            assert(base_memcmp(out, data, size) == 0);
+            if (size >= 4096) {
+                assert(random ? packed_size > size : packed_size < size / 2);
+            }
+
+            // Too small an output, truncated input
+            if (size > 0) {
+                assert(lz_decompress(packed, packed_size, out, size - 1) == LZ_ERROR);
+                assert(lz_decompress(packed, packed_size - 1, out, size) != size);
+            }
+            if (random && size > 0) {
+                assert(lz_compress(data, size, packed, size) == LZ_ERROR);
+            }
+
+            // Garbage must be rejected or decoded within bounds
+            for (int i = 0; i < 20 && packed_size > 0; i++) {
+                rng = rng * 1664525u + 1013904223u;
+                packed[(rng >> 8) % packed_size] ^= (uint8_t)(1 + (rng >> 29));
+                size_t n = lz_decompress(packed, packed_size, out, size);
+                assert(n == LZ_ERROR || n <= size);
+            }
+        }
+    }
+
+    // A run compresses into a few overlapping matches
+    uint8_t run[1000];
+    uint8_t run_packed[64];
+    base_memset(run, 'a', sizeof(run));
+    size_t run_size = lz_compress(run, sizeof(run), run_packed, sizeof(run_packed));
+    assert(run_size < 20);
+    assert(lz_decompress(run_packed, run_size, run, sizeof(run)) == sizeof(run));
+    for (size_t i = 0; i < sizeof(run); i++) assert(run[i] == 'a');
+
+    // A block from reference lz4 (lz4.block.compress(store_size=False) of
+    // python-lz4 4.4.5): long literal and match lengths, overlapping matches
+    // at offsets 3 and 1, and a match 370 bytes back
+    static const uint8_t reference_block[] = {
+        0xff, 0x1c, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x61, 0x62, 0x63, 0x64,
+        0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73, 0x74,
+        0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x41, 0x42, 0x43, 0x44, 0x61, 0x62, 0x63, 0x03, 0x00, 0x08,
+        0x1f, 0x7a, 0x01, 0x00, 0xff, 0x19, 0x0f, 0x72, 0x01, 0x14, 0x50, 0x44, 0x65, 0x6e, 0x64, 0x2e,
+    };
+    static const char alnum[] = "0123456789abcdefghijklmnopqrstuvwxyzABCD";
+    uint8_t expected[414];
+    size_t expected_size = 0;
+    base_memcpy(expected, alnum, 40);
+    expected_size += 40;
+    for (int i = 0; i < 30; i++) expected[expected_size++] = (uint8_t)"abc"[i % 3];
+    base_memset(expected + expected_size, 'z', 300);
+    expected_size += 300;
+    base_memcpy(expected + expected_size, alnum, 40);
+    expected_size += 40;
+    base_memcpy(expected + expected_size, "end.", 4);
+    expected_size += 4;
+    assert(expected_size == sizeof(expected));
+    uint8_t decoded[sizeof(expected)];
+    assert(lz_decompress(reference_block, sizeof(reference_block), decoded, sizeof(decoded)) == sizeof(expected));
+    assert(base_memcmp(decoded, expected, sizeof(expected)) == 0);
+
+    // Frames: text blocks compress, random blocks are stored as is
+    size_t size = 300000;
+    uint32_t block_size = 4096;
+    uint8_t *data = arena_alloc_array(arena, uint8_t, size);
+    fill_lz_input(data, size / 2, false, &rng);
+    fill_lz_input(data + size / 2, size - size / 2, true, &rng);
+    size_t bound = lz_frame_bound(size, block_size);
+    uint8_t *frame = arena_alloc_array(arena, uint8_t, bound);
+    size_t frame_size = lz_frame_compress(data, size, block_size, frame, bound);
+    assert(frame_size != LZ_ERROR && frame_size < bound);
+    assert(lz_frame_size(frame, frame_size) == size);
+    assert(lz_frame_block_count(frame) == (size + block_size - 1) / block_size);
+    assert(lz_frame_compress(data, size, block_size, frame, bound - 1) == LZ_ERROR);
+
+    uint8_t *out = arena_alloc_array(arena, uint8_t, size);
+    assert(lz_frame_decompress(frame, frame_size, out, size) == size);
+    assert(base_memcmp(out, data, size) == 0);
+    assert(lz_frame_decompress(frame, frame_size, out, size - 1) == LZ_ERROR);
+    assert(lz_frame_size(frame, frame_size - 1) == LZ_ERROR);
+
+    // Blocks decode independently, here in parallel
+    base_memset(out, 0, size);
+    LzFrameJob job = {.frame = frame, .out = out};
+    job_parallel_for(lz_frame_block_count(frame), 1, lz_frame_job, &job);
+    assert(atomic_load_u32(&job.failures, ATOMIC_RELAXED) == 0);
+    assert(base_memcmp(out, data, size) == 0);
+
+    // An empty frame is just the header
+    assert(lz_frame_compress(data, 0, block_size, frame, bound) == LZ_FRAME_HEADER_SIZE);
+    assert(lz_frame_size(frame, LZ_FRAME_HEADER_SIZE) == 0);
+
+    arena_free(arena);
+    println(str_lit("LZ tests passed"));
+}
+
+void test_hash(void) {
+    println(str_lit("## Testing hash..."));
+
+    // Reference XXH64 values
+    uint8_t data[100];
+    for (int i = 0; i < 100; i++) data[i] = (uint8_t)(i * 7 + 1);
+    assert(hash64("", 0, 0) == 0xEF46DB3751D8E999ull);
+    assert(hash64("abc", 3, 0) == 0x44BC2CF5AD770999ull);
+    assert(hash64(data, 100, 0) == 0xD248BFC5208B0B16ull);
+    assert(hash64(data, 100, 42) == 0x1A14D1B72F915932ull);
+    assert(hash64(data, 37, 0) == 0x9F0A1BB6FDA206F1ull);
+
+    // Alignment does not matter, every byte does
+    uint8_t shifted[101];
+    base_memcpy(shifted + 1, data, 100);
+    assert(hash64(shifted + 1, 100, 0) == hash64(data, 100, 0));
+    for (int i = 0; i < 100; i++) {
+        shifted[1 + i] ^= 1;
+        assert(hash64(shifted + 1, 100, 0) != hash64(data, 100, 0));
+        shifted[1 + i] ^= 1;
+    }
+
+    println(str_lit("Hash tests passed"));
+}
+
+static void write_test_bundle(const char *path, const uint8_t *data, size_t size) {
+    wasi_fd_t fd = wasi_path_open(path, base_strlen(path), WASI_RIGHTS_WRITE, WASI_O_CREAT | WASI_O_TRUNC);
+    assert(fd >= 0);
+    ciovec_t iov = {.buf = data, .buf_len = size};
+    assert(write_all(fd, &iov, 1) == 0);
+    wasi_fd_close(fd);
+}
+
+void test_bundle(void) {
+    println(str_lit("## Testing bundle..."));
+    Arena *arena = arena_new(1024 * 1024);
+    const char *test_file = "test_bundle.bin";
+
+    // Two files, "a.txt" as is and "dir/b.bin" as an LZ frame of several
+    // blocks, laid out like bundler.c does
+    const char *text = "hello bundle";
+    size_t b_size = 100000;
+    uint8_t *b = arena_alloc_array(arena, uint8_t, b_size);
+    uint32_t rng = 3;
+    fill_lz_input(b, b_size, false, &rng);
+    size_t frame_bound = lz_frame_bound(b_size, 4096);
+
+    size_t index_offset = sizeof(BundleHeader);
+    size_t entries_offset = index_offset + 4 * sizeof(uint32_t);
+    size_t strings_offset = entries_offset + 2 * sizeof(BundleEntry);
+    size_t contents_offset = strings_offset + 16;
+    uint8_t *data = arena_alloc_array(arena, uint8_t, contents_offset + 12 + frame_bound);
+    base_memset(data, 0, contents_offset);
+    BundleHeader *header = (BundleHeader *)data;
+    base_memcpy(header->magic, BUNDLE_MAGIC, 4);
+    header->version = BUNDLE_VERSION;
+    header->file_count = 2;
+    header->slot_count = 4;
+    header->index_offset = (uint32_t)index_offset;
+    header->entries_offset = (uint32_t)entries_offset;
+    header->strings_offset = (uint32_t)strings_offset;
+    header->strings_size = 16;
+    base_memcpy(data + strings_offset, "a.txt\0dir/b.bin\0", 16);
+    base_memcpy(data + contents_offset, text, 12);
+    size_t frame_size = lz_frame_compress(b, b_size, 4096, data + contents_offset + 12, frame_bound);
+    assert(frame_size < b_size / 2);
+    header->total_size = contents_offset + 12 + frame_size;
+
+    BundleEntry *entries = (BundleEntry *)(data + entries_offset);
+    entries[0] = (BundleEntry){.path_offset = (uint32_t)strings_offset, .path_size = 5,
+                               .offset = contents_offset, .size = 12};
+    entries[1] = (BundleEntry){.path_offset = (uint32_t)strings_offset + 6, .path_size = 9,
+                               .codec = BUNDLE_CODEC_LZ, .offset = contents_offset + 12, .size = frame_size};
+    uint32_t *slots = (uint32_t *)(data + index_offset);
+    for (uint32_t i = 0; i < 2; i++) {
+        entries[i].path_hash = bundle_path_hash((const char *)data + entries[i].path_offset, entries[i].path_size);
+        uint32_t slot = entries[i].path_hash & 3;
+        while (slots[slot] != 0) slot = (slot + 1) & 3;
+        slots[slot] = i + 1;
+    }
+    write_test_bundle(test_file, data, header->total_size);
+
+    Bundle bundle;
+    assert(bundle_open(arena, str_lit("test_bundle.bin"), &bundle));
+    assert(bundle.size == header->total_size);
+
+    // Stored files are views into the bundle
+    string content;
+    assert(bundle_view(&bundle, str_lit("a.txt"), &content));
+    assert(str_eq(content, str_lit("hello bundle")));
+    assert((const uint8_t *)content.str == bundle.data + contents_offset);
+    assert(bundle_read(&bundle, arena, str_lit("a.txt"), &content));
+    assert((const uint8_t *)content.str == bundle.data + contents_offset);
+
+    // Compressed files are decoded
+    assert(!bundle_view(&bundle, str_lit("dir/b.bin"), &content));
+    assert(bundle_read(&bundle, arena, str_lit("dir/b.bin"), &content));
+    assert(content.size == b_size);
+    assert(base_memcmp(content.str, b, b_size) == 0);
+    assert(content.str[b_size] == 0);
+
+    assert(!bundle_read(&bundle, arena, str_lit("missing.txt"), &content));
+    assert(!bundle_view(&bundle, str_lit("a.tx"), &content));
+    bundle_close(&bundle);
+    assert(!bundle_view(&bundle, str_lit("a.txt"), &content));
+
+    // Malformed bundles are rejected when opened
+    header->total_size++;
+    write_test_bundle(test_file, data, header->total_size - 1);
+    assert(!bundle_open(arena, str_lit("test_bundle.bin"), &bundle));
+    header->total_size--;
+    entries[1].size = header->total_size;
+    write_test_bundle(test_file, data, header->total_size);
+    assert(!bundle_open(arena, str_lit("test_bundle.bin"), &bundle));
+    entries[1].size = frame_size;
+    header->align_shift = 3;  // "dir/b.bin" is 4 bytes past a multiple of 8
+    write_test_bundle(test_file, data, header->total_size);
+    assert(!bundle_open(arena, str_lit("test_bundle.bin"), &bundle));
+    header->align_shift = 2;
+    write_test_bundle(test_file, data, header->total_size);
+    assert(bundle_open(arena, str_lit("test_bundle.bin"), &bundle));
+    bundle_close(&bundle);
+    slots[0] = slots[1] = slots[2] = slots[3] = 1;
+    write_test_bundle(test_file, data, header->total_size);
+    assert(!bundle_open(arena, str_lit("test_bundle.bin"), &bundle));
+    assert(!bundle_open(arena, str_lit("missing.bundle"), &bundle));
+
+    arena_free(arena);
+    println(str_lit("Bundle tests passed"));
+}
+
 void test_string(void) {
     print("## Testing base string functions...\n");
     Arena *arena = arena_new(4096);
@@ -1079,11 +1939,22 @@ void test_base(void) {
     test_scratch();
     test_format();
     test_io();
+    test_file_mmap();
+    test_aio();
+    test_file_positional();
+    test_threads();
+    test_jobs();
+    test_time();
+    test_profile();
     test_file_flags();
     test_hashtable_int_string();
     test_hashtable_string_int();
     test_vector_int();
     test_vector_int_ptr();
+    test_sort();
+    test_lz();
+    test_hash();
+    test_bundle();
     test_string();
     test_std_fds();
     test_args();
@@ -7,11 +7,22 @@ void test_arena(void);
 void test_scratch(void);
 void test_format(void);
 void test_io(void);
+void test_file_mmap(void);
+void test_aio(void);
+void test_file_positional(void);
+void test_threads(void);
+void test_jobs(void);
+void test_time(void);
+void test_profile(void);
 void test_file_flags(void);
 void test_hashtable_int_string(void);
 void test_hashtable_string_int(void);
 void test_vector_int(void);
 void test_vector_int_ptr(void);
+void test_sort(void);
+void test_lz(void);
+void test_hash(void);
+void test_bundle(void);
 void test_string(void);
 void test_std_fds(void);
 void test_stdin(void);
@@ -0,0 +1,490 @@
+/*
+ * Scene loading tests
+ *
+ * Builds a small scene with scene_builder, serializes it and checks how
+ * engine.c loads it back: from memory and from a file, with packed vertices,
+ * as an older version, and after its header, mesh table or sections were
+ * damaged.
+ *
+ * Usage:
+ *   ./test_scene
+ */
+
+#define PLATFORM_SKIP_ENTRY
+#include <platform/platform.h>
+#include <base/arena.h>
+#include <base/assert.h>
+#include <base/base_math.h>
+#include <base/hash.h>
+#include <base/io.h>
+#include <base/jobs.h>
+#include <base/mem.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "scene_builder.h"
+#include "scene_format.h"
+#include "engine.h"
+
+#define TEST_MAP_WIDTH 6
+#define TEST_MAP_HEIGHT 5
+#define TEST_SCENE_FILE "test_scene.scn"
+
+// Walls around a room with a window and a ceiling light
+static int g_test_map[TEST_MAP_HEIGHT * TEST_MAP_WIDTH] = {
+    1, 1, 1, 1, 1, 1,
+    1, 0, 0, 0, 0, 1,
+    1, 0, 9, 0, 0, 2,
+    1, 0, 0, 0, 0, 1,
+    1, 1, 1, 1, 1, 1,
+};
+
+static uint8_t *g_blob;
+static uint64_t g_blob_size;
+
+// Serializes the test scene with vertices in `vertex_format`. The models
+// are left out so that only the map is built.
+static uint8_t *build_test_scene(uint32_t vertex_format, uint64_t *out_size) {
+    Arena *arena = arena_new(8 * 1024 * 1024);
+    assert(arena != NULL);
+    SceneBuilder *builder = scene_builder_create(arena);
+    assert(builder != NULL);
+
+    SceneConfig config = {0};
+    config.map_data = g_test_map;
+    config.map_width = TEST_MAP_WIDTH;
+    config.map_height = TEST_MAP_HEIGHT;
+    config.spawn_x = 1.5f;
+    config.spawn_z = 1.5f;
+    config.floor_texture_path = "assets/floor.jpg";
+    config.wall_texture_path = "assets/wall.jpg";
+    config.ceiling_texture_path = "assets/ceiling.jpg";
+    config.vertex_format = vertex_format;
+    config.source_key = 0x5EED;
+    assert(scene_builder_generate(builder, &config));
+
+    uint8_t *serialized = NULL;
+    uint64_t size = scene_builder_serialize(builder, &serialized);
+    assert(size >= sizeof(SceneHeader) && serialized != NULL);
+    uint8_t *blob = (uint8_t *)malloc(size);
+    assert(blob != NULL);
+    base_memcpy(blob, serialized, size);
+    scene_builder_free(builder);
+    arena_free(arena);
+    *out_size = size;
+    return blob;
+}
+
+// A copy of the test scene for scene_load_from_memory, which takes ownership
+static uint8_t *copy_test_scene(void) {
+    uint8_t *copy = (uint8_t *)malloc(g_blob_size);
+    assert(copy != NULL);
+    base_memcpy(copy, g_blob, g_blob_size);
+    return copy;
+}
+
+static SceneHeader *header_of(uint8_t *blob) {
+    return (SceneHeader *)blob;
+}
+
+// Recomputes the checksums of the sections and header after a test changed
+// them, so that loading gets past the checksums to the checks behind them
+static void reseal_scene(uint8_t *blob) {
+    SceneHeader *header = header_of(blob);
+    uint64_t offsets[SCENE_SECTION_COUNT] = {header->vertices, header->indices, header->lights,
+                                             header->textures, header->meshes, header->strings};
+    uint64_t sizes[SCENE_SECTION_COUNT] = {header->vertex_size, header->index_size, header->light_size,
+                                           header->texture_size, header->mesh_size, header->string_size};
+    for (int i = 0; i < SCENE_SECTION_COUNT; i++) {
+        if (offsets[i] <= g_blob_size && sizes[i] <= g_blob_size - offsets[i]) {
+            header->checksums[i] = hash64(blob + offsets[i], (size_t)sizes[i], 0);
+        }
+    }
+    header->header_checksum = hash64(header, offsetof(SceneHeader, header_checksum), 0);
+}
+
+static SceneMesh *mesh_table_of(uint8_t *blob) {
+    return (SceneMesh *)(blob + header_of(blob)->meshes);
+}
+
+static bool sections_equal(const void *section, const uint8_t *blob, uint64_t offset, uint64_t size) {
+    return section != NULL && base_memcmp(section, blob + offset, size) == 0;
+}
+
+// Rewrites the test scene as version 1: the same vertices, lights,
+// textures and strings, with the indices of all meshes as one list of
+// 16-bit indices into all the vertices
+static uint8_t *make_v1_scene(uint64_t *out_size) {
+    const SceneHeader *header = header_of(g_blob);
+    assert(header->vertex_count <= 65536);
+    uint64_t index_size = (uint64_t)header->index_count * sizeof(uint16_t);
+    uint64_t sizes[5] = {header->vertex_size, index_size, header->light_size, header->texture_size,
+                         header->string_size};
+    const void *sources[5] = {g_blob + header->vertices, NULL, g_blob + header->lights,
+                              g_blob + header->textures, g_blob + header->strings};
+    uint64_t offsets[5];
+    uint64_t size = sizeof(SceneHeaderV1);
+    for (int i = 0; i < 5; i++) {
+        offsets[i] = size;
+        size += (sizes[i] + 7) & ~(uint64_t)7;
+    }
+
+    uint8_t *blob = (uint8_t *)calloc(1, size);
+    assert(blob != NULL);
+    SceneHeaderV1 *v1 = (SceneHeaderV1 *)blob;
+    v1->magic = SCENE_MAGIC;
+    v1->version = 1;
+    v1->total_size = size;
+    v1->vertices = offsets[0];
+    v1->vertex_size = header->vertex_size;
+    v1->vertex_count = header->vertex_count;
+    v1->indices = offsets[1];
+    v1->index_size = index_size;
+    v1->index_count = header->index_count;
+    v1->lights = offsets[2];
+    v1->light_size = header->light_size;
+    v1->light_count = header->light_count;
+    v1->textures = offsets[3];
+    v1->texture_size = header->texture_size;
+    v1->texture_count = header->texture_count;
+    v1->strings = offsets[4];
+    v1->string_size = header->string_size;
+    for (int i = 0; i < 5; i++) {
+        if (sources[i]) {
+            base_memcpy(blob + offsets[i], sources[i], sizes[i]);
+        }
+    }
+
+    const void *indices = g_blob + header->indices;
+    const SceneMesh *meshes = mesh_table_of(g_blob);
+    uint16_t *v1_indices = (uint16_t *)(blob + offsets[1]);
+    for (uint32_t i = 0; i < header->mesh_count; i++) {
+        for (uint32_t j = 0; j < meshes[i].index_count; j++) {
+            *v1_indices++ = (uint16_t)scene_mesh_index(indices, &meshes[i], j);
+        }
+    }
+    *out_size = size;
+    return blob;
+}
+
+void test_scene_round_trip(void) {
+    println(str_lit("## Testing scene round trip..."));
+
+    const SceneHeader *built = header_of(g_blob);
+    assert(built->magic == SCENE_MAGIC);
+    assert(built->version == SCENE_VERSION);
+    assert(built->total_size == g_blob_size);
+    assert(built->source_key == 0x5EED);
+    assert(built->vertex_count > 0 && built->index_count > 0 && built->mesh_count > 0);
+    assert(built->light_count == 1);
+    assert(built->texture_count == 3);
+
+    Scene *scene = scene_load_from_memory(copy_test_scene(), g_blob_size, false, 0);
+    assert(scene != NULL);
+    const SceneHeader *header = scene_get_header(scene);
+    assert(header->vertex_count == built->vertex_count);
+    assert(header->index_count == built->index_count);
+    assert(header->mesh_count == built->mesh_count);
+    assert(sections_equal(scene_vertices(scene), g_blob, built->vertices, built->vertex_size));
+    assert(sections_equal(scene_indices(scene), g_blob, built->indices, built->index_size));
+    assert(sections_equal(scene_lights(scene), g_blob, built->lights, built->light_size));
+    assert(sections_equal(scene_meshes(scene), g_blob, built->meshes, built->mesh_size));
+    assert(scene_textures(scene) != NULL);
+    assert(base_strcmp(scene_texture_path(scene, 0), "assets/floor.jpg") == 0);
+    assert(scene_verify(scene));
+
+    // Every index of every mesh names a vertex of the scene
+    const SceneMesh *meshes = scene_meshes(scene);
+    uint64_t index_count = 0;
+    for (uint32_t i = 0; i < header->mesh_count; i++) {
+        for (uint32_t j = 0; j < meshes[i].index_count; j++) {
+            assert(scene_mesh_index(scene_indices(scene), &meshes[i], j) < header->vertex_count);
+        }
+        index_count += meshes[i].index_count;
+    }
+    assert(index_count == header->index_count);
+    scene_free(scene);
+
+    // A version 2 scene has the same layout without checksums
+    uint8_t *v2 = copy_test_scene();
+    header_of(v2)->version = 2;
+    header_of(v2)->header_checksum ^= 1;
+    scene = scene_load_from_memory(v2, g_blob_size, false, 0);
+    assert(scene != NULL);
+    assert(scene_get_header(scene)->version == 2);
+    assert(scene_get_header(scene)->mesh_count == built->mesh_count);
+    assert(sections_equal(scene_vertices(scene), g_blob, built->vertices, built->vertex_size));
+    assert(scene_verify(scene));
+    scene_free(scene);
+
+    println(str_lit("Scene round trip tests passed"));
+}
+
+void test_scene_file(void) {
+    println(str_lit("## Testing scene files..."));
+
+    wasi_fd_t fd = wasi_path_open(TEST_SCENE_FILE, base_strlen(TEST_SCENE_FILE), WASI_RIGHTS_WRITE,
+                                  WASI_O_CREAT | WASI_O_TRUNC);
+    assert(fd >= 0);
+    ciovec_t iov = {g_blob, (size_t)g_blob_size};
+    size_t written = 0;
+    assert(wasi_fd_write(fd, &iov, 1, &written) == 0 && written == g_blob_size);
+    wasi_fd_close(fd);
+
+    // Mapped read-only, so two loads of the same file read the same pages
+    const SceneHeader *built = header_of(g_blob);
+    Scene *first = scene_load_from_file(TEST_SCENE_FILE);
+    Scene *second = scene_load_from_file(TEST_SCENE_FILE);
+    assert(first != NULL && second != NULL);
+    assert(sections_equal(scene_vertices(first), g_blob, built->vertices, built->vertex_size));
+    assert(sections_equal(scene_meshes(first), g_blob, built->meshes, built->mesh_size));
+    assert(sections_equal(scene_vertices(second), g_blob, built->vertices, built->vertex_size));
+    assert(base_strcmp(scene_texture_path(first, 2), "assets/ceiling.jpg") == 0);
+    scene_free(first);
+    assert(sections_equal(scene_indices(second), g_blob, built->indices, built->index_size));
+    scene_free(second);
+
+    assert(scene_load_from_file("test_scene_missing.scn") == NULL);
+
+    // Texture paths are read in place, so the strings must end with a
+    // terminator, and a path outside of them reads as ""
+    uint8_t *blob = copy_test_scene();
+    blob[built->strings + built->string_size - 1] = 'x';
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+    blob = copy_test_scene();
+    ((SceneTexture *)(blob + built->textures))[1].path_offset = built->string_size;
+    reseal_scene(blob);
+    Scene *scene = scene_load_from_memory(blob, g_blob_size, false, 0);
+    assert(scene != NULL);
+    assert(base_strcmp(scene_texture_path(scene, 1), "") == 0);
+    assert(base_strcmp(scene_texture_path(scene, 0), "assets/floor.jpg") == 0);
+    scene_free(scene);
+
+    println(str_lit("Scene file tests passed"));
+}
+
+void test_scene_version1(void) {
+    println(str_lit("## Testing version 1 scenes..."));
+
+    // Loads as one mesh of 16-bit indices that draws the same triangles
+    uint64_t size = 0;
+    uint8_t *blob = make_v1_scene(&size);
+    Scene *scene = scene_load_from_memory(blob, size, false, 0);
+    assert(scene != NULL);
+    const SceneHeader *header = scene_get_header(scene);
+    const SceneHeader *built = header_of(g_blob);
+    assert(header->version == 1);
+    assert(header->vertex_count == built->vertex_count);
+    assert(header->index_count == built->index_count);
+    assert(header->mesh_count == 1);
+    const SceneMesh *mesh = &scene_meshes(scene)[0];
+    assert(mesh->first_vertex == 0 && mesh->vertex_count == built->vertex_count);
+    assert(mesh->index_count == built->index_count && mesh->index_size == SCENE_INDEX_16);
+    assert(sections_equal(scene_vertices(scene), g_blob, built->vertices, built->vertex_size));
+
+    const void *indices = g_blob + built->indices;
+    const SceneMesh *meshes = mesh_table_of(g_blob);
+    uint32_t v1_index = 0;
+    for (uint32_t i = 0; i < built->mesh_count; i++) {
+        for (uint32_t j = 0; j < meshes[i].index_count; j++) {
+            assert(scene_mesh_index(scene_indices(scene), mesh, v1_index++) == scene_mesh_index(indices, &meshes[i], j));
+        }
+    }
+    scene_free(scene);
+
+    // Its index list must fit in the blob too
+    blob = make_v1_scene(&size);
+    ((SceneHeaderV1 *)blob)->index_count += 1;
+    ((SceneHeaderV1 *)blob)->index_size = size;
+    assert(scene_load_from_memory(blob, size, false, 0) == NULL);
+
+    println(str_lit("Version 1 scene tests passed"));
+}
+
+static bool nearly_equal(float a, float b, float tolerance) {
+    return base_fabsf(a - b) <= tolerance * (1.0f + base_fabsf(b));
+}
+
+void test_scene_packed_vertices(void) {
+    println(str_lit("## Testing packed scene vertices..."));
+
+    // The same scene with 16-byte vertices: the same meshes and indices, and
+    // vertices that decode to the float ones up to quantization
+    uint64_t size = 0;
+    uint8_t *blob = build_test_scene(SCENE_VERTEX_PACKED, &size);
+    const SceneHeader *built = header_of(g_blob);
+    const SceneHeader *packed = header_of(blob);
+    assert(packed->vertex_format == SCENE_VERTEX_PACKED);
+    assert(packed->vertex_count == built->vertex_count);
+    assert(packed->vertex_size == (uint64_t)packed->vertex_count * sizeof(ScenePackedVertex));
+    assert(packed->mesh_count == built->mesh_count);
+    assert(packed->index_size == built->index_size);
+    assert(sections_equal(blob + packed->indices, g_blob, built->indices, built->index_size));
+
+    Scene *float_scene = scene_load_from_memory(copy_test_scene(), g_blob_size, false, 0);
+    Scene *packed_scene = scene_load_from_memory(blob, size, false, 0);
+    assert(float_scene != NULL && packed_scene != NULL);
+    const SceneMesh *meshes = scene_meshes(packed_scene);
+    for (uint32_t i = 0; i < scene_get_header(packed_scene)->mesh_count; i++) {
+        const SceneMesh *mesh = &meshes[i];
+        for (uint32_t v = mesh->first_vertex; v < mesh->first_vertex + mesh->vertex_count; v++) {
+            SceneVertex expected, decoded;
+            scene_unpack_vertex(float_scene, &scene_meshes(float_scene)[i], v, &expected);
+            scene_unpack_vertex(packed_scene, mesh, v, &decoded);
+            for (int axis = 0; axis < 3; axis++) {
+                assert(nearly_equal(decoded.position[axis], expected.position[axis], 1e-4f));
+                assert(nearly_equal(decoded.normal[axis], expected.normal[axis], 1e-3f));
+            }
+            assert(nearly_equal(decoded.uv[0], expected.uv[0], 1e-3f));
+            assert(nearly_equal(decoded.uv[1], expected.uv[1], 1e-3f));
+            assert(decoded.surface_type == expected.surface_type);
+        }
+    }
+    scene_free(float_scene);
+    scene_free(packed_scene);
+
+    // Unknown layouts, and vertex data sized for the other layout, are rejected
+    blob = copy_test_scene();
+    header_of(blob)->vertex_format = 2;
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+    blob = copy_test_scene();
+    header_of(blob)->vertex_format = SCENE_VERTEX_PACKED;
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+
+    println(str_lit("Packed scene vertex tests passed"));
+}
+
+void test_scene_mesh_table(void) {
+    println(str_lit("## Testing scene mesh table checks..."));
+
+    // Cut off before the end of its last section
+    uint8_t *blob = copy_test_scene();
+    header_of(blob)->total_size = g_blob_size - 1;
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size - 1, false, 0) == NULL);
+
+    // A mesh table reaching past the end of the blob
+    blob = copy_test_scene();
+    header_of(blob)->mesh_count += 1;
+    header_of(blob)->mesh_size += sizeof(SceneMesh);
+    header_of(blob)->meshes = g_blob_size - header_of(blob)->mesh_size + sizeof(SceneMesh);
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+
+    // A mesh table whose size does not match its count
+    blob = copy_test_scene();
+    header_of(blob)->mesh_count += 1;
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+
+    // An empty section still needs an offset within the blob
+    blob = copy_test_scene();
+    header_of(blob)->lights = g_blob_size + 1;
+    header_of(blob)->light_size = 0;
+    header_of(blob)->light_count = 0;
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+
+    // Meshes drawing vertices or indices the scene does not have
+    blob = copy_test_scene();
+    SceneMesh *mesh = &mesh_table_of(blob)[0];
+    mesh->first_vertex = header_of(blob)->vertex_count;
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+
+    blob = copy_test_scene();
+    mesh = &mesh_table_of(blob)[0];
+    mesh->index_offset = header_of(blob)->index_size + 4;
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+
+    blob = copy_test_scene();
+    mesh = &mesh_table_of(blob)[header_of(blob)->mesh_count - 1];
+    mesh->index_count += 1;
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+
+    blob = copy_test_scene();
+    mesh = &mesh_table_of(blob)[0];
+    mesh->index_size = 3;
+    reseal_scene(blob);
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+
+    // The same change without resealing fails the header or mesh checksum
+    blob = copy_test_scene();
+    mesh_table_of(blob)[0].first_vertex += 1;
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+    blob = copy_test_scene();
+    header_of(blob)->vertex_count -= 1;
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+
+    println(str_lit("Scene mesh table tests passed"));
+}
+
+void test_scene_checksums(void) {
+    println(str_lit("## Testing scene checksums..."));
+
+    // The sections are verified on first access, so a damaged one is
+    // reported by its accessor while the others stay readable
+    static const int lazy_sections[] = {
+        SCENE_SECTION_VERTICES, SCENE_SECTION_INDICES, SCENE_SECTION_LIGHTS, SCENE_SECTION_TEXTURES,
+    };
+    for (size_t i = 0; i < sizeof(lazy_sections) / sizeof(lazy_sections[0]); i++) {
+        int section = lazy_sections[i];
+        uint8_t *blob = copy_test_scene();
+        const SceneHeader *header = header_of(blob);
+        uint64_t offsets[] = {header->vertices, header->indices, header->lights, header->textures};
+        blob[offsets[section]] ^= 0x40;
+
+        Scene *scene = scene_load_from_memory(blob, g_blob_size, false, 0);
+        assert(scene != NULL);
+        assert((scene_vertices(scene) == NULL) == (section == SCENE_SECTION_VERTICES));
+        assert((scene_indices(scene) == NULL) == (section == SCENE_SECTION_INDICES));
+        assert((scene_lights(scene) == NULL) == (section == SCENE_SECTION_LIGHTS));
+        assert((scene_textures(scene) == NULL) == (section == SCENE_SECTION_TEXTURES));
+        assert(scene_meshes(scene) != NULL);
+        assert(!scene_verify(scene));
+        scene_free(scene);
+    }
+
+    // The mesh table and strings are read while loading, so they are
+    // verified then
+    uint8_t *blob = copy_test_scene();
+    blob[header_of(blob)->meshes + offsetof(SceneMesh, bounds_min)] ^= 0x40;
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+    blob = copy_test_scene();
+    blob[header_of(blob)->strings] ^= 0x40;
+    assert(scene_load_from_memory(blob, g_blob_size, false, 0) == NULL);
+
+    // Version 2 scenes have no checksums to check
+    blob = copy_test_scene();
+    header_of(blob)->version = 2;
+    blob[header_of(blob)->vertices] ^= 0x40;
+    Scene *scene = scene_load_from_memory(blob, g_blob_size, false, 0);
+    assert(scene != NULL);
+    assert(scene_vertices(scene) != NULL);
+    assert(scene_verify(scene));
+    scene_free(scene);
+
+    println(str_lit("Scene checksum tests passed"));
+}
+
+int main(int argc, char *argv[]) {
+    platform_init(argc, argv);
+    jobs_init(0);
+
+    g_blob = build_test_scene(SCENE_VERTEX_FLOAT, &g_blob_size);
+    test_scene_round_trip();
+    test_scene_file();
+    test_scene_packed_vertices();
+    test_scene_version1();
+    test_scene_mesh_table();
+    test_scene_checksums();
+    free(g_blob);
+
+    println(str_lit("=== All tests passed ==="));
+    return 0;
+}
@@ -3,6 +3,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <assert.h>
+#include <stdlib.h>
 #include <test_stdlib.h>
 
 // Helper function to test string equality
@@ -156,6 +157,37 @@ static void test_assert(void) {
     printf("Assert tests passed (all assertions succeeded)\n");
 }
 
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// qsort tests
+static void test_qsort(void) {
+    printf("## Testing qsort...\n");
+
+    int values[] = {5, -3, 9, 0, 5, 2, -8, 7, 1, 5};
+    qsort(values, 10, sizeof(int), compare_ints);
+    for (int i = 1; i < 10; i++) {
+        assert(values[i - 1] <= values[i]);
+    }
+    assert(values[0] == -8 && values[9] == 9);
+
+    qsort(values, 0, sizeof(int), compare_ints);  // Empty array
+
+    int many[1000];
+    for (int i = 0; i < 1000; i++) {
+        many[i] = (i * 7919) % 1000;
+    }
+    qsort(many, 1000, sizeof(int), compare_ints);
+    for (int i = 0; i < 1000; i++) {
+        assert(many[i] == i);
+    }
+
+    printf("qsort tests passed\n");
+}
+
 // Main stdlib test function
 void test_stdlib(void) {
     printf("=== stdlib tests ===\n");
@@ -169,5 +201,8 @@ void test_stdlib(void) {
     test_assert();
     printf("\n");
 
+    test_qsort();
+    printf("\n");
+
     printf("stdlib tests passed\n\n");
 }
@@ -11,6 +11,10 @@
 #include <base/format.h>
 #include <base/base_io.h>
 #include <base/exit.h>
+#include <base/jobs.h>
+#include <base/profile.h>
+#include <base/atomics.h>
+#include <base/sort.h>
 
 // ANSI color codes
 #define COLOR_RESET   "\033[0m"
@@ -30,12 +34,6 @@ typedef struct {
 // Define vector type for WordEntry
 DEFINE_VECTOR_FOR_TYPE(WordEntry, WordEntryVec)
 
-// Define hashtable for word counting: string -> uint64_t
-// Need to define hash and equality functions
-#define WordFreqTable_HASH(key) str_hash(key)
-#define WordFreqTable_EQUAL(a, b) str_eq(a, b)
-DEFINE_HASHTABLE_FOR_TYPES(string, uint64_t, WordFreqTable)
-
 // Helper: check if character is alphanumeric
 static bool is_alnum(char c) {
     return (c >= 'a' && c <= 'z') ||
@@ -51,90 +49,491 @@ static char to_lower(char c) {
     return c;
 }
 
-// Tokenize text and count word frequencies
-static void count_words(Arena *arena, string text, WordFreqTable *table) {
-    println(str_lit("count_words: Starting, text size = {}"), (int64_t)text.size);
+// str_hash (FNV-1a) of the lowercased string, without making a copy
+static uint32_t str_hash_lower(string str) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < str.size; i++) {
+        uint32_t c = (uint8_t)str.str[i];
+        c += (uint32_t)(c - 'A' < 26) << 5;
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
 
-    size_t i = 0;
-    size_t word_count = 0;
-    while (i < text.size) {
-        // Skip non-alphanumeric characters
-        while (i < text.size && !is_alnum(text.str[i])) {
-            i++;
-        }
+// Whether `lower` (already lowercase) equals `text` lowercased
+static bool str_eq_lower(string lower, string text) {
+    if (lower.size != text.size) return false;
+    for (size_t i = 0; i < text.size; i++) {
+        if (lower.str[i] != to_lower(text.str[i])) return false;
+    }
+    return true;
+}
 
-        if (i >= text.size) break;
+// Hashtable for word counting: lowercase word -> count. Lookups can use the
+// word as it appears in the text; keys are lowercase copies made when a word
+// is first inserted.
+#define WordFreqTable_HASH(key) str_hash_lower(key)
+#define WordFreqTable_EQUAL(a, b) str_eq_lower(a, b)
+DEFINE_HASHTABLE_FOR_TYPES(string, uint64_t, WordFreqTable)
 
-        // Found start of a word
-        size_t start = i;
-        while (i < text.size && is_alnum(text.str[i])) {
-            i++;
+// Word boundaries are found 64 bytes at a time. The bytes are classified 8 at
+// a time in 64-bit registers (SWAR), which needs no intrinsics and works the
+// same with every compiler and on wasm32.
+
+#define SWAR_ONES 0x0101010101010101ull
+#define SWAR_HIGH 0x8080808080808080ull
+
+#if defined(_MSC_VER)
+unsigned char _BitScanForward64(unsigned long *index, unsigned __int64 mask);
+#pragma intrinsic(_BitScanForward64)
+#endif
+
+// Index of the lowest set bit, x != 0
+static inline uint32_t ctz64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctzll(x);
+#endif
+}
+
+// Unaligned little-endian load; compilers turn this into a single load
+static inline uint64_t load_u64_le(const char *p) {
+    const uint8_t *b = (const uint8_t *)p;
+    return (uint64_t)b[0] | (uint64_t)b[1] << 8 | (uint64_t)b[2] << 16 | (uint64_t)b[3] << 24
+        | (uint64_t)b[4] << 32 | (uint64_t)b[5] << 40 | (uint64_t)b[6] << 48 | (uint64_t)b[7] << 56;
+}
+
+// Sets the high bit of each byte of x in [lo, hi], for bytes below 0x80.
+// (byte | 0x80) - lo cannot borrow from the next byte.
+static inline uint64_t swar_in_range(uint64_t x, uint8_t lo, uint8_t hi) {
+    uint64_t ge_lo = ((x | SWAR_HIGH) - SWAR_ONES * lo) & SWAR_HIGH;
+    uint64_t gt_hi = ((x | SWAR_HIGH) - SWAR_ONES * (uint8_t)(hi + 1)) & SWAR_HIGH;
+    return ge_lo & ~gt_hi;
+}
+
+// Bit i is set if p[i] is alphanumeric, for 64 bytes
+static uint64_t alnum_mask64(const char *p) {
+    uint64_t mask = 0;
+    for (int i = 0; i < 8; i++) {
+        uint64_t x = load_u64_le(p + 8 * i);
+        uint64_t letters = swar_in_range(x | SWAR_ONES * 0x20, 'a', 'z');
+        uint64_t digits = swar_in_range(x, '0', '9');
+        // Bytes >= 0x80 are not ASCII
+        uint64_t alnum = (letters | digits) & ~x;
+        // Gather the high bits into 8 bits
+        mask |= ((alnum >> 7) * 0x0102040810204080ull) >> 56 << (8 * i);
+    }
+    return mask;
+}
+
+// Bit i is set if p[i] is alphanumeric, for size < 64 bytes
+static uint64_t alnum_mask_tail(const char *p, size_t size) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < size; i++) {
+        mask |= (uint64_t)is_alnum(p[i]) << i;
+    }
+    return mask;
+}
+
+// Progress is reported at most this often
+#define PROGRESS_INTERVAL_NS 250000000ull
+
+// Progress of the counting phase. Whichever thread finishes a chunk adds it
+// to done_bytes and may print; claiming next_report_ns with a CAS lets only
+// one of them print per interval.
+typedef struct {
+    bool enabled;
+    uint64_t total_bytes;
+    atomic_u64 done_bytes;
+    atomic_u64 next_report_ns;
+} Progress;
+
+static Progress g_progress;
+
+// --quiet: only print the results
+static bool g_quiet;
+
+static void progress_add(uint64_t bytes) {
+    if (!g_progress.enabled) return;
+    uint64_t done = atomic_fetch_add_u64(&g_progress.done_bytes, bytes) + bytes;
+    uint64_t next = atomic_load_u64(&g_progress.next_report_ns, ATOMIC_RELAXED);
+    uint64_t now = platform_now_ns();
+    if (now < next) return;
+    if (!atomic_compare_exchange_u64(&g_progress.next_report_ns, &next, now + PROGRESS_INTERVAL_NS)) return;
+    println(str_lit("Counted {} of {} MiB ({}%)..."), done >> 20,
+            g_progress.total_bytes >> 20, done * 100 / g_progress.total_bytes);
+}
+
+// Text is counted in chunks of about this size, in parallel
+#define COUNT_CHUNK_SIZE (64 * 1024)
+
+// Upper bound for --threads. Every thread gets its own count table, so a
+// typo like --threads 100000 would otherwise start that many threads.
+#define MAX_THREADS 256
+
+// The per-thread counts are merged in this many partitions, split by the top
+// bits of the word hash, in parallel. The buckets of a table are picked by
+// the low bits, so the two do not correlate.
+#define MERGE_PARTITION_BITS 6
+#define MERGE_PARTITION_COUNT (1u << MERGE_PARTITION_BITS)
+
+static uint32_t merge_partition(string word) {
+    return str_hash_lower(word) >> (32 - MERGE_PARTITION_BITS);
+}
+
+// Counting state of one job thread. Every chunk a thread counts goes into
+// its table, so a word is interned once per thread rather than once per
+// chunk, and threads never share an allocator. `partitions` lists the
+// table's words and counts by merge partition once counting is done.
+typedef struct {
+    Arena *arena;
+    WordFreqTable table;
+    uint64_t word_count;
+    WordEntryVec partitions[MERGE_PARTITION_COUNT];
+} CountShard;
+
+// Merged counts of the words of one partition
+typedef struct {
+    Arena *arena;
+    WordEntryVec entries;
+} CountPartition;
+
+// Word counts split into partitions. Keys point into the shard arenas, so
+// the shards are kept until word_counts_release.
+typedef struct {
+    CountShard *shards;
+    uint32_t shard_count;
+    CountPartition partitions[MERGE_PARTITION_COUNT];
+    uint64_t total_count;   // Words in the text
+    uint64_t unique_count;
+} WordCounts;
+
+typedef struct {
+    string *chunks;
+    WordCounts *counts;
+} CountJob;
+
+// Counts one occurrence of `word`, a view into the text
+static void count_shard_word(CountShard *shard, string word) {
+    uint64_t *count_ptr = WordFreqTable_get(&shard->table, word);
+    if (count_ptr) {
+        (*count_ptr)++;
+    } else {
+        // First occurrence: intern a lowercase copy
+        char *word_buf = arena_alloc_array(shard->arena, char, word.size);
+        for (size_t j = 0; j < word.size; j++) {
+            word_buf[j] = to_lower(word.str[j]);
         }
+        string key = str_from_cstr_len_view(word_buf, word.size);
+        WordFreqTable_insert(shard->arena, &shard->table, key, 1);
+    }
+    shard->word_count++;
+}
 
-        // Extract and normalize word to lowercase
-        size_t word_len = i - start;
-        char *word_buf = arena_alloc_array(arena, char, word_len);
-        for (size_t j = 0; j < word_len; j++) {
-            word_buf[j] = to_lower(text.str[start + j]);
+// Tokenize one chunk and count its word frequencies into `shard`
+static void count_chunk_words(CountShard *shard, string text) {
+    PROFILE_ZONE("count_chunk_words");
+
+    // Walk the alphanumeric mask of each 64-byte block: a word starts at a
+    // set bit and ends at the next clear bit, possibly in a later block.
+    // Bits past the end of the text are clear, so the last block ends any
+    // word that reaches it.
+    size_t word_start = 0;
+    bool in_word = false;
+    for (size_t block = 0; block < text.size; block += 64) {
+        uint64_t mask = text.size - block >= 64
+            ? alnum_mask64(text.str + block)
+            : alnum_mask_tail(text.str + block, text.size - block);
+        uint64_t rest = ~0ull;  // Bits at or after the current position
+        for (;;) {
+            if (!in_word) {
+                uint64_t starts = mask & rest;
+                if (!starts) break;
+                uint32_t bit = ctz64(starts);
+                word_start = block + bit;
+                in_word = true;
+                rest = ~0ull << bit;
+            }
+            uint64_t ends = ~mask & rest;
+            if (!ends) break;
+            uint32_t bit = ctz64(ends);
+            count_shard_word(shard, str_from_cstr_len_view(text.str + word_start, block + bit - word_start));
+            in_word = false;
+            rest = ~0ull << bit;
         }
-        string word = str_from_cstr_len_view(word_buf, word_len);
+    }
+    if (in_word) {
+        count_shard_word(shard, str_from_cstr_len_view(text.str + word_start, text.size - word_start));
+    }
+}
 
-        // Update count in hashtable
-        uint64_t *count_ptr = WordFreqTable_get(table, word);
-        uint64_t new_count = count_ptr ? (*count_ptr + 1) : 1;
-        WordFreqTable_insert(arena, table, word, new_count);
+// Map: count chunks into the calling thread's shard
+static void count_chunks_job(void *arg, uint64_t begin, uint64_t end) {
+    CountJob *job = arg;
+    CountShard *shard = &job->counts->shards[jobs_thread_index()];
+    for (uint64_t i = begin; i < end; i++) {
+        count_chunk_words(shard, job->chunks[i]);
+        progress_add(job->chunks[i].size);
+    }
+}
+
+// Lists the words of each shard by merge partition
+static void split_shards_job(void *arg, uint64_t begin, uint64_t end) {
+    WordCounts *counts = arg;
+    for (uint64_t s = begin; s < end; s++) {
+        PROFILE_ZONE("split_shard");
+        CountShard *shard = &counts->shards[s];
+        size_t expected = shard->table.size / MERGE_PARTITION_COUNT * 2 + 16;
+        for (uint32_t p = 0; p < MERGE_PARTITION_COUNT; p++) {
+            WordEntryVec_reserve(shard->arena, &shard->partitions[p], expected);
+        }
+        for (size_t i = 0; i < shard->table.num_buckets; i++) {
+            if (!shard->table.buckets[i].occupied) continue;
+            WordEntry entry = {
+                .word = shard->table.buckets[i].key,
+                .count = shard->table.buckets[i].value,
+            };
+            WordEntryVec_push_back(shard->arena, &shard->partitions[merge_partition(entry.word)], entry);
+        }
+    }
+}
 
-        word_count++;
-        if (word_count % 10 == 0) {
-            println(str_lit("Processed {} words..."), (int64_t)word_count);
+// Reduce: sums the counts of a partition's words over all shards
+static void merge_partitions_job(void *arg, uint64_t begin, uint64_t end) {
+    WordCounts *counts = arg;
+    for (uint64_t p = begin; p < end; p++) {
+        PROFILE_ZONE("merge_partition");
+        CountPartition *partition = &counts->partitions[p];
+        size_t max_words = 0;
+        for (uint32_t s = 0; s < counts->shard_count; s++) {
+            max_words += counts->shards[s].partitions[p].size;
+        }
+        partition->arena = arena_new(max_words * sizeof(WordEntry) + 64);
+        WordEntryVec_reserve(partition->arena, &partition->entries, max_words);
+
+        // Word -> index in entries, only needed while merging
+        Scratch scratch = scratch_begin();
+        WordFreqTable index;
+        WordFreqTable_init(scratch.arena, &index, max_words * 2 + 1);
+        for (uint32_t s = 0; s < counts->shard_count; s++) {
+            WordEntryVec *words = &counts->shards[s].partitions[p];
+            for (size_t i = 0; i < words->size; i++) {
+                WordEntry *word = &words->data[i];
+                uint64_t *index_ptr = WordFreqTable_get(&index, word->word);
+                if (index_ptr) {
+                    partition->entries.data[*index_ptr].count += word->count;
+                } else {
+                    WordFreqTable_insert(scratch.arena, &index, word->word, partition->entries.size);
+                    WordEntryVec_push_back(partition->arena, &partition->entries, *word);
+                }
+            }
         }
+        scratch_end(scratch);
     }
-    println(str_lit("Total words processed: {}"), (int64_t)word_count);
 }
 
-// Comparison function for sorting (descending by count)
+// Time spent in each phase, for --stats
+typedef struct {
+    uint64_t read_ns;
+    uint64_t count_ns;   // Tokenizing and counting the chunks
+    uint64_t merge_ns;
+    uint64_t sort_ns;
+    uint64_t print_ns;
+} PhaseTimes;
+
+// Tokenize text and count word frequencies. The chunks are counted in
+// parallel into per-thread tables (map), which are then merged partition by
+// partition in parallel (reduce).
+static void count_words(Arena *arena, string text, WordCounts *counts, PhaseTimes *times) {
+    PROFILE_ZONE("count_words");
+    if (!g_quiet) println(str_lit("count_words: Starting, text size = {}"), (int64_t)text.size);
+
+    // Split into chunks, extending each one to the end of the word it cuts
+    size_t chunk_count = 0;
+    string *chunks = arena_alloc_array(arena, string, text.size / COUNT_CHUNK_SIZE + 1);
+    size_t pos = 0;
+    while (pos < text.size) {
+        size_t end = pos + COUNT_CHUNK_SIZE < text.size ? pos + COUNT_CHUNK_SIZE : text.size;
+        while (end < text.size && is_alnum(text.str[end])) {
+            end++;
+        }
+        chunks[chunk_count++] = str_from_cstr_len_view((char *)text.str + pos, end - pos);
+        pos = end;
+    }
+
+    base_memset(counts, 0, sizeof(*counts));
+    counts->shard_count = jobs_thread_count();
+    counts->shards = arena_alloc_array(arena, CountShard, counts->shard_count);
+    base_memset(counts->shards, 0, counts->shard_count * sizeof(CountShard));
+    for (uint32_t s = 0; s < counts->shard_count; s++) {
+        counts->shards[s].arena = arena_new(COUNT_CHUNK_SIZE);
+        WordFreqTable_init(counts->shards[s].arena, &counts->shards[s].table, 1024);
+    }
+
+    uint64_t count_start = platform_now_ns();
+    g_progress.total_bytes = text.size;
+    atomic_store_u64(&g_progress.next_report_ns, count_start + PROGRESS_INTERVAL_NS, ATOMIC_RELAXED);
+    CountJob job = {.chunks = chunks, .counts = counts};
+    job_parallel_for(chunk_count, 1, count_chunks_job, &job);
+    uint64_t merge_start = platform_now_ns();
+    times->count_ns = merge_start - count_start;
+
+    job_parallel_for(counts->shard_count, 1, split_shards_job, counts);
+    job_parallel_for(MERGE_PARTITION_COUNT, 1, merge_partitions_job, counts);
+    for (uint32_t s = 0; s < counts->shard_count; s++) {
+        counts->total_count += counts->shards[s].word_count;
+    }
+    for (uint32_t p = 0; p < MERGE_PARTITION_COUNT; p++) {
+        counts->unique_count += counts->partitions[p].entries.size;
+    }
+    times->merge_ns = platform_now_ns() - merge_start;
+    if (!g_quiet) println(str_lit("Total words processed: {}"), counts->total_count);
+}
+
+static void word_counts_release(WordCounts *counts) {
+    for (uint32_t s = 0; s < counts->shard_count; s++) {
+        arena_free(counts->shards[s].arena);
+    }
+    for (uint32_t p = 0; p < MERGE_PARTITION_COUNT; p++) {
+        if (counts->partitions[p].arena) arena_free(counts->partitions[p].arena);
+    }
+}
+
+// Bytewise order of two words
+static int compare_words(string a, string b) {
+    size_t size = a.size < b.size ? a.size : b.size;
+    int result = base_memcmp(a.str, b.str, size);
+    if (result != 0) return result;
+    if (a.size != b.size) return a.size < b.size ? -1 : 1;
+    return 0;
+}
+
+// Comparison function for sorting (descending by count, then by word so that
+// the order does not depend on how the work was split between threads)
 static int compare_entries(const void *a, const void *b) {
     const WordEntry *ea = (const WordEntry *)a;
     const WordEntry *eb = (const WordEntry *)b;
     if (ea->count > eb->count) return -1;
     if (ea->count < eb->count) return 1;
-    return 0;
+    return compare_words(ea->word, eb->word);
 }
 
-// Simple qsort implementation (since we can't use stdlib)
-static void swap_entries(WordEntry *a, WordEntry *b) {
-    WordEntry temp = *a;
-    *a = *b;
-    *b = temp;
-}
+#define WordEntrySort_BEFORE(a, b) (compare_entries((a), (b)) < 0)
+DEFINE_SORT_FOR_TYPE(WordEntry, WordEntrySort_BEFORE, WordEntrySort)
 
-static void quicksort(WordEntry *arr, int64_t low, int64_t high) {
-    if (low < high) {
-        // Partition
-        WordEntry pivot = arr[high];
-        int64_t i = low - 1;
+// Number of most and least frequent words to print
+typedef struct {
+    WordCounts *counts;
+    size_t top_count;
+    size_t bottom_count;
+} SelectJob;
+
+// Moves the top_count most frequent words of each partition to its front and
+// the bottom_count least frequent to its back, each in sorted order. Only
+// those are printed, so the rest is left unsorted.
+static void select_partitions_job(void *arg, uint64_t begin, uint64_t end) {
+    SelectJob *job = arg;
+    for (uint64_t p = begin; p < end; p++) {
+        PROFILE_ZONE("select_partition");
+        WordEntryVec *entries = &job->counts->partitions[p].entries;
+        size_t n = entries->size;
+        if (job->top_count + job->bottom_count >= n) {
+            WordEntrySort_sort(entries->data, n);
+            continue;
+        }
+        WordEntrySort_partial(entries->data, n, job->top_count);
+        WordEntry *rest = entries->data + job->top_count;
+        size_t rest_count = n - job->top_count;
+        size_t bottom_start = rest_count - job->bottom_count;
+        WordEntrySort_select(rest, rest_count, bottom_start);
+        WordEntrySort_sort(rest + bottom_start, job->bottom_count);
+    }
+}
 
-        for (int64_t j = low; j < high; j++) {
-            if (compare_entries(&arr[j], &pivot) < 0) {
-                i++;
-                swap_entries(&arr[i], &arr[j]);
+// The sorted order of all words is the merge of the sorted partitions. Only
+// its ends are printed, so they are merged from the partition heads and
+// tails left by select_partitions_job.
+
+// Writes the first `n` words in sorted order to `out`
+static void take_top(const WordCounts *counts, WordEntry *out, size_t n) {
+    size_t next[MERGE_PARTITION_COUNT] = {0};
+    for (size_t i = 0; i < n; i++) {
+        const WordEntry *best = NULL;
+        uint32_t best_partition = 0;
+        for (uint32_t p = 0; p < MERGE_PARTITION_COUNT; p++) {
+            const WordEntryVec *entries = &counts->partitions[p].entries;
+            if (next[p] == entries->size) continue;
+            if (!best || compare_entries(&entries->data[next[p]], best) < 0) {
+                best = &entries->data[next[p]];
+                best_partition = p;
             }
         }
-        swap_entries(&arr[i + 1], &arr[high]);
-        int64_t pi = i + 1;
+        out[i] = *best;
+        next[best_partition]++;
+    }
+}
 
-        // Recursively sort
-        quicksort(arr, low, pi - 1);
-        quicksort(arr, pi + 1, high);
+// Writes the last `n` words in sorted order to `out`
+static void take_bottom(const WordCounts *counts, WordEntry *out, size_t n) {
+    size_t left[MERGE_PARTITION_COUNT];
+    for (uint32_t p = 0; p < MERGE_PARTITION_COUNT; p++) {
+        left[p] = counts->partitions[p].entries.size;
+    }
+    for (size_t i = n; i > 0; i--) {
+        const WordEntry *worst = NULL;
+        uint32_t worst_partition = 0;
+        for (uint32_t p = 0; p < MERGE_PARTITION_COUNT; p++) {
+            if (left[p] == 0) continue;
+            const WordEntry *entry = &counts->partitions[p].entries.data[left[p] - 1];
+            if (!worst || compare_entries(entry, worst) > 0) {
+                worst = entry;
+                worst_partition = p;
+            }
+        }
+        out[i - 1] = *worst;
+        left[worst_partition]--;
     }
 }
 
 // Print usage
 static void print_usage(const char *prog_name) {
-    println(str_lit("Usage: {} <filename> [top_n] [bottom_n]"), str_from_cstr_view((char *)prog_name));
-    println(str_lit("  filename  - text file to analyze"));
-    println(str_lit("  top_n     - number of most frequent words (default: 20)"));
-    println(str_lit("  bottom_n  - number of least frequent words (default: 10)"));
+    println(str_lit("Usage: {} [--stats] [--quiet] [--progress] [--threads n] <filename> [top_n] [bottom_n]"), str_from_cstr_view((char *)prog_name));
+    println(str_lit("  filename   - text file to analyze"));
+    println(str_lit("  top_n      - number of most frequent words (default: 20)"));
+    println(str_lit("  bottom_n   - number of least frequent words (default: 10)"));
+    println(str_lit("  --stats    - report time and throughput per phase and peak memory"));
+    println(str_lit("  --quiet    - only print the results"));
+    println(str_lit("  --progress - report counting progress (default: when stdout is a terminal)"));
+    println(str_lit("  --threads  - number of threads counting words, up to {} (default: one per CPU)"), MAX_THREADS);
+}
+
+static void print_phase(string name, uint64_t ns, uint64_t bytes) {
+    double ms = (double)ns / 1e6;
+    double mb_per_s = ns > 0 ? (double)bytes / (1024.0 * 1024.0) / ((double)ns / 1e9) : 0.0;
+    println(str_lit("  {:<16} {:.3} ms  {:.1} MB/s"), name, ms, mb_per_s);
+}
+
+static void print_stats(const PhaseTimes *times, uint64_t bytes, uint32_t thread_count) {
+    uint64_t total_ns = times->read_ns + times->count_ns + times->merge_ns
+        + times->sort_ns + times->print_ns;
+    BuddyStats memory = buddy_get_stats();
+    println(str_lit(""));
+    println(str_lit("{}=== Stats ({} bytes) ==={}"), str_lit(COLOR_BOLD COLOR_MAGENTA),
+            bytes, str_lit(COLOR_RESET));
+    println(str_lit("  threads          {}"), thread_count);
+    print_phase(str_lit("read"), times->read_ns, bytes);
+    print_phase(str_lit("tokenize+count"), times->count_ns, bytes);
+    print_phase(str_lit("merge"), times->merge_ns, bytes);
+    print_phase(str_lit("sort"), times->sort_ns, bytes);
+    print_phase(str_lit("print"), times->print_ns, bytes);
+    print_phase(str_lit("total"), total_ns, bytes);
+    println(str_lit("  peak memory      {:.1} MiB allocated, {:.1} MiB committed"),
+            (double)memory.peak_allocated_bytes / (1024.0 * 1024.0),
+            (double)memory.committed_bytes / (1024.0 * 1024.0));
 }
 
 // Parse integer from string
@@ -171,96 +570,146 @@ int app_main(void) {
         return 1;
     }
 
-    // Parse arguments
-    if (argc < 2) {
+    // Parse arguments: options anywhere, then positional arguments in order
+    bool show_stats = false;
+    bool force_progress = false;
+    int64_t thread_count = 0;
+    string positional[3];
+    size_t positional_count = 0;
+    for (size_t i = 1; i < argc; i++) {
+        string arg = str_from_cstr_view(argv[i]);
+        if (str_eq(arg, str_lit("--stats"))) {
+            show_stats = true;
+        } else if (str_eq(arg, str_lit("--quiet"))) {
+            g_quiet = true;
+        } else if (str_eq(arg, str_lit("--progress"))) {
+            force_progress = true;
+        } else if (str_eq(arg, str_lit("--threads"))) {
+            if (i + 1 >= argc || !parse_int(str_from_cstr_view(argv[i + 1]), &thread_count) ||
+                thread_count < 1 || thread_count > MAX_THREADS) {
+                println(str_lit("Error: --threads must be between 1 and {}"), MAX_THREADS);
+                scratch_end(scratch);
+                return 1;
+            }
+            i++;
+        } else if (arg.size > 0 && arg.str[0] == '-') {
+            println(str_lit("Error: Unknown option '{}'"), arg);
+            print_usage(argv[0]);
+            scratch_end(scratch);
+            return 1;
+        } else if (positional_count < 3) {
+            positional[positional_count++] = arg;
+        } else {
+            print_usage(argv[0]);
+            scratch_end(scratch);
+            return 1;
+        }
+    }
+    if (positional_count < 1) {
         print_usage(argv[0]);
         scratch_end(scratch);
         return 1;
     }
 
-    string filename = str_from_cstr_view(argv[1]);
+    string filename = positional[0];
     int64_t top_n = 20;
     int64_t bottom_n = 10;
 
-    if (argc >= 3) {
-        if (!parse_int(str_from_cstr_view(argv[2]), &top_n)) {
+    if (positional_count >= 2) {
+        if (!parse_int(positional[1], &top_n)) {
             println(str_lit("Error: Invalid top_n value"));
             scratch_end(scratch);
             return 1;
         }
     }
 
-    if (argc >= 4) {
-        if (!parse_int(str_from_cstr_view(argv[3]), &bottom_n)) {
+    if (positional_count >= 3) {
+        if (!parse_int(positional[2], &bottom_n)) {
             println(str_lit("Error: Invalid bottom_n value"));
             scratch_end(scratch);
             return 1;
         }
     }
 
+    g_progress.enabled = force_progress || (!g_quiet && fd_is_terminal(WASI_STDOUT_FD));
+
     // Now create an arena for the rest of the work
     Arena *arena = scratch.arena;
 
-    println(str_lit("Reading file..."));
+    if (!g_quiet) println(str_lit("Reading file..."));
 
-    // Read file
+    // Read file (mapped read-only when the platform supports it)
+    PhaseTimes times = {0};
+    uint64_t read_start = platform_now_ns();
     string text;
-    if (!read_file(arena, filename, &text)) {
+    uint64_t text_handle;
+    if (!read_file_view(arena, filename, &text, &text_handle)) {
         println(str_lit("Error: Cannot read file '{}'"), filename);
         return 1;
     }
+    times.read_ns = platform_now_ns() - read_start;
 
-    println(str_lit("File read successfully, size: {}"), (int64_t)text.size);
+    if (!g_quiet) println(str_lit("File read successfully, size: {}"), (int64_t)text.size);
 
-    // Initialize hashtable
-    WordFreqTable table;
-    WordFreqTable_init(arena, &table, 1024);
+    if (!g_quiet) println(str_lit("Counting words..."));
 
-    println(str_lit("Counting words..."));
+    // Count words. Without --threads, jobs_init starts one worker per CPU;
+    // --threads 1 counts on the main thread only.
+    if (thread_count != 1) jobs_init((uint32_t)(thread_count > 0 ? thread_count - 1 : 0));
+    uint32_t threads_used = jobs_thread_count();
+    WordCounts counts;
+    count_words(arena, text, &counts, &times);
 
-    // Count words
-    count_words(arena, text, &table);
+    // Only the top N and bottom N words are sorted
+    int64_t unique_count = (int64_t)counts.unique_count;
+    int64_t top_limit = top_n;
+    if (top_limit > unique_count) {
+        top_limit = unique_count;
+    }
+    int64_t bottom_start = unique_count - bottom_n;
+    if (bottom_start < 0) bottom_start = 0;
+    if (bottom_start < top_limit) bottom_start = top_limit; // Don't overlap with top
+
+    uint64_t sort_start = platform_now_ns();
+    SelectJob select = {
+        .counts = &counts,
+        .top_count = (size_t)top_limit,
+        .bottom_count = (size_t)(unique_count - bottom_start),
+    };
+    job_parallel_for(MERGE_PARTITION_COUNT, 1, select_partitions_job, &select);
+    times.sort_ns = platform_now_ns() - sort_start;
+    jobs_shutdown();
+#ifdef WITH_PROFILE
+    if (profile_write_chrome_trace(str_lit("wordfreq_trace.json"))) {
+        println(str_lit("Wrote profile to wordfreq_trace.json"));
+    }
+#endif
 
-    println(str_lit("Finished counting words"));
+    if (!g_quiet) println(str_lit("Finished counting words"));
 
-    if (table.size == 0) {
+    if (counts.unique_count == 0) {
         println(str_lit("No words found in file"));
+        if (show_stats) print_stats(&times, text.size, threads_used);
+        word_counts_release(&counts);
+        read_file_view_release(text_handle);
         return 0;
     }
 
-    // Convert hashtable to vector for sorting
-    WordEntryVec entries;
-    WordEntryVec_reserve(arena, &entries, table.size);
-
-    uint64_t total_count = 0;
-    for (size_t i = 0; i < table.num_buckets; i++) {
-        if (table.buckets[i].occupied) {
-            WordEntry entry;
-            entry.word = table.buckets[i].key;
-            entry.count = table.buckets[i].value;
-            WordEntryVec_push_back(arena, &entries, entry);
-            total_count += entry.count;
-        }
-    }
-
-    // Sort by frequency (descending)
-    quicksort(entries.data, 0, (int64_t)entries.size - 1);
+    uint64_t print_start = platform_now_ns();
+    uint64_t total_count = counts.total_count;
 
     // Print header
     println(str_lit("{}=== Word Frequency Analysis ==={}"), str_lit(COLOR_BOLD COLOR_CYAN), str_lit(COLOR_RESET));
     println(str_lit("Total words: {}"), (int64_t)total_count);
-    println(str_lit("Unique words: {}"), (int64_t)entries.size);
+    println(str_lit("Unique words: {}"), unique_count);
     println(str_lit(""));
 
     // Print top N
     println(str_lit("{}=== Top {} Most Frequent Words ==={}"), str_lit(COLOR_BOLD COLOR_GREEN), top_n, str_lit(COLOR_RESET));
-    int64_t top_limit = top_n;
-    if (top_limit > (int64_t)entries.size) {
-        top_limit = (int64_t)entries.size;
-    }
-
+    WordEntry *top = arena_alloc_array(arena, WordEntry, top_limit + 1);
+    take_top(&counts, top, (size_t)top_limit);
     for (int64_t i = 0; i < top_limit; i++) {
-        WordEntry *e = &entries.data[i];
+        WordEntry *e = &top[i];
         double percentage = (double)e->count * 100.0 / (double)total_count;
 
         // Format percentage with 2 decimal places
@@ -281,12 +730,10 @@ int app_main(void) {
     println(str_lit(""));
     println(str_lit("{}=== Bottom {} Least Frequent Words ==={}"), str_lit(COLOR_BOLD COLOR_RED), bottom_n, str_lit(COLOR_RESET));
 
-    int64_t bottom_start = (int64_t)entries.size - bottom_n;
-    if (bottom_start < 0) bottom_start = 0;
-    if (bottom_start < top_limit) bottom_start = top_limit; // Don't overlap with top
-
-    for (int64_t i = bottom_start; i < (int64_t)entries.size; i++) {
-        WordEntry *e = &entries.data[i];
+    WordEntry *bottom = arena_alloc_array(arena, WordEntry, unique_count - bottom_start + 1);
+    take_bottom(&counts, bottom, (size_t)(unique_count - bottom_start));
+    for (int64_t i = bottom_start; i < unique_count; i++) {
+        WordEntry *e = &bottom[i - bottom_start];
         double percentage = (double)e->count * 100.0 / (double)total_count;
 
         char pct_buf[32];
@@ -302,6 +749,11 @@ int app_main(void) {
                 str_lit(COLOR_RESET));
     }
 
+    times.print_ns = platform_now_ns() - print_start;
+    if (show_stats) print_stats(&times, text.size, threads_used);
+
+    word_counts_release(&counts);
+    read_file_view_release(text_handle);
     scratch_end(scratch);
 
     return 0;
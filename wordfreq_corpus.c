@@ -0,0 +1,219 @@
+#include <base/io.h>
+#include <base/arena.h>
+#include <base/scratch.h>
+#include <base/buddy.h>
+#include <base/base_string.h>
+#include <platform/platform.h>
+#include <base/mem.h>
+#include <base/format.h>
+#include <base/base_io.h>
+
+// Generates a benchmark corpus for wordfreq: English-looking text whose word
+// frequencies follow Zipf's law (the word of rank r occurs with probability
+// proportional to 1/r), like natural language. The output depends only on the
+// size and seed, so every platform generates the same bytes.
+//
+// Usage: wordfreq_corpus <output> <size_mb> [seed]
+
+#define VOCABULARY_SIZE 50000
+#define WRITE_BUFFER_SIZE (1024 * 1024)
+#define MAX_WORD_SIZE 16
+
+// Words are spelled in base 32 with syllables as digits. No syllable is a
+// prefix of another, so every rank gets a distinct word, and frequent words
+// are short.
+static const char *g_syllables[32] = {
+    "a", "e", "i", "o", "u", "ta", "te", "ti",
+    "to", "na", "ne", "ni", "no", "sa", "se", "si",
+    "so", "ra", "re", "ri", "ro", "la", "le", "li",
+    "lo", "da", "de", "di", "do", "ka", "ke", "ko",
+};
+
+typedef struct {
+    char text[MAX_WORD_SIZE];
+    uint8_t size;
+} Word;
+
+typedef struct {
+    wasi_fd_t fd;
+    char *data;
+    size_t size;
+    uint64_t written;
+    bool ok;
+} Output;
+
+static uint64_t rng_next(uint64_t *state) {
+    // splitmix64
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1)
+static double rng_double(uint64_t *state) {
+    return (double)(rng_next(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void build_vocabulary(Word *words) {
+    for (uint32_t rank = 0; rank < VOCABULARY_SIZE; rank++) {
+        Word *w = &words[rank];
+        w->size = 0;
+        uint32_t n = rank;
+        do {
+            const char *syllable = g_syllables[n % 32];
+            size_t len = base_strlen(syllable);
+            base_memcpy(w->text + w->size, syllable, len);
+            w->size += (uint8_t)len;
+            n /= 32;
+        } while (n > 0);
+    }
+}
+
+// Cumulative Zipf distribution over the ranks
+static double *build_cdf(Arena *arena) {
+    double *cdf = arena_alloc_array(arena, double, VOCABULARY_SIZE);
+    double sum = 0.0;
+    for (uint32_t rank = 0; rank < VOCABULARY_SIZE; rank++) {
+        sum += 1.0 / (double)(rank + 1);
+        cdf[rank] = sum;
+    }
+    for (uint32_t rank = 0; rank < VOCABULARY_SIZE; rank++) {
+        cdf[rank] /= sum;
+    }
+    return cdf;
+}
+
+static uint32_t sample_rank(const double *cdf, uint64_t *rng) {
+    double u = rng_double(rng);
+    uint32_t lo = 0;
+    uint32_t hi = VOCABULARY_SIZE - 1;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (cdf[mid] <= u) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void output_flush(Output *out) {
+    if (out->size > 0 && out->ok) {
+        ciovec_t iov = {.buf = out->data, .buf_len = out->size};
+        out->ok = write_all(out->fd, &iov, 1) == 0;
+    }
+    out->written += out->size;
+    out->size = 0;
+}
+
+static void output_char(Output *out, char c) {
+    if (out->size == WRITE_BUFFER_SIZE) output_flush(out);
+    out->data[out->size++] = c;
+}
+
+static void output_word(Output *out, const Word *w, bool capitalize) {
+    if (out->size + w->size > WRITE_BUFFER_SIZE) output_flush(out);
+    base_memcpy(out->data + out->size, w->text, w->size);
+    if (capitalize) out->data[out->size] += 'A' - 'a';
+    out->size += w->size;
+}
+
+static bool parse_u64(const char *s, uint64_t *result) {
+    *result = 0;
+    if (*s == '\0') return false;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9') return false;
+        *result = *result * 10 + (uint64_t)(*s - '0');
+    }
+    return true;
+}
+
+int app_main(void) {
+    Scratch scratch = scratch_begin();
+
+    size_t argc;
+    size_t argv_buf_size;
+    if (wasi_args_sizes_get(&argc, &argv_buf_size) != 0) {
+        println(str_lit("Error: Failed to get argument sizes"));
+        scratch_end(scratch);
+        return 1;
+    }
+    char **argv = (char **)arena_alloc(scratch.arena, (argc + 1) * sizeof(char*));
+    char *argv_buf = (char *)arena_alloc(scratch.arena, argv_buf_size + 1);
+    if (wasi_args_get(argv, argv_buf) != 0) {
+        println(str_lit("Error: Failed to get arguments"));
+        scratch_end(scratch);
+        return 1;
+    }
+
+    uint64_t size_mb = 0;
+    uint64_t seed = 1;
+    if (argc < 3 || argc > 4 || !parse_u64(argv[2], &size_mb) || size_mb == 0
+            || (argc == 4 && !parse_u64(argv[3], &seed))) {
+        println(str_lit("Usage: wordfreq_corpus <output> <size_mb> [seed]"));
+        scratch_end(scratch);
+        return 1;
+    }
+    uint64_t target_size = size_mb * 1024 * 1024;
+
+    const char *path = argv[1];
+    wasi_fd_t fd = wasi_path_open(path, base_strlen(path), WASI_RIGHTS_WRITE, WASI_O_CREAT | WASI_O_TRUNC);
+    if (fd < 0) {
+        println(str_lit("Error: Cannot create '{}'"), str_from_cstr_view((char *)path));
+        scratch_end(scratch);
+        return 1;
+    }
+
+    Word *words = arena_alloc_array(scratch.arena, Word, VOCABULARY_SIZE);
+    build_vocabulary(words);
+    double *cdf = build_cdf(scratch.arena);
+
+    Output out = {
+        .fd = fd,
+        .data = arena_alloc(scratch.arena, WRITE_BUFFER_SIZE),
+        .ok = true,
+    };
+    uint64_t rng = seed;
+    uint64_t word_count = 0;
+    uint32_t line_size = 0;
+    bool sentence_start = true;
+
+    // Sentences of words separated by spaces and the occasional comma, in
+    // lines of at most about 80 characters
+    while (out.ok && out.written + out.size < target_size) {
+        const Word *w = &words[sample_rank(cdf, &rng)];
+        output_word(&out, w, sentence_start);
+        line_size += w->size;
+        word_count++;
+
+        uint64_t r = rng_next(&rng);
+        sentence_start = r % 12 == 0;
+        if (sentence_start) {
+            output_char(&out, '.');
+        } else if (r % 17 == 1) {
+            output_char(&out, ',');
+        }
+        if (line_size > 72) {
+            output_char(&out, '\n');
+            line_size = 0;
+        } else {
+            output_char(&out, ' ');
+            line_size++;
+        }
+    }
+    output_char(&out, '\n');
+    output_flush(&out);
+    wasi_fd_close(fd);
+
+    if (!out.ok) {
+        println(str_lit("Error: Failed to write '{}'"), str_from_cstr_view((char *)path));
+        scratch_end(scratch);
+        return 1;
+    }
+    println(str_lit("Wrote {} bytes, {} words to {}"), out.written, word_count,
+            str_from_cstr_view((char *)path));
+    scratch_end(scratch);
+    return 0;
+}